@@ -0,0 +1,256 @@
+/* ex_ascii.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <latan/latan_mat.h>
+#include <latan/latan_io.h>
+#include <latan/latan_rand.h>
+#include <latan/latan_statistics.h>
+#include "ex_check.h"
+
+/* writes matrices and samples in a single ASCII file and loads them by name
+ * in reverse order, loads a matrix nested in a sample (which is not
+ * indexed), then checks the loads after an append through the library,
+ * after a rewrite by another writer and after a rewrite through the
+ * library ; finally loads hand-written numbers, including a matrix with
+ * lines longer than the read buffer, and checks that they are converted
+ * bit by bit as strtod does */
+#define FNAME "ex_ascii.dat"
+#define NOBJ 24
+#define NROW 3
+#define NSAMPLE 5
+#define NWIDE 100000
+#define NUM_SIZE 48
+
+static const char *num_str[] =
+{
+    "0", "-0", "+0.000", "0e999999", "1", "-1.5", "0.1", "0.3", ".5", "5.",
+    "-7.0e-0", "+2.5E+3", "000123.4500", "1e22", "1e23", "1e-22", "1e-23",
+    "9007199254740991", "9007199254740992", "9007199254740993",
+    "123456789012345678", "12345678901234567e-5", "1.00000000000000000001",
+    "3.14159265358979323846", "1.7976931348623157e308",
+    "2.2250738585072014e-308", "4.9e-324", "1e-400", "1e400", "-1e400"
+};
+
+#define NNUM (sizeof(num_str)/sizeof(num_str[0]))
+
+/* random number written with a random format and precision */
+static void rand_num_str(char *str)
+{
+    double x;
+    int prec;
+
+    x    = rand_u(1.0,10.0)*pow(10.0,(double)(rand_ud(61)) - 30.0);
+    x    = (rand_ud(2) == 0) ? x : -x;
+    prec = (int)(rand_ud(18));
+    switch (rand_ud(3))
+    {
+        case 0:
+            sprintf(str,"%.*e",prec,x);
+            break;
+        case 1:
+            sprintf(str,"%.*g",(prec == 0) ? 1 : prec,x);
+            break;
+        default:
+            sprintf(str,"%.*f",prec,x*1.0e-20);
+            break;
+    }
+}
+
+static void mat_fill_rand(mat *m)
+{
+    size_t i,j;
+
+    for (i=0;i<nrow(m);i++)
+    for (j=0;j<ncol(m);j++)
+    {
+        mat_set(m,i,j,rand_n(0.0,1.0));
+    }
+}
+
+int main(void)
+{
+    latan_error_handler_t *handler;
+    mat *m[NOBJ],*m_ld,*x,*x_ld,*y,*num,*num_ld,*wide,*wide_ld,\
+        *sub,*sub_ld;
+    rs_sample *s[NOBJ],*s_ld;
+    strbuf path;
+    FILE *f;
+    char str[NUM_SIZE];
+    size_t i,k,ndiff,dim[2];
+    int nfail;
+    latan_errno status;
+
+    nfail = 0;
+    s_ld  = rs_sample_create(NROW,1,NSAMPLE);
+    x     = mat_create(NROW,2);
+    x_ld  = mat_create(NROW,2);
+    y     = mat_create(NROW,2);
+    randgen_init(31);
+    for (i=0;i<NOBJ;i++)
+    {
+        m[i] = mat_create(NROW,1 + i%4);
+        s[i] = rs_sample_create(NROW,1,NSAMPLE);
+        mat_fill_rand(m[i]);
+        mat_fill_rand(rs_sample_pt_cent_val(s[i]));
+        for (k=0;k<NSAMPLE;k++)
+        {
+            mat_fill_rand(rs_sample_pt_sample(s[i],k));
+        }
+    }
+
+    io_init();
+    io_set_fmt(IO_ASCII);
+    for (i=0;i<NOBJ;i++)
+    {
+        sprintf(path,FNAME":m_%d",(int)(i));
+        mat_save(path,(i == 0) ? 'w' : 'a',m[i]);
+        sprintf(path,FNAME":s_%d",(int)(i));
+        rs_sample_save(path,'a',s[i]);
+    }
+    io_finish();
+    io_init();
+    io_set_fmt(IO_ASCII);
+
+    /* named loads in reverse order */
+    ndiff = 0;
+    for (i=NOBJ;i>0;i--)
+    {
+        m_ld = mat_create(NROW,1 + (i-1)%4);
+        sprintf(path,FNAME":m_%d",(int)(i-1));
+        ndiff += (mat_load(m_ld,dim,path) == LATAN_SUCCESS) ?\
+                 mat_ndiff(m[i-1],m_ld,0.0) : 1;
+        ndiff += (dim[0] != NROW)+(dim[1] != ncol(m[i-1]));
+        sprintf(path,FNAME":s_%d",(int)(i-1));
+        ndiff += (rs_sample_load(s_ld,NULL,NULL,path) == LATAN_SUCCESS) ?\
+                 rs_sample_ndiff(s[i-1],s_ld,0.0) : 1;
+        mat_destroy(m_ld);
+    }
+    nfail += ex_check("named loads in reverse order",ndiff);
+
+    /* matrix nested in a sample */
+    m_ld  = mat_create(NROW,1);
+    ndiff = (mat_load(m_ld,NULL,FNAME":s_3_C") == LATAN_SUCCESS) ?\
+            mat_ndiff(rs_sample_pt_cent_val(s[3]),m_ld,0.0) : 1;
+    nfail += ex_check("nested matrix load",ndiff);
+    mat_destroy(m_ld);
+
+    /* append through the library after the index was built */
+    mat_fill_rand(x);
+    mat_save(FNAME":x",'a',x);
+    ndiff  = (mat_load(x_ld,NULL,FNAME":x") == LATAN_SUCCESS) ?\
+             mat_ndiff(x,x_ld,0.0) : 1;
+    ndiff += (rs_sample_load(s_ld,NULL,NULL,FNAME":s_0") == LATAN_SUCCESS) ?\
+             rs_sample_ndiff(s[0],s_ld,0.0) : 1;
+    nfail += ex_check("load after append",ndiff);
+
+    /* rewrite by another writer, only the file size tells it */
+    f = fopen(FNAME,"w");
+    fprintf(f,"#L latan_begin mat y\n2\n");
+    for (i=0;i<NROW;i++)
+    {
+        fprintf(f,"%d.5 -%de-3\n",(int)(i),(int)(i));
+        mat_set(y,i,0,(double)(i) + 0.5);
+        mat_set(y,i,1,-1.0e-3*(double)(i));
+    }
+    fprintf(f,"#L latan_end mat\n#L latan_begin mat x\n2\n");
+    mat_dump(f,x,NULL);
+    fprintf(f,"#L latan_end mat\n");
+    fclose(f);
+    ndiff  = (mat_load(x_ld,NULL,FNAME":y") == LATAN_SUCCESS) ?\
+             mat_ndiff(y,x_ld,0.0) : 1;
+    ndiff += (mat_load(x_ld,NULL,FNAME":x") == LATAN_SUCCESS) ?\
+             mat_ndiff(x,x_ld,0.0) : 1;
+    nfail += ex_check("load after external rewrite",ndiff);
+
+    /* rewrite, the objects of the old file must not be found */
+    mat_fill_rand(x);
+    mat_save(FNAME":m_5",'w',x);
+    ndiff   = (mat_load(x_ld,NULL,FNAME":m_5") == LATAN_SUCCESS) ?\
+              mat_ndiff(x,x_ld,0.0) : 1;
+    handler = latan_set_error_handler_off();
+    status  = mat_load(x_ld,NULL,FNAME":m_1");
+    latan_set_error_handler(handler);
+    ndiff  += (status == LATAN_SUCCESS);
+    nfail  += ex_check("load after rewrite",ndiff);
+    io_finish();
+    remove(FNAME);
+
+    /* number conversions and long lines, the last line has no end of line */
+    num     = mat_create(NNUM,1);
+    num_ld  = mat_create(NNUM,1);
+    wide    = mat_create(2,NWIDE);
+    wide_ld = mat_create(2,NWIDE);
+    sub     = mat_create(2,3);
+    sub_ld  = mat_create(2,3);
+    f       = fopen(FNAME,"w");
+    fprintf(f,"#L latan_begin mat num\n1\n");
+    for (i=0;i<NNUM;i++)
+    {
+        fprintf(f,"%*s%s%*s\n",(int)(i%3),"",num_str[i],(int)(i%2),"");
+        mat_set(num,i,0,strtod(num_str[i],NULL));
+    }
+    fprintf(f,"#L latan_end mat\n#L latan_begin mat wide\n%d\n",NWIDE);
+    for (i=0;i<2;i++)
+    {
+        for (k=0;k<NWIDE;k++)
+        {
+            rand_num_str(str);
+            fprintf(f,"%s%*s",str,1 + (int)(rand_ud(3)),"");
+            mat_set(wide,i,k,strtod(str,NULL));
+        }
+        fprintf(f,"\n");
+    }
+    fprintf(f,"#L latan_end mat");
+    fclose(f);
+    io_init();
+    io_set_fmt(IO_ASCII);
+    ndiff = (mat_load(num_ld,NULL,FNAME":num") == LATAN_SUCCESS) ?\
+            mat_ndiff(num,num_ld,0.0) : 1;
+    nfail += ex_check("number conversions",ndiff);
+    ndiff = (mat_load(wide_ld,NULL,FNAME":wide") == LATAN_SUCCESS) ?\
+            mat_ndiff(wide,wide_ld,0.0) : 1;
+    nfail += ex_check("long lines",ndiff);
+    mat_get_subm(sub,wide,0,NWIDE-3,1,NWIDE-1);
+    ndiff = (mat_load_subm(sub_ld,FNAME":wide",0,NWIDE-3,1,NWIDE-1)\
+             == LATAN_SUCCESS) ? mat_ndiff(sub,sub_ld,0.0) : 1;
+    nfail += ex_check("long lines sub-matrix",ndiff);
+    io_finish();
+    remove(FNAME);
+
+    for (i=0;i<NOBJ;i++)
+    {
+        mat_destroy(m[i]);
+        rs_sample_destroy(s[i]);
+    }
+    rs_sample_destroy(s_ld);
+    mat_destroy(x);
+    mat_destroy(x_ld);
+    mat_destroy(y);
+    mat_destroy(num);
+    mat_destroy(num_ld);
+    mat_destroy(wide);
+    mat_destroy(wide_ld);
+    mat_destroy(sub);
+    mat_destroy(sub_ld);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
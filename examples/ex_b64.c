@@ -0,0 +1,127 @@
+/* ex_b64.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <latan/latan_mat.h>
+#include <latan/latan_io.h>
+#include <latan/latan_rand.h>
+#include <latan/latan_statistics.h>
+#include "ex_check.h"
+
+/* saves matrices and a sample in an XML file with base64 encoded matrices,
+ * loads them back and checks that they are bit-identical, the matrix sizes
+ * cover every length modulo 3 of the encoded data */
+#define FNAME "ex_b64.xml"
+#define NSAMPLE 20
+
+int main(void)
+{
+    const double special[6] = {0.0,-0.0,DBL_MIN,DBL_MAX,-DBL_MIN/1024.0,\
+                               1.0/3.0};
+    mat *m[3],*m_ld,*sub;
+    rs_sample *s,*s_ld;
+    strbuf path;
+    size_t i,j,k,ndiff,dim[2];
+    int nfail;
+
+    nfail = 0;
+    randgen_init(13);
+    for (k=0;k<3;k++)
+    {
+        m[k] = mat_create(k+1,5);
+        for (i=0;i<nrow(m[k]);i++)
+        for (j=0;j<ncol(m[k]);j++)
+        {
+            mat_set(m[k],i,j,rand_n(0.0,1.0));
+        }
+    }
+    for (j=0;j<5;j++)
+    {
+        mat_set(m[2],2,j,special[j]);
+    }
+    mat_set(m[2],1,4,special[5]);
+    s    = rs_sample_create(3,5,NSAMPLE);
+    s_ld = rs_sample_create(3,5,NSAMPLE);
+    mat_cp(rs_sample_pt_cent_val(s),m[2]);
+    for (i=0;i<NSAMPLE;i++)
+    {
+        for (j=0;j<5;j++)
+        {
+            mat_set(rs_sample_pt_sample(s,i),i%3,j,rand_u(-1.0,1.0));
+        }
+    }
+
+    io_init();
+    io_set_fmt(IO_XML);
+    io_set_xml_base64(true);
+    for (k=0;k<3;k++)
+    {
+        sprintf(path,FNAME":m%d",(int)k);
+        mat_save(path,(k == 0) ? 'w' : 'a',m[k]);
+    }
+    rs_sample_save(FNAME":s",'a',s);
+    io_finish();
+
+    io_init();
+    for (k=0;k<3;k++)
+    {
+        m_ld = mat_create(k+1,5);
+        sprintf(path,FNAME":m%d",(int)k);
+        ndiff  = (mat_load(m_ld,dim,path) == LATAN_SUCCESS) ?\
+                 mat_ndiff(m[k],m_ld,0.0) : 1;
+        ndiff += (dim[0] != k+1)+(dim[1] != 5);
+        printf("%dx5 matrix       : %s\n",(int)(k+1),\
+               (ndiff == 0) ? "ok" : "FAILED");
+        nfail += (ndiff != 0);
+        mat_destroy(m_ld);
+    }
+    sub = mat_create(2,3);
+    m_ld = mat_create(2,3);
+    mat_get_subm(sub,m[2],1,2,2,4);
+    ndiff = (mat_load_subm(m_ld,FNAME":m2",1,2,2,4) == LATAN_SUCCESS) ?\
+            mat_ndiff(sub,m_ld,0.0) : 1;
+    printf("sub-matrix       : %s\n",(ndiff == 0) ? "ok" : "FAILED");
+    nfail += (ndiff != 0);
+    mat_destroy(sub);
+    mat_destroy(m_ld);
+    if (rs_sample_load(s_ld,NULL,NULL,FNAME":s") == LATAN_SUCCESS)
+    {
+        ndiff = rs_sample_ndiff(s,s_ld,0.0);
+    }
+    else
+    {
+        ndiff = 1;
+    }
+    printf("resampled sample : %s\n",(ndiff == 0) ? "ok" : "FAILED");
+    nfail += (ndiff != 0);
+    io_finish();
+    remove(FNAME);
+
+    for (k=0;k<3;k++)
+    {
+        mat_destroy(m[k]);
+    }
+    rs_sample_destroy(s);
+    rs_sample_destroy(s_ld);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
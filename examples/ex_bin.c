@@ -0,0 +1,206 @@
+/* ex_bin.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <latan/latan_mat.h>
+#include <latan/latan_io.h>
+#include <latan/latan_rand.h>
+#include <latan/latan_statistics.h>
+#include "ex_check.h"
+
+/* saves a matrix, a sample and a generator state in a binary file, loads
+ * them back and checks that they are unchanged, then rewrites the file with
+ * the same size and checks that the new content is read, including by a
+ * thread which has the old file in its buffer ; finally bins files which
+ * were just written with the parallel manifest loader and saves a seeded
+ * sample with a seed larger than 2^31 followed by another record */
+#define FNAME "ex_bin.bin"
+#define FNAME_TMP "ex_bin_tmp.bin"
+#define MAN_FNAME "ex_bin.man"
+#define NFILE 6
+#define BINSIZE 2
+#define BIG_SEED 0x80000001UL
+#define NROW 6
+#define NCOL 4
+#define NSAMPLE 100
+
+static void mat_fill_rand(mat *m)
+{
+    size_t i,j;
+
+    for (i=0;i<nrow(m);i++)
+    for (j=0;j<ncol(m);j++)
+    {
+        mat_set(m,i,j,rand_n(0.0,1.0));
+    }
+}
+
+int main(void)
+{
+    mat *m,*m_ld,**dat,**bin;
+    rs_sample *s,*s_ld;
+    rs_seed sd;
+    rg_state state,state_ld;
+    strbuf fname;
+    FILE *man;
+    size_t i,ndiff,nsample,dim[2];
+    int nfail,pass;
+
+    m    = mat_create(NROW,NCOL);
+    m_ld = mat_create(NROW,NCOL);
+    s    = rs_sample_create(NROW,NCOL,NSAMPLE);
+    s_ld = rs_sample_create(NROW,NCOL,NSAMPLE);
+    nfail = 0;
+
+    io_init();
+    io_set_fmt(IO_BIN);
+    randgen_init(7);
+    for (pass=0;pass<2;pass++)
+    {
+        mat_fill_rand(m);
+        mat_fill_rand(rs_sample_pt_cent_val(s));
+        for (i=0;i<NSAMPLE;i++)
+        {
+            mat_fill_rand(rs_sample_pt_sample(s,i));
+        }
+        randgen_get_state(state);
+        mat_save(FNAME":m",'w',m);
+        rs_sample_save(FNAME":s",'a',s);
+        randgen_save_state(FNAME":rg",'a',state);
+        ndiff = (mat_load(m_ld,dim,FNAME":m") == LATAN_SUCCESS) ?\
+                mat_ndiff(m,m_ld,0.0) : 1;
+        ndiff += (dim[0] != NROW)+(dim[1] != NCOL);
+        if (rs_sample_load(s_ld,&nsample,dim,FNAME":s") == LATAN_SUCCESS)
+        {
+            ndiff += (nsample != NSAMPLE)+(dim[0] != NROW)+(dim[1] != NCOL);
+            ndiff += rs_sample_ndiff(s,s_ld,0.0);
+        }
+        else
+        {
+            ndiff += 1;
+        }
+        if (randgen_load_state(state_ld,FNAME":rg") == LATAN_SUCCESS)
+        {
+            for (i=0;i<RLXG_STATE_SIZE;i++)
+            {
+                ndiff += (state[i] != state_ld[i]);
+            }
+        }
+        else
+        {
+            ndiff += 1;
+        }
+        printf("%s: %s\n",(pass == 0) ? "write" : "rewrite",\
+               (ndiff == 0) ? "ok" : "FAILED");
+        nfail += (ndiff != 0);
+    }
+#ifdef _OPENMP
+    /* the file is replaced by a file of the same size, which usually has
+     * the same modification time */
+    ndiff = 0;
+    #pragma omp parallel num_threads(2)
+    {
+        if (omp_get_thread_num() == 1)
+        {
+            mat_load(m_ld,NULL,FNAME":m");
+        }
+        #pragma omp barrier
+        if (omp_get_thread_num() == 0)
+        {
+            mat_fill_rand(m);
+            mat_save(FNAME_TMP":m",'w',m);
+            rs_sample_save(FNAME_TMP":s",'a',s);
+            randgen_save_state(FNAME_TMP":rg",'a',state);
+            mat_load(m_ld,NULL,FNAME_TMP":m");
+            rename(FNAME_TMP,FNAME);
+        }
+        #pragma omp barrier
+        if (omp_get_thread_num() == 1)
+        {
+            mat_load(m_ld,NULL,FNAME":m");
+            ndiff = mat_ndiff(m,m_ld,0.0);
+        }
+    }
+    printf("file replaced from another thread: %s\n",\
+           (ndiff == 0) ? "ok" : "FAILED");
+    nfail += (ndiff != 0);
+#endif
+
+    /* the last file is still open for writing when it is loaded */
+    dat = mat_ar_create(NFILE,NROW,NCOL);
+    bin = mat_ar_create(NFILE/BINSIZE,NROW,NCOL);
+    man = fopen(MAN_FNAME,"w");
+    for (i=0;i<NFILE;i++)
+    {
+        mat_fill_rand(dat[i]);
+        sprintf(fname,"ex_bin_%d.bin",(int)(i));
+        fprintf(man,"%s\n",fname);
+        strcat(fname,":m");
+        mat_save(fname,'w',dat[i]);
+    }
+    fclose(man);
+    io_set_nthread(3);
+    dim[0] = 0;
+    dim[1] = 0;
+    ndiff  = (mat_ar_loadbin(bin,dim,MAN_FNAME,"m",BINSIZE) == LATAN_SUCCESS)\
+             ? 0 : 1;
+    ndiff += (dim[0] != NROW)+(dim[1] != NCOL);
+    io_set_nthread(0);
+    for (i=0;i<NFILE;i+=BINSIZE)
+    {
+        mat_add(m,dat[i],dat[i+1]);
+        mat_eqmuls(m,1.0/(double)(BINSIZE));
+        ndiff += mat_ndiff(m,bin[i/BINSIZE],0.0);
+    }
+    printf("parallel manifest load: %s\n",(ndiff == 0) ? "ok" : "FAILED");
+    nfail += (ndiff != 0);
+
+    /* the seed does not fit in a signed 32 bits integer */
+    rs_sample_seed(s,&sd,MAN_FNAME,"m",BINSIZE,BIG_SEED);
+    rs_sample_save_seed(FNAME":sd",'w',&sd);
+    mat_save(FNAME":m",'a',m);
+    ndiff  = (rs_sample_load(s_ld,NULL,NULL,FNAME":sd") == LATAN_SUCCESS) ?\
+             rs_sample_ndiff(s,s_ld,0.0) : 1;
+    ndiff += (mat_load(m_ld,NULL,FNAME":m") == LATAN_SUCCESS) ?\
+             mat_ndiff(m,m_ld,0.0) : 1;
+    printf("seed larger than 2^31: %s\n",(ndiff == 0) ? "ok" : "FAILED");
+    nfail += (ndiff != 0);
+    io_finish();
+    remove(FNAME);
+    remove(MAN_FNAME);
+    for (i=0;i<NFILE;i++)
+    {
+        sprintf(fname,"ex_bin_%d.bin",(int)(i));
+        remove(fname);
+    }
+
+    mat_destroy(m);
+    mat_destroy(m_ld);
+    rs_sample_destroy(s);
+    rs_sample_destroy(s_ld);
+    mat_ar_destroy(dat,NFILE);
+    mat_ar_destroy(bin,NFILE/BINSIZE);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
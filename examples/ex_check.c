@@ -0,0 +1,69 @@
+/* ex_check.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "ex_check.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+size_t mat_ndiff(const mat *a, const mat *b, const double tol)
+{
+    size_t i,j,ndiff;
+    double x,y;
+
+    ndiff = 0;
+    for (i=0;i<nrow(a);i++)
+    for (j=0;j<ncol(a);j++)
+    {
+        x = mat_get(a,i,j);
+        y = mat_get(b,i,j);
+        if (tol == 0.0)
+        {
+            ndiff += (memcmp(&x,&y,sizeof(double)) != 0);
+        }
+        else
+        {
+            ndiff += !(fabs(x-y) <= tol*fabs(x));
+        }
+    }
+
+    return ndiff;
+}
+
+size_t rs_sample_ndiff(const rs_sample *s, const rs_sample *t,\
+                       const double tol)
+{
+    size_t i,ndiff;
+
+    ndiff = mat_ndiff(rs_sample_pt_cent_val(s),rs_sample_pt_cent_val(t),tol);
+    for (i=0;i<rs_sample_get_nsample(s);i++)
+    {
+        ndiff += mat_ndiff(rs_sample_pt_sample(s,i),rs_sample_pt_sample(t,i),\
+                           tol);
+    }
+
+    return ndiff;
+}
+
+int ex_check(const char *name, const size_t ndiff)
+{
+    printf("%-40s: %s\n",name,(ndiff == 0) ? "ok" : "FAILED");
+
+    return (ndiff != 0);
+}
@@ -0,0 +1,41 @@
+/* ex_check.h, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef EX_CHECK_H_
+#define EX_CHECK_H_
+
+#include <latan/latan_globals.h>
+#include <latan/latan_mat.h>
+#include <latan/latan_statistics.h>
+
+__BEGIN_DECLS
+
+/* number of elements of a and b which differ by more than tol relatively to
+ * the element of a, if tol is 0 the elements are compared bit by bit (so -0
+ * differs from 0 and a NaN is equal to the same NaN) */
+size_t mat_ndiff(const mat *a, const mat *b, const double tol);
+/* same for the central values and all the samples of s and t */
+size_t rs_sample_ndiff(const rs_sample *s, const rs_sample *t,\
+                       const double tol);
+/* print name with ok or FAILED and return 1 if ndiff is not 0 */
+int ex_check(const char *name, const size_t ndiff);
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,135 @@
+/* ex_cov.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <latan/latan_mat.h>
+#include <latan/latan_rand.h>
+#include <latan/latan_statistics.h>
+#include "ex_check.h"
+
+/* compares the covariance matrices computed with one rank-k update (same
+ * samples) or one matrix product (different samples) with the average of
+ * the per-sample outer products computed with explicit loops, for matrices
+ * of several columns and for resampled samples */
+#define NSAMP 500
+#define NROW_M 7
+#define NROW_N 4
+#define NCOL 3
+#define NBOOT 300
+#define TOL 1.0e-12
+
+/* cov_ij = 1/(size*ncol) sum_s sum_l (m_s(i,l)-<m>(i,l))*(n_s(j,l)-<n>(j,l)) */
+static void cov_loop(mat *cov, mat **m, mat **n, const size_t size)
+{
+    mat *m_mean,*n_mean;
+    size_t i,j,l,s;
+    double sum;
+
+    m_mean = mat_create_from_dim(m[0]);
+    n_mean = mat_create_from_dim(n[0]);
+    mat_mean(m_mean,m,size);
+    mat_mean(n_mean,n,size);
+    for (i=0;i<nrow(cov);i++)
+    for (j=0;j<ncol(cov);j++)
+    {
+        sum = 0.0;
+        for (s=0;s<size;s++)
+        for (l=0;l<ncol(m[0]);l++)
+        {
+            sum += (mat_get(m[s],i,l) - mat_get(m_mean,i,l))\
+                   *(mat_get(n[s],j,l) - mat_get(n_mean,j,l));
+        }
+        mat_set(cov,i,j,sum/((double)(size*ncol(m[0]))));
+    }
+    mat_destroy(m_mean);
+    mat_destroy(n_mean);
+}
+
+int main(void)
+{
+    mat **m,**n;
+    mat *cov,*cov_ref,*cross,*cross_ref,*rs_cov,*rs_cov_ref;
+    rs_sample *s;
+    size_t k,i,j;
+    int nfail;
+
+    nfail      = 0;
+    m          = mat_ar_create(NSAMP,NROW_M,NCOL);
+    n          = mat_ar_create(NSAMP,NROW_N,NCOL);
+    cov        = mat_create(NROW_M,NROW_M);
+    cov_ref    = mat_create(NROW_M,NROW_M);
+    cross      = mat_create(NROW_M,NROW_N);
+    cross_ref  = mat_create(NROW_M,NROW_N);
+    rs_cov     = mat_create(NROW_M*NCOL,NROW_M*NCOL);
+    rs_cov_ref = mat_create(NROW_M*NCOL,NROW_M*NCOL);
+    randgen_init(3);
+    for (k=0;k<NSAMP;k++)
+    {
+        for (i=0;i<NROW_M;i++)
+        for (j=0;j<NCOL;j++)
+        {
+            mat_set(m[k],i,j,rand_n((double)(i),1.0+0.1*(double)(j)));
+        }
+        /* n is correlated with the first rows of m */
+        for (i=0;i<NROW_N;i++)
+        for (j=0;j<NCOL;j++)
+        {
+            mat_set(n[k],i,j,mat_get(m[k],i,j) + rand_n(0.0,0.5));
+        }
+    }
+
+    /* covariance of m, rank-k update */
+    mat_cov(cov,m,m,NSAMP);
+    cov_loop(cov_ref,m,m,NSAMP);
+    nfail += ex_check("covariance/explicit loops",mat_ndiff(cov_ref,cov,TOL));
+    nfail += ex_check("covariance symmetric flag",\
+                      !mat_is_assumed(cov,MAT_SYM));
+
+    /* cross covariance of m and n, matrix product */
+    mat_cov(cross,m,n,NSAMP);
+    cov_loop(cross_ref,m,n,NSAMP);
+    nfail += ex_check("cross covariance/explicit loops",\
+                      mat_ndiff(cross_ref,cross,TOL));
+
+    /* covariance of a flattened resampled sample */
+    s = rs_sample_create(NROW_M*NCOL,1,NBOOT);
+    for (k=0;k<NBOOT;k++)
+    for (i=0;i<NROW_M*NCOL;i++)
+    {
+        mat_set(rs_sample_pt_sample(s,k),i,0,\
+                mat_get(m[k],i/NCOL,i%NCOL));
+    }
+    rs_sample_cov(rs_cov,s,s);
+    cov_loop(rs_cov_ref,s->sample,s->sample,NBOOT);
+    nfail += ex_check("resampled covariance/explicit loops",\
+                      mat_ndiff(rs_cov_ref,rs_cov,TOL));
+
+    mat_ar_destroy(m,NSAMP);
+    mat_ar_destroy(n,NSAMP);
+    mat_destroy(cov);
+    mat_destroy(cov_ref);
+    mat_destroy(cross);
+    mat_destroy(cross_ref);
+    mat_destroy(rs_cov);
+    mat_destroy(rs_cov_ref);
+    rs_sample_destroy(s);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
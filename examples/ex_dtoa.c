@@ -0,0 +1,182 @@
+/* ex_dtoa.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include <latan/latan_dtoa.h>
+#include <latan/latan_io.h>
+#include <latan/latan_mat.h>
+#include <latan/latan_rand.h>
+#include "ex_check.h"
+
+/* writes doubles with latan_dtoa and checks that strtod gives them back
+ * exactly with no more significant digits than the shortest %.<p>g
+ * representation, then saves them in an ASCII file and checks that the ASCII
+ * parser gives them back exactly ; the values are random bit patterns, random
+ * short decimals (parsed by the fast path of the ASCII reader) and edge
+ * cases */
+#define FNAME "ex_dtoa.dat"
+#define NROW 200
+#define NCOL 10
+#define NSPECIAL 12
+
+static double rand_bits(void)
+{
+    unsigned char b[sizeof(double)];
+    double x;
+    size_t i;
+
+    do
+    {
+        for (i=0;i<sizeof(double);i++)
+        {
+            b[i] = (unsigned char)(rand_ud(256));
+        }
+        memcpy(&x,b,sizeof(double));
+    } while ((x != x)||(fabs(x) > DBL_MAX));
+
+    return x;
+}
+
+static double rand_dec(void)
+{
+    const double pow10[8] = {1.0,1.0e1,1.0e2,1.0e3,1.0e4,1.0e5,1.0e6,1.0e7};
+    double x;
+
+    x = (double)(rand_ud(100000000u))/pow10[rand_ud(8)];
+
+    return (rand_ud(2) == 0) ? x : -x;
+}
+
+/* smallest %.<p>g precision read back exactly by strtod */
+static int shortest_prec(const double x)
+{
+    char buf[64];
+    int p;
+
+    for (p=1;p<17;p++)
+    {
+        sprintf(buf,"%.*g",p,x);
+        if (strtod(buf,NULL) == x)
+        {
+            break;
+        }
+    }
+
+    return p;
+}
+
+/* number of significant digits of a number string, without the leading and
+ * trailing zeros */
+static int sig_digits(const char *str)
+{
+    size_t i,first,last;
+    int nd;
+
+    first = 0;
+    last  = 0;
+    nd    = 0;
+    for (i=0;(str[i] != '\0')&&(str[i] != 'e');i++)
+    {
+        if ((str[i] >= '1')&&(str[i] <= '9'))
+        {
+            if (nd == 0)
+            {
+                first = i;
+            }
+            last = i;
+            nd++;
+        }
+    }
+    if (nd == 0)
+    {
+        return 1;
+    }
+    for (nd=0,i=first;i<=last;i++)
+    {
+        nd += ((str[i] >= '0')&&(str[i] <= '9'));
+    }
+
+    return nd;
+}
+
+int main(void)
+{
+    const double special[NSPECIAL] = {0.0,-0.0,1.0,0.1,1.0/3.0,1.0e22,1.0e23,\
+                                      DBL_MAX,DBL_MIN,DBL_MIN/4096.0,       \
+                                      DBL_EPSILON,9007199254740993.0};
+    char buf[LATAN_DTOA_SIZE];
+    mat *m,*m_ld;
+    size_t i,j,len,nbad,nlong;
+    double x,y;
+    int nfail;
+
+    nfail = 0;
+    m     = mat_create(NROW,NCOL);
+    m_ld  = mat_create(NROW,NCOL);
+    randgen_init(23);
+    for (i=0;i<NROW;i++)
+    for (j=0;j<NCOL;j++)
+    {
+        if (i*NCOL+j < NSPECIAL)
+        {
+            x = special[i*NCOL+j];
+        }
+        else
+        {
+            x = (j%2 == 0) ? rand_bits() : rand_dec();
+        }
+        mat_set(m,i,j,x);
+    }
+
+    nbad  = 0;
+    nlong = 0;
+    for (i=0;i<NROW;i++)
+    for (j=0;j<NCOL;j++)
+    {
+        x     = mat_get(m,i,j);
+        len   = latan_dtoa(buf,x);
+        y     = strtod(buf,NULL);
+        nbad  += (memcmp(&x,&y,sizeof(double)) != 0)||(len != strlen(buf));
+        nlong += (sig_digits(buf) > shortest_prec(x));
+    }
+    printf("strtod round trip     : %s\n",(nbad == 0) ? "ok" : "FAILED");
+    printf("shortest output       : %s\n",(nlong == 0) ? "ok" : "FAILED");
+    nfail += (nbad != 0)+(nlong != 0);
+
+    io_init();
+    io_set_fmt(IO_ASCII);
+    mat_save(FNAME":m",'w',m);
+    io_finish();
+    io_init();
+    nbad = (mat_load(m_ld,NULL,FNAME":m") == LATAN_SUCCESS) ?\
+           mat_ndiff(m,m_ld,0.0) : 1;
+    printf("ASCII file round trip : %s\n",(nbad == 0) ? "ok" : "FAILED");
+    nfail += (nbad != 0);
+    io_finish();
+    remove(FNAME);
+
+    mat_destroy(m);
+    mat_destroy(m_ld);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
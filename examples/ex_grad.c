@@ -0,0 +1,208 @@
+/* ex_grad.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <latan/latan_fit.h>
+#include <latan/latan_models.h>
+#include "ex_check.h"
+
+/* compares the analytic derivatives of the models with central finite
+ * differences of the models, then the analytic chi^2 gradient with central
+ * finite differences of chi^2, for a positive definite correlated data
+ * variance (Cholesky path) and for a singular one (pseudo-inverse path) */
+#define NMODEL 8
+#define NPT 16
+#define NMASS 2
+#define DIFF_STEP 1.0e-6
+#define TOL 1.0e-6
+
+static void set_par(mat *p, const double mass)
+{
+    size_t i;
+
+    /* the masses are in the first half of the parameters */
+    for (i=0;i<nrow(p);i++)
+    {
+        if (i < nrow(p)/2)
+        {
+            mat_set(p,i,0,mass+0.05*(double)(i));
+        }
+        else
+        {
+            mat_set(p,i,0,0.2-0.1*(double)(i));
+        }
+    }
+}
+
+/* number of elements of the gradient df which differ by more than TOL
+ * from central finite differences of f */
+static size_t grad_ndiff(const mat *df, mat *p,                  \
+                         double (*f)(const mat *p, void *param), \
+                         void *param)
+{
+    size_t j,ndiff;
+    double p_j,h,fd,scale;
+
+    ndiff = 0;
+    for (j=0;j<nrow(p);j++)
+    {
+        p_j = mat_get(p,j,0);
+        h   = DIFF_STEP*((fabs(p_j) > 1.0) ? fabs(p_j) : 1.0);
+        mat_set(p,j,0,p_j+h);
+        fd  = f(p,param);
+        mat_set(p,j,0,p_j-h);
+        fd -= f(p,param);
+        fd /= 2.0*h;
+        mat_set(p,j,0,p_j);
+        scale  = fabs(mat_get(df,j,0));
+        scale  = (scale > 1.0) ? scale : 1.0;
+        ndiff += !(fabs(fd-mat_get(df,j,0)) <= TOL*scale);
+    }
+
+    return ndiff;
+}
+
+/* model evaluation on one point, as a function of the parameters */
+typedef struct
+{
+    fit_model *model;
+    size_t k;
+    mat *x;
+    size_t nt;
+} model_point;
+
+static double model_point_eval(const mat *p, void *vmp)
+{
+    model_point *mp;
+
+    mp = (model_point *)vmp;
+
+    return fit_model_eval(mp->model,mp->k,mp->x,p,&(mp->nt));
+}
+
+int main(void)
+{
+    fit_model *model[NMODEL] = {&fm_expdec,&fm_expdec_ex,               \
+                                &fm_expdec_splitsum,&fm_expdec_ex_splitsum,\
+                                &fm_cosh,&fm_cosh_ex,&fm_cosh_splitsum,    \
+                                &fm_cosh_ex_splitsum};
+    const char *model_name[NMODEL] = {"expdec","expdec_ex",            \
+                                      "expdec_splitsum",               \
+                                      "expdec_ex_splitsum","cosh",     \
+                                      "cosh_ex","cosh_splitsum",       \
+                                      "cosh_ex_splitsum"};
+    const double mass[NMASS] = {0.3,-0.2};
+    model_point mp;
+    fit_data *d;
+    mat *p,*df,*var,*real_p;
+    size_t npar,i,j,k,l,n,ndiff;
+    int nfail,sing;
+    char name[64];
+
+    nfail = 0;
+    mp.x  = mat_create(1,1);
+    mp.nt = NPT;
+
+    /* model derivatives */
+    for (n=0;n<NMODEL;n++)
+    {
+        mp.model = model[n];
+        npar     = fit_model_get_npar(model[n],&(mp.nt));
+        p        = mat_create(npar,1);
+        df       = mat_create(npar,1);
+        ndiff    = !fit_model_have_grad(model[n]);
+        for (l=0;(l<NMASS)&&(ndiff == 0);l++)
+        {
+            set_par(p,mass[l]);
+            for (k=0;k<model[n]->nydim;k++)
+            for (i=0;i<NPT;i++)
+            {
+                mp.k = k;
+                mat_set(mp.x,0,0,(double)(i));
+                fit_model_eval_grad(df,model[n],k,mp.x,p,&(mp.nt));
+                ndiff += grad_ndiff(df,p,&model_point_eval,&mp);
+            }
+        }
+        sprintf(name,"%s derivatives",model_name[n]);
+        nfail += ex_check(name,ndiff);
+        mat_destroy(p);
+        mat_destroy(df);
+    }
+
+    /* chi^2 gradient, the singular variance has two identical points */
+    npar   = fit_model_get_npar(&fm_expdec,NULL);
+    p      = mat_create(npar,1);
+    real_p = mat_create(npar,1);
+    df     = mat_create(npar,1);
+    var    = mat_create(NPT,NPT);
+    mat_set(real_p,0,0,0.3);
+    mat_set(real_p,1,0,0.5);
+    for (sing=0;sing<2;sing++)
+    {
+        d = fit_data_create(NPT,fm_expdec.nxdim,fm_expdec.nydim);
+        fit_data_set_model(d,&fm_expdec,NULL);
+        for (i=0;i<NPT;i++)
+        {
+            fit_data_set_x(d,i,0,(double)((sing&&(i == 1)) ? 0 : i));
+        }
+        for (i=0;i<NPT;i++)
+        for (j=0;j<NPT;j++)
+        {
+            /* 4 is a perfect square, so that the Cholesky pivot of the
+             * copied point is exactly 0 */
+            mat_set(var,i,j,4.0*pow(0.5,fabs((double)(i)-(double)(j))));
+        }
+        if (sing)
+        {
+            for (j=0;j<NPT;j++)
+            {
+                mat_set(var,1,j,mat_get(var,0,j));
+                mat_set(var,j,1,mat_get(var,j,0));
+            }
+        }
+        fit_data_set_y_covar(d,0,0,var);
+        for (i=0;i<NPT;i++)
+        {
+            fit_data_set_y(d,i,0,fit_data_model_eval(d,0,i,real_p)\
+                           *(1.0+0.05*sin((double)(i))));
+        }
+        fit_data_fit_all_points(d,true);
+        mat_set(p,0,0,0.25);
+        mat_set(p,1,0,0.7);
+        ndiff = !chi2_have_grad(d);
+        if (ndiff == 0)
+        {
+            chi2_grad(df,p,d);
+            ndiff = grad_ndiff(df,p,&chi2,d);
+        }
+        nfail += ex_check(sing ? "chi^2 gradient, singular variance" :\
+                          "chi^2 gradient, correlated variance",ndiff);
+        fit_data_destroy(d);
+    }
+
+    mat_destroy(mp.x);
+    mat_destroy(p);
+    mat_destroy(real_p);
+    mat_destroy(df);
+    mat_destroy(var);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
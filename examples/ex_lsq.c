@@ -0,0 +1,167 @@
+/* ex_lsq.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <latan/latan_minimizer.h>
+#include "ex_check.h"
+
+/* least-squares fits with known solutions: a weighted linear fit compared
+ * with the normal equation solution and its chi^2, the same fit with an
+ * upper limit on the slope below the unconstrained optimum, which puts the
+ * slope on the limit and the intercept at its conditional optimum, and an
+ * exponential fit of exact data which recovers the parameters with a
+ * vanishing chi^2 */
+#define NPT 12
+#define TOL 1.0e-8
+
+typedef struct
+{
+    double x[NPT];
+    double y[NPT];
+    double sig[NPT];
+} lsq_data;
+
+static void lin_res(mat *r, const mat *p, void *param)
+{
+    lsq_data *d;
+    size_t i;
+
+    d = (lsq_data *)param;
+    for (i=0;i<NPT;i++)
+    {
+        mat_set(r,i,0,(mat_get(p,0,0) + mat_get(p,1,0)*d->x[i] - d->y[i])\
+                /d->sig[i]);
+    }
+}
+
+static void exp_res(mat *r, const mat *p, void *param)
+{
+    lsq_data *d;
+    size_t i;
+
+    d = (lsq_data *)param;
+    for (i=0;i<NPT;i++)
+    {
+        mat_set(r,i,0,(mat_get(p,0,0)*exp(-mat_get(p,1,0)*d->x[i])     \
+                       - d->y[i])/d->sig[i]);
+    }
+}
+
+/* chi^2 of the linear model with intercept a and slope b */
+static double lin_chi2(const lsq_data *d, const double a, const double b)
+{
+    size_t i;
+    double chi2;
+
+    chi2 = 0.0;
+    for (i=0;i<NPT;i++)
+    {
+        chi2 += pow((a + b*d->x[i] - d->y[i])/d->sig[i],2.0);
+    }
+
+    return chi2;
+}
+
+int main(void)
+{
+    lsq_data d;
+    mat *p,*p_ref,*lim,*chi2,*chi2_ref;
+    double w,s,sx,sxx,sy,sxy,a,b,f_min;
+    size_t i;
+    int nfail;
+
+    nfail    = 0;
+    p        = mat_create(2,1);
+    p_ref    = mat_create(2,1);
+    lim      = mat_create(2,2);
+    chi2     = mat_create(1,1);
+    chi2_ref = mat_create(1,1);
+
+    /* linear fit, reference from the normal equations */
+    s   = 0.0;
+    sx  = 0.0;
+    sxx = 0.0;
+    sy  = 0.0;
+    sxy = 0.0;
+    for (i=0;i<NPT;i++)
+    {
+        d.x[i]   = 0.5*(double)(i);
+        d.y[i]   = 1.3 + 0.7*d.x[i] + 0.2*sin(3.0*(double)(i));
+        d.sig[i] = 0.1*(1.0 + 0.1*(double)(i));
+        w        = 1.0/(d.sig[i]*d.sig[i]);
+        s       += w;
+        sx      += w*d.x[i];
+        sxx     += w*d.x[i]*d.x[i];
+        sy      += w*d.y[i];
+        sxy     += w*d.x[i]*d.y[i];
+    }
+    b = (s*sxy - sx*sy)/(s*sxx - sx*sx);
+    a = (sy - b*sx)/s;
+    mat_set(p_ref,0,0,a);
+    mat_set(p_ref,1,0,b);
+    mat_set(chi2_ref,0,0,lin_chi2(&d,a,b));
+    mat_set(p,0,0,0.0);
+    mat_set(p,1,0,0.0);
+    minimize_lsq(p,NULL,&f_min,NPT,&lin_res,NULL,&d);
+    mat_set(chi2,0,0,f_min);
+    nfail += ex_check("linear fit parameters",mat_ndiff(p_ref,p,TOL));
+    nfail += ex_check("linear fit chi^2",mat_ndiff(chi2_ref,chi2,TOL));
+
+    /* same fit with the slope limited below its optimum, starting outside
+     * the limits */
+    b = b - 0.1;
+    a = (sy - b*sx)/s;
+    mat_set(p_ref,0,0,a);
+    mat_set(p_ref,1,0,b);
+    mat_set(chi2_ref,0,0,lin_chi2(&d,a,b));
+    mat_set(lim,0,0,latan_nan());
+    mat_set(lim,0,1,latan_nan());
+    mat_set(lim,1,0,latan_nan());
+    mat_set(lim,1,1,b);
+    mat_set(p,0,0,0.0);
+    mat_set(p,1,0,2.0);
+    minimize_lsq(p,lim,&f_min,NPT,&lin_res,NULL,&d);
+    mat_set(chi2,0,0,f_min);
+    nfail += ex_check("limited linear fit parameters",mat_ndiff(p_ref,p,TOL));
+    nfail += ex_check("limited linear fit chi^2",\
+                      mat_ndiff(chi2_ref,chi2,TOL));
+
+    /* exponential fit of exact data */
+    for (i=0;i<NPT;i++)
+    {
+        d.y[i] = 2.0*exp(-0.4*d.x[i]);
+    }
+    mat_set(p_ref,0,0,2.0);
+    mat_set(p_ref,1,0,0.4);
+    mat_set(p,0,0,1.0);
+    mat_set(p,1,0,0.1);
+    minimize_lsq(p,NULL,&f_min,NPT,&exp_res,NULL,&d);
+    nfail += ex_check("exponential fit parameters",mat_ndiff(p_ref,p,TOL));
+    nfail += ex_check("exponential fit chi^2",!(f_min < 1.0e-20));
+
+    mat_destroy(p);
+    mat_destroy(p_ref);
+    mat_destroy(lim);
+    mat_destroy(chi2);
+    mat_destroy(chi2_ref);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,141 @@
+/* ex_models.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+#include <latan/latan_fit.h>
+#include <latan/latan_mat.h>
+#include <latan/latan_models.h>
+#include "ex_check.h"
+
+/* evaluates the predefined models on all the points at once and checks the
+ * result against the point by point evaluation, for masses in the usual
+ * range and for the large masses of both signs a minimizer can try, on
+ * evenly and unevenly spaced points ; the amplitudes are chosen so that the
+ * models are of order 1 in the middle of the range, the parameters for which
+ * a model overflows on some point are skipped */
+#define NMODEL 8
+#define NPT 40
+#define NMASS 4
+#define TOL 1.0e-12
+
+static void set_par(mat *p, const double mass)
+{
+    size_t i;
+
+    /* the masses are in the first half of the parameters */
+    for (i=0;i<nrow(p);i++)
+    {
+        if (i < nrow(p)/2)
+        {
+            mat_set(p,i,0,mass);
+        }
+        else
+        {
+            mat_set(p,i,0,0.5*mass*(double)(NPT)+0.5-0.25*(double)(i));
+        }
+    }
+}
+
+static bool is_finite(const mat *m)
+{
+    size_t i,j;
+
+    for (i=0;i<nrow(m);i++)
+    for (j=0;j<ncol(m);j++)
+    {
+        if (!(fabs(mat_get(m,i,j)) <= DBL_MAX))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(void)
+{
+    fit_model *model[NMODEL] = {&fm_expdec,&fm_expdec_ex,               \
+                                &fm_expdec_splitsum,&fm_expdec_ex_splitsum,\
+                                &fm_cosh,&fm_cosh_ex,&fm_cosh_splitsum,    \
+                                &fm_cosh_ex_splitsum};
+    const char *model_name[NMODEL] = {"expdec","expdec_ex",            \
+                                      "expdec_splitsum",               \
+                                      "expdec_ex_splitsum","cosh",     \
+                                      "cosh_ex","cosh_splitsum",       \
+                                      "cosh_ex_splitsum"};
+    const double mass[NMASS] = {0.3,-0.2,23.3,-23.3};
+    size_t nt,npar,i,k,l,n,ndiff,ntest;
+    mat *x,*x_i,*p,*res,*res_ref;
+    int nfail,sp;
+    char name[64];
+
+    nfail   = 0;
+    nt      = NPT;
+    x       = mat_create(1,NPT);
+    x_i     = mat_create(1,1);
+    res     = mat_create(NPT,1);
+    res_ref = mat_create(NPT,1);
+    for (sp=0;sp<2;sp++)
+    {
+        for (i=0;i<ncol(x);i++)
+        {
+            mat_set(x,0,i,(sp == 0) ? (double)(i) : 0.025*(double)(i*i));
+        }
+        for (n=0;n<NMODEL;n++)
+        {
+            npar  = fit_model_get_npar(model[n],&nt);
+            p     = mat_create(npar,1);
+            ndiff = 0;
+            ntest = 0;
+            for (l=0;l<NMASS;l++)
+            {
+                set_par(p,mass[l]);
+                for (k=0;k<model[n]->nydim;k++)
+                {
+                    fit_model_eval_batch(res,model[n],k,x,p,&nt);
+                    for (i=0;i<ncol(x);i++)
+                    {
+                        mat_set(x_i,0,0,mat_get(x,0,i));
+                        mat_set(res_ref,i,0,\
+                                fit_model_eval(model[n],k,x_i,p,&nt));
+                    }
+                    if (is_finite(res_ref))
+                    {
+                        ndiff += mat_ndiff(res_ref,res,TOL);
+                        ntest++;
+                    }
+                }
+            }
+            sprintf(name,"%s batch, %s points",model_name[n],\
+                    (sp == 0) ? "even" : "uneven");
+            nfail += ex_check(name,ndiff+(ntest == 0));
+            mat_destroy(p);
+        }
+    }
+
+    mat_destroy(x);
+    mat_destroy(x_i);
+    mat_destroy(res);
+    mat_destroy(res_ref);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,110 @@
+/* ex_ranlux.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <latan/latan_rand.h>
+
+/* draws a sequence of ranlux numbers and compares it with reference values
+ * computed with the scalar integer kernel, so that the AVX2 (--enable-AVX2)
+ * and SSE (--enable-SSE) kernels are checked to give a bit-identical
+ * sequence, then checks that bulk and single draws give the same numbers
+ * and that the moments of bulk normal draws match the normal distribution
+ * within 5 standard errors */
+#define SEED 20120101
+#define NDRAW 1000000
+#define NREF 5
+#define N_MEAN 1.0
+#define N_SIGMA 2.0
+
+int main(void)
+{
+    const size_t ref_ind[NREF] = {0,1,1000,123457,999999};
+    const double ref_val[NREF] = {0.2435363047311121,      \
+                                  0.041972555635645392,    \
+                                  0.53869061914508976,     \
+                                  0.069641446853484723,    \
+                                  0.00098020073104621019};
+    const double ref_sum       = 500513.37788790499;
+    rg *g;
+    double *r,sum,x,m1,m2,m4,err;
+    size_t i,ndiff;
+    int nfail;
+
+    nfail = 0;
+    r     = (double *)malloc(NDRAW*sizeof(double));
+    if (r == NULL)
+    {
+        fprintf(stderr,"error: memory allocation failed\n");
+        return EXIT_FAILURE;
+    }
+    g = rg_create();
+
+    rg_init(g,SEED);
+    rg_u_fill(g,r,NDRAW,0.0,1.0);
+    sum   = 0.0;
+    ndiff = 0;
+    for (i=0;i<NDRAW;i++)
+    {
+        sum += r[i];
+    }
+    for (i=0;i<NREF;i++)
+    {
+        ndiff += (r[ref_ind[i]] != ref_val[i]);
+    }
+    ndiff += (sum != ref_sum);
+    printf("reference sequence : %s\n",(ndiff == 0) ? "ok" : "FAILED");
+    nfail += (ndiff != 0);
+
+    rg_init(g,SEED);
+    ndiff = 0;
+    for (i=0;i<NDRAW;i++)
+    {
+        ndiff += (rg_u(g,0.0,1.0) != r[i]);
+    }
+    printf("single draws       : %s\n",(ndiff == 0) ? "ok" : "FAILED");
+    nfail += (ndiff != 0);
+
+    /* odd number of normal draws, so that the last block is partial */
+    rg_n_fill(g,r,NDRAW-1,N_MEAN,N_SIGMA);
+    m1 = 0.0;
+    m2 = 0.0;
+    m4 = 0.0;
+    for (i=0;i<NDRAW-1;i++)
+    {
+        x   = (r[i] - N_MEAN)/N_SIGMA;
+        m1 += x;
+        m2 += x*x;
+        m4 += x*x*x*x;
+    }
+    m1   /= (double)(NDRAW-1);
+    m2   /= (double)(NDRAW-1);
+    m4   /= (double)(NDRAW-1);
+    err   = 5.0/sqrt((double)(NDRAW-1));
+    ndiff = (fabs(m1) > err) + (fabs(m2-1.0) > err*sqrt(2.0))\
+            + (fabs(m4-3.0) > err*sqrt(96.0));
+    printf("normal moments     : %s\n",(ndiff == 0) ? "ok" : "FAILED");
+    nfail += (ndiff != 0);
+
+    rg_destroy(g);
+    free(r);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
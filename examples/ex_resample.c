@@ -0,0 +1,232 @@
+/* ex_resample.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <latan/latan_mat.h>
+#include <latan/latan_rand.h>
+#include <latan/latan_statistics.h>
+#include "ex_check.h"
+
+/* bootstraps the mean of random data and checks that the serial and the
+ * parallel resampling give the same samples with counter-based resampling,
+ * that the parallel samples do not depend on the number of threads, and
+ * that the matrix product bootstrap of rs_mean agrees with the generic one,
+ * serial or parallel, and that the parallel replicas are pairwise distinct;
+ * the delete-d jackknife samples of the mean are compared with a brute force
+ * computation, and the resampling of a function of the mean with the generic
+ * resampling */
+#define NDAT 60
+#define NROW 3
+#define NCOL 2
+#define NBOOT 600
+#define CB_SEED 314159UL
+#define JK_DEPTH 2
+
+/* mean with explicit loops, so that resample uses the generic bootstrap */
+static latan_errno rs_mean_loop(mat *res, mat **dat, const size_t ndat,\
+                                void *nothing)
+{
+    size_t i,j,k;
+    double sum;
+
+    (void)nothing;
+    for (i=0;i<nrow(res);i++)
+    for (j=0;j<ncol(res);j++)
+    {
+        sum = 0.0;
+        for (k=0;k<ndat;k++)
+        {
+            sum += mat_get(dat[k],i,j);
+        }
+        mat_set(res,i,j,sum/((double)(ndat)));
+    }
+
+    return LATAN_SUCCESS;
+}
+
+/* squared mean, a non-linear function of the mean */
+static latan_errno rs_sq_mean(mat *res, mat **dat, const size_t ndat,\
+                              void *nothing)
+{
+    latan_errno status;
+    
+    status = rs_mean_loop(res,dat,ndat,nothing);
+    if (status == LATAN_SUCCESS)
+    {
+        status = mat_eqmulp(res,res);
+    }
+    
+    return status;
+}
+
+/* mean then delete-1 and delete-2 jackknife means with explicit loops, a
+ * delete-1 sample removes d1 = d2 */
+static void jackknife_brute(rs_sample *s, mat **dat)
+{
+    size_t d,d1,d2,d2_end,k,i,j,n;
+    double sum;
+    
+    rs_mean_loop(rs_sample_pt_cent_val(s),dat,NDAT,NULL);
+    n = 0;
+    for (d=1;d<=JK_DEPTH;d++)
+    for (d1=0;d1<NDAT;d1++)
+    {
+        d2_end = (d == 1) ? d1 + 1 : NDAT;
+        for (d2=d1+d-1;d2<d2_end;d2++)
+        {
+            for (i=0;i<NROW;i++)
+            for (j=0;j<NCOL;j++)
+            {
+                sum = 0.0;
+                for (k=0;k<NDAT;k++)
+                {
+                    if ((k != d1)&&(k != d2))
+                    {
+                        sum += mat_get(dat[k],i,j);
+                    }
+                }
+                mat_set(rs_sample_pt_sample(s,n),i,j,sum/(double)(NDAT-d));
+            }
+            n++;
+        }
+    }
+}
+
+int main(void)
+{
+    mat **dat;
+    rs_sample *s_ser,*s_par,*s_tmp,*s_jk,*s_jkg,*s_jkr;
+    size_t k,i,j,ndup,njk;
+    latan_error_handler_t *handler;
+    int nfail;
+#ifdef _OPENMP
+    int nthread;
+#endif
+
+    nfail = 0;
+    dat   = mat_ar_create(NDAT,NROW,NCOL);
+    s_ser = rs_sample_create(NROW,NCOL,NBOOT);
+    s_par = rs_sample_create(NROW,NCOL,NBOOT);
+    s_tmp = rs_sample_create(NROW,NCOL,NBOOT);
+    randgen_init(11);
+    for (k=0;k<NDAT;k++)
+    for (i=0;i<NROW;i++)
+    for (j=0;j<NCOL;j++)
+    {
+        mat_set(dat[k],i,j,rand_n((double)(i+j),1.0));
+    }
+
+    /* counter-based resampling, serial and parallel */
+    resample_set_counter_based(true,CB_SEED);
+    resample_set_parallel(false);
+    resample(s_ser,dat,NDAT,&rs_mean_loop,BOOT,NULL);
+    resample_set_parallel(true);
+    resample(s_par,dat,NDAT,&rs_mean_loop,BOOT,NULL);
+    nfail += ex_check("counter-based serial/parallel",\
+                   rs_sample_ndiff(s_ser,s_par,0.0));
+
+    /* seeded resampling gives the counter-based samples */
+    resample_set_counter_based(false,0);
+    resample_seeded(s_tmp,dat,NDAT,&rs_mean_loop,NULL,CB_SEED);
+    nfail += ex_check("seeded/counter-based",rs_sample_ndiff(s_ser,s_tmp,0.0)\
+                   + resample_get_counter_based());
+
+    /* matrix product bootstrap of the mean, up to rounding */
+    resample_set_counter_based(true,CB_SEED);
+    resample(s_tmp,dat,NDAT,&rs_mean,BOOT,NULL);
+    nfail += ex_check("matrix product rs_mean/generic",\
+                   rs_sample_ndiff(s_ser,s_tmp,1.0e-12));
+    resample_set_counter_based(false,0);
+
+    /* parallel bootstrap of the mean, matrix product and generic */
+    randgen_init(7);
+    resample(s_par,dat,NDAT,&rs_mean_loop,BOOT,NULL);
+    randgen_init(7);
+    resample(s_tmp,dat,NDAT,&rs_mean,BOOT,NULL);
+    nfail += ex_check("parallel matrix product rs_mean/generic",\
+                   rs_sample_ndiff(s_par,s_tmp,1.0e-12));
+    ndup = 0;
+    for (k=0;k<NBOOT;k++)
+    for (i=k+1;i<NBOOT;i++)
+    {
+        ndup += (mat_ndiff(rs_sample_pt_sample(s_par,k),\
+                           rs_sample_pt_sample(s_par,i),0.0) == 0);
+    }
+    nfail += ex_check("parallel replicas distinct",ndup);
+
+#ifdef _OPENMP
+    /* parallel resampling with 1 thread and with several threads */
+    nthread = (omp_get_max_threads() > 4) ? omp_get_max_threads() : 4;
+    omp_set_num_threads(1);
+    randgen_init(5);
+    resample(s_ser,dat,NDAT,&rs_mean_loop,BOOT,NULL);
+    omp_set_num_threads(nthread);
+    randgen_init(5);
+    resample(s_par,dat,NDAT,&rs_mean_loop,BOOT,NULL);
+    nfail += ex_check("parallel 1 thread/several threads",\
+                   rs_sample_ndiff(s_ser,s_par,0.0));
+#endif
+    resample_set_parallel(false);
+
+    /* delete-d jackknife, rs_mean fast path, generic and brute force */
+    njk   = jackknife_nsample(NDAT,JK_DEPTH);
+    nfail += ex_check("jackknife sample number",\
+                      njk != NDAT + NDAT*(NDAT-1)/2);
+    s_jk  = rs_sample_create(NROW,NCOL,njk);
+    s_jkg = rs_sample_create(NROW,NCOL,njk);
+    s_jkr = rs_sample_create(NROW,NCOL,njk);
+    jackknife_brute(s_jkr,dat);
+    resample(s_jk,dat,NDAT,&rs_mean,JACK(JK_DEPTH),NULL);
+    resample(s_jkg,dat,NDAT,&rs_mean_loop,JACK(JK_DEPTH),NULL);
+    nfail += ex_check("jackknife rs_mean/brute force",\
+                      rs_sample_ndiff(s_jk,s_jkr,1.0e-12));
+    nfail += ex_check("jackknife generic/brute force",\
+                      rs_sample_ndiff(s_jkg,s_jkr,0.0));
+    handler = latan_set_error_handler_off();
+    nfail += ex_check("jackknife wrong sample number",\
+                      resample(s_tmp,dat,NDAT,&rs_mean,JACK(JK_DEPTH),NULL)\
+                      != LATAN_EBADLEN);
+    latan_set_error_handler(handler);
+
+    /* resampling of a function of the mean */
+    resample_of_mean(s_jk,dat,NDAT,&rs_sq_mean,JACK(JK_DEPTH),NULL);
+    resample(s_jkg,dat,NDAT,&rs_sq_mean,JACK(JK_DEPTH),NULL);
+    nfail += ex_check("jackknife function of the mean",\
+                      rs_sample_ndiff(s_jk,s_jkg,1.0e-12));
+    resample_set_counter_based(true,CB_SEED);
+    resample_of_mean(s_ser,dat,NDAT,&rs_sq_mean,BOOT,NULL);
+    resample(s_tmp,dat,NDAT,&rs_sq_mean,BOOT,NULL);
+    nfail += ex_check("bootstrap function of the mean",\
+                      rs_sample_ndiff(s_ser,s_tmp,1.0e-12));
+    resample_set_counter_based(false,0);
+
+    mat_ar_destroy(dat,NDAT);
+    rs_sample_destroy(s_ser);
+    rs_sample_destroy(s_par);
+    rs_sample_destroy(s_tmp);
+    rs_sample_destroy(s_jk);
+    rs_sample_destroy(s_jkg);
+    rs_sample_destroy(s_jkr);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,109 @@
+/* ex_rsfit.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <latan/latan_fit.h>
+#include <latan/latan_minimizer.h>
+#include <latan/latan_models.h>
+#include <latan/latan_rand.h>
+#include <latan/latan_statistics.h>
+#include "ex_check.h"
+
+/* fits an exponential decay on each sample of resampled data, serially and
+ * in parallel, and checks that the fitted parameters and the central value
+ * chi^2 are the same */
+#define ERR 0.02
+#define NDATA 16
+#define NPAR 2
+#define NSAMPLE 64
+#define STEP 0.25
+
+int main(void)
+{
+    fit_data *d;
+    rs_sample *data,*p_ser,*p_par;
+    mat *real_param,*var;
+    double chi2_ser,chi2_par,y;
+    size_t i,s,ndiff;
+    int nfail;
+
+    nfail      = 0;
+    d          = fit_data_create(NDATA,fm_expdec.nxdim,fm_expdec.nydim);
+    data       = rs_sample_create(NDATA,1,NSAMPLE);
+    p_ser      = rs_sample_create(NPAR,1,NSAMPLE);
+    p_par      = rs_sample_create(NPAR,1,NSAMPLE);
+    real_param = mat_create(NPAR,1);
+    var        = mat_create(NDATA,1);
+
+    randgen_init(2012);
+    mat_set(real_param,0,0,0.5);
+    mat_set(real_param,1,0,log(5.0));
+    mat_cst(var,ERR*ERR);
+    fit_data_set_model(d,&fm_expdec,NULL);
+    fit_data_set_y_covar(d,0,0,var);
+    for (i=0;i<NDATA;i++)
+    {
+        fit_data_set_x(d,i,0,(double)(i)*STEP);
+    }
+    for (i=0;i<NDATA;i++)
+    {
+        y = fit_data_model_eval(d,0,i,real_param);
+        mat_set(rs_sample_pt_cent_val(data),i,0,y+rand_n(0.0,ERR));
+        for (s=0;s<NSAMPLE;s++)
+        {
+            mat_set(rs_sample_pt_sample(data,s),i,0,y+rand_n(0.0,ERR));
+        }
+    }
+    fit_data_fit_all_points(d,true);
+    minimizer_set_alg(LSQ_LM);
+
+    mat_set(rs_sample_pt_cent_val(p_ser),0,0,0.3);
+    mat_set(rs_sample_pt_cent_val(p_ser),1,0,1.0);
+    mat_cp(rs_sample_pt_cent_val(p_par),rs_sample_pt_cent_val(p_ser));
+    rs_data_fit_set_parallel(false);
+    rs_data_fit(p_ser,NULL,NULL,&data,d,NO_COR,NULL);
+    chi2_ser = fit_data_get_chi2(d);
+    rs_data_fit_set_parallel(true);
+    rs_data_fit(p_par,NULL,NULL,&data,d,NO_COR,NULL);
+    chi2_par = fit_data_get_chi2(d);
+    rs_data_fit_set_parallel(false);
+
+    ndiff  = mat_ndiff(rs_sample_pt_cent_val(p_ser),\
+                       rs_sample_pt_cent_val(p_par),0.0);
+    ndiff += (chi2_ser != chi2_par);
+    printf("central value fit      : %s\n",(ndiff == 0) ? "ok" : "FAILED");
+    nfail += (ndiff != 0);
+    ndiff = rs_sample_ndiff(p_ser,p_par,0.0);
+    printf("serial/parallel samples: %s\n",(ndiff == 0) ? "ok" : "FAILED");
+    nfail += (ndiff != 0);
+    ndiff = (fabs(mat_get(rs_sample_pt_cent_val(p_ser),0,0)-0.5) > 0.1);
+    printf("fitted decay rate      : %s\n",(ndiff == 0) ? "ok" : "FAILED");
+    nfail += (ndiff != 0);
+
+    fit_data_destroy(d);
+    rs_sample_destroy(data);
+    rs_sample_destroy(p_ser);
+    rs_sample_destroy(p_par);
+    mat_destroy(real_param);
+    mat_destroy(var);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,177 @@
+/* ex_seed.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <latan/latan_mat.h>
+#include <latan/latan_io.h>
+#include <latan/latan_rand.h>
+#include <latan/latan_statistics.h>
+#include "ex_check.h"
+
+/* for each file format, generates a seeded bootstrap sample of the mean of
+ * binned data files and compares it with the generic bootstrap of the data
+ * loaded explicitly, saves its recipe and checks that loading it gives the
+ * same sample, the same sub-sample, and that the recipe file is smaller
+ * than the file of the full sample */
+#define NFILE 12
+#define BINSIZE 3
+#define NROW 5
+#define NCOL 2
+#define NSAMPLE 200
+#define SEED 2718281828UL
+#define MAN_FNAME "ex_seed.man"
+
+/* mean with explicit loops, so that resample uses the generic bootstrap */
+static latan_errno rs_mean_loop(mat *res, mat **dat, const size_t ndat,\
+                                void *nothing)
+{
+    size_t i,j,k;
+    double sum;
+
+    (void)nothing;
+    for (i=0;i<nrow(res);i++)
+    for (j=0;j<ncol(res);j++)
+    {
+        sum = 0.0;
+        for (k=0;k<ndat;k++)
+        {
+            sum += mat_get(dat[k],i,j);
+        }
+        mat_set(res,i,j,sum/((double)(ndat)));
+    }
+
+    return LATAN_SUCCESS;
+}
+
+static long file_size(const char *fname)
+{
+    struct stat st;
+
+    return (stat(fname,&st) == 0) ? (long)(st.st_size) : -1L;
+}
+
+int main(void)
+{
+    const char *fmt_name[3] = {"xml","ascii","bin"};
+    const char *fmt_ext[3]  = {"xml","dat","bin"};
+    const io_fmt_no fmt[3]  = {IO_XML,IO_ASCII,IO_BIN};
+    mat **dat,**bin;
+    rs_sample *s,*s_ref,*s_ld,*sub,*sub_ld;
+    rs_seed sd;
+    strbuf fname,path,seed_fname,full_fname;
+    FILE *man;
+    size_t i,k,ndiff;
+    long seed_size,full_size;
+    int nfail;
+    char name[64];
+
+    nfail  = 0;
+    dat    = mat_ar_create(NFILE,NROW,NCOL);
+    bin    = mat_ar_create(NFILE/BINSIZE,NROW,NCOL);
+    s      = rs_sample_create(NROW,NCOL,NSAMPLE);
+    s_ref  = rs_sample_create(NROW,NCOL,NSAMPLE);
+    s_ld   = rs_sample_create(NROW,NCOL,NSAMPLE);
+    sub    = rs_sample_create(3,1,NSAMPLE);
+    sub_ld = rs_sample_create(3,1,NSAMPLE);
+    randgen_init(17);
+    for (i=0;i<NFILE;i++)
+    {
+        for (k=0;k<NROW*NCOL;k++)
+        {
+            mat_set(dat[i],k/NCOL,k%NCOL,rand_n((double)(k),1.0));
+        }
+    }
+    for (i=0;i<NFILE/BINSIZE;i++)
+    {
+        mat_mean(bin[i],dat+i*BINSIZE,BINSIZE);
+    }
+
+    io_init();
+    for (k=0;k<3;k++)
+    {
+        io_set_fmt(fmt[k]);
+        man = fopen(MAN_FNAME,"w");
+        for (i=0;i<NFILE;i++)
+        {
+            sprintf(fname,"ex_seed_%d.%s",(int)(i),fmt_ext[k]);
+            fprintf(man,"%s\n",fname);
+            sprintf(path,"%s:m",fname);
+            mat_save(path,'w',dat[i]);
+        }
+        fclose(man);
+        io_finish();
+        io_init();
+        io_set_fmt(fmt[k]);
+
+        /* seeded sample and generic bootstrap of the binned data */
+        rs_sample_seed(s,&sd,MAN_FNAME,"m",BINSIZE,SEED);
+        resample_seeded(s_ref,bin,NFILE/BINSIZE,&rs_mean_loop,NULL,SEED);
+        sprintf(name,"%s seeded/generic bootstrap",fmt_name[k]);
+        nfail += ex_check(name,rs_sample_ndiff(s_ref,s,1.0e-12));
+
+        /* recipe and full sample files */
+        sprintf(seed_fname,"ex_seed_sd.%s",fmt_ext[k]);
+        sprintf(full_fname,"ex_seed_full.%s",fmt_ext[k]);
+        sprintf(path,"%s:sd",seed_fname);
+        rs_sample_save_seed(path,'w',&sd);
+        sprintf(path,"%s:s",full_fname);
+        rs_sample_save(path,'w',s);
+        io_finish();
+        io_init();
+        io_set_fmt(fmt[k]);
+        sprintf(path,"%s:sd",seed_fname);
+        ndiff = (rs_sample_load(s_ld,NULL,NULL,path) == LATAN_SUCCESS) ?\
+                rs_sample_ndiff(s,s_ld,0.0) : 1;
+        sprintf(name,"%s seeded save/load",fmt_name[k]);
+        nfail += ex_check(name,ndiff);
+        rs_sample_get_subsamp(sub,s,1,1,3,1);
+        ndiff = (rs_sample_load_subsamp(sub_ld,path,1,1,3,1) == LATAN_SUCCESS)\
+                ? rs_sample_ndiff(sub,sub_ld,0.0) : 1;
+        sprintf(name,"%s seeded sub-sample load",fmt_name[k]);
+        nfail += ex_check(name,ndiff);
+        seed_size = file_size(seed_fname);
+        full_size = file_size(full_fname);
+        sprintf(name,"%s recipe smaller than sample",fmt_name[k]);
+        nfail += ex_check(name,(seed_size <= 0)||(seed_size >= full_size));
+
+        io_finish();
+        io_init();
+        remove(seed_fname);
+        remove(full_fname);
+        for (i=0;i<NFILE;i++)
+        {
+            sprintf(fname,"ex_seed_%d.%s",(int)(i),fmt_ext[k]);
+            remove(fname);
+        }
+    }
+    io_finish();
+    remove(MAN_FNAME);
+
+    mat_ar_destroy(dat,NFILE);
+    mat_ar_destroy(bin,NFILE/BINSIZE);
+    rs_sample_destroy(s);
+    rs_sample_destroy(s_ref);
+    rs_sample_destroy(s_ld);
+    rs_sample_destroy(sub);
+    rs_sample_destroy(sub_ld);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,151 @@
+/* ex_xml.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <latan/latan_mat.h>
+#include <latan/latan_io.h>
+#include <latan/latan_rand.h>
+#include <latan/latan_statistics.h>
+#include "ex_check.h"
+
+/* saves a sample large enough for the XML file to be streamed on load
+ * between smaller objects, loads them back by name and checks that they are
+ * unchanged, including after a sample size query, then rewrites the file
+ * with a small sample of the same name and checks that the new one is read */
+#define FNAME "ex_xml.xml"
+#define STREAM_SIZE 16777216L /* default of LATAN_XML_STREAM_SIZE */
+#define NROW 20
+#define NCOL 10
+#define NSAMPLE 2000
+#define NSAMPLE_SMALL 3
+
+static void mat_fill_rand(mat *m)
+{
+    size_t i,j;
+
+    for (i=0;i<nrow(m);i++)
+    for (j=0;j<ncol(m);j++)
+    {
+        mat_set(m,i,j,rand_n(0.0,1.0));
+    }
+}
+
+static void rs_sample_fill_rand(rs_sample *s)
+{
+    size_t i;
+
+    mat_fill_rand(rs_sample_pt_cent_val(s));
+    for (i=0;i<rs_sample_get_nsample(s);i++)
+    {
+        mat_fill_rand(rs_sample_pt_sample(s,i));
+    }
+}
+
+static long file_size(const char *fname)
+{
+    struct stat st;
+
+    return (stat(fname,&st) == 0) ? (long)(st.st_size) : -1L;
+}
+
+int main(void)
+{
+    mat *first,*last,*m_ld;
+    rs_sample *big,*big_ld,*small,*small_ld;
+    size_t ndiff,nsample,dim[2];
+    int nfail;
+
+    nfail    = 0;
+    first    = mat_create(NROW,NCOL);
+    last     = mat_create(NROW,NCOL);
+    m_ld     = mat_create(NROW,NCOL);
+    big      = rs_sample_create(NROW,NCOL,NSAMPLE);
+    big_ld   = rs_sample_create(NROW,NCOL,NSAMPLE);
+    small    = rs_sample_create(2,2,NSAMPLE_SMALL);
+    small_ld = rs_sample_create(2,2,NSAMPLE_SMALL);
+    randgen_init(5);
+    mat_fill_rand(first);
+    mat_fill_rand(last);
+    rs_sample_fill_rand(big);
+    rs_sample_fill_rand(small);
+
+    io_init();
+    io_set_fmt(IO_XML);
+    mat_save(FNAME":first",'w',first);
+    rs_sample_save(FNAME":big",'a',big);
+    mat_save(FNAME":last",'a',last);
+    rs_sample_save(FNAME":small",'a',small);
+    io_finish();
+    io_init();
+    io_set_fmt(IO_XML);
+    nfail += ex_check("file above the streaming size",\
+                      file_size(FNAME) < STREAM_SIZE);
+
+    /* objects before and after the large sample */
+    ndiff  = (mat_load(m_ld,NULL,FNAME":last") == LATAN_SUCCESS) ?\
+             mat_ndiff(last,m_ld,0.0) : 1;
+    ndiff += (mat_load(m_ld,NULL,FNAME":first") == LATAN_SUCCESS) ?\
+             mat_ndiff(first,m_ld,0.0) : 1;
+    ndiff += (rs_sample_load(small_ld,NULL,NULL,FNAME":small")\
+              == LATAN_SUCCESS) ? rs_sample_ndiff(small,small_ld,0.0) : 1;
+    nfail += ex_check("streamed named loads",ndiff);
+
+    /* sample size query followed by the load */
+    if (rs_sample_load(NULL,&nsample,dim,FNAME":big") == LATAN_SUCCESS)
+    {
+        ndiff = (nsample != NSAMPLE)+(dim[0] != NROW)+(dim[1] != NCOL);
+    }
+    else
+    {
+        ndiff = 1;
+    }
+    nfail += ex_check("streamed sample size query",ndiff);
+    ndiff = (rs_sample_load(big_ld,NULL,NULL,FNAME":big") == LATAN_SUCCESS) ?\
+            rs_sample_ndiff(big,big_ld,0.0) : 1;
+    nfail += ex_check("streamed sample load",ndiff);
+
+    /* rewrite after a query, the reader kept by the query is dropped */
+    rs_sample_load(NULL,&nsample,dim,FNAME":big");
+    rs_sample_fill_rand(small);
+    rs_sample_save(FNAME":big",'w',small);
+    if (rs_sample_load(small_ld,&nsample,dim,FNAME":big") == LATAN_SUCCESS)
+    {
+        ndiff  = (nsample != NSAMPLE_SMALL)+(dim[0] != 2)+(dim[1] != 2);
+        ndiff += rs_sample_ndiff(small,small_ld,0.0);
+    }
+    else
+    {
+        ndiff = 1;
+    }
+    nfail += ex_check("load after rewrite",ndiff);
+    io_finish();
+    remove(FNAME);
+
+    mat_destroy(first);
+    mat_destroy(last);
+    mat_destroy(m_ld);
+    rs_sample_destroy(big);
+    rs_sample_destroy(big_ld);
+    rs_sample_destroy(small);
+    rs_sample_destroy(small_ld);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
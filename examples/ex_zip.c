@@ -0,0 +1,115 @@
+/* ex_zip.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <latan/latan_mat.h>
+#include <latan/latan_io.h>
+#include <latan/latan_rand.h>
+#include <latan/latan_statistics.h>
+#include "ex_check.h"
+
+/* saves a matrix and a sample in compressed files of each format, loads them
+ * back and checks that they are unchanged */
+#define NROW 7
+#define NCOL 5
+#define NSAMPLE 50
+
+int main(void)
+{
+    const char *ext[2]      = {".gz",".zst"};
+    const char *fmt_name[3] = {"xml","ascii","bin"};
+    const char *fmt_ext[3]  = {"xml","dat","bin"};
+    const io_fmt_no fmt[3]  = {IO_XML,IO_ASCII,IO_BIN};
+    mat *m,*m_ld;
+    rs_sample *s,*s_ld;
+    strbuf fname,path;
+    FILE *f;
+    size_t i,j,k,e,ndiff,nsample,dim[2];
+    int nfail;
+
+    m    = mat_create(NROW,NCOL);
+    m_ld = mat_create(NROW,NCOL);
+    s    = rs_sample_create(NROW,NCOL,NSAMPLE);
+    s_ld = rs_sample_create(NROW,NCOL,NSAMPLE);
+    randgen_init(42);
+    for (i=0;i<NROW;i++)
+    for (j=0;j<NCOL;j++)
+    {
+        mat_set(m,i,j,rand_n(0.0,1.0e-3));
+        mat_set(rs_sample_pt_cent_val(s),i,j,rand_n(0.0,1.0e5));
+        for (k=0;k<NSAMPLE;k++)
+        {
+            mat_set(rs_sample_pt_sample(s,k),i,j,rand_n(0.0,1.0));
+        }
+    }
+    nfail = 0;
+
+    io_init();
+    for (e=0;e<2;e++)
+    {
+        sprintf(fname,"ex_zip.txt%s",ext[e]);
+        f = io_fopen(fname,"w");
+        if (f == NULL)
+        {
+            printf("%-4s: not supported in this build, skipped\n",ext[e]);
+            continue;
+        }
+        fclose(f);
+        remove(fname);
+        for (k=0;k<3;k++)
+        {
+            io_set_fmt(fmt[k]);
+            sprintf(fname,"ex_zip.%s%s",fmt_ext[k],ext[e]);
+            sprintf(path,"%s:m",fname);
+            mat_save(path,'w',m);
+            sprintf(path,"%s:s",fname);
+            rs_sample_save(path,'a',s);
+            io_finish();
+            io_init();
+            io_set_fmt(fmt[k]);
+            sprintf(path,"%s:m",fname);
+            ndiff  = (mat_load(m_ld,NULL,path) == LATAN_SUCCESS) ? \
+                     mat_ndiff(m,m_ld,0.0) : nel(m);
+            sprintf(path,"%s:s",fname);
+            if (rs_sample_load(s_ld,&nsample,dim,path) == LATAN_SUCCESS)
+            {
+                ndiff += (nsample != NSAMPLE)+(dim[0] != NROW)+\
+                         (dim[1] != NCOL);
+                ndiff += rs_sample_ndiff(s,s_ld,0.0);
+            }
+            else
+            {
+                ndiff += 1;
+            }
+            printf("%-4s %-5s: %s\n",ext[e],fmt_name[k],\
+                   (ndiff == 0) ? "ok" : "FAILED");
+            nfail += (ndiff != 0);
+            remove(fname);
+        }
+    }
+    io_finish();
+
+    mat_destroy(m);
+    mat_destroy(m_ld);
+    rs_sample_destroy(s);
+    rs_sample_destroy(s_ld);
+
+    return (nfail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
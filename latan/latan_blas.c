@@ -149,7 +149,7 @@ double latan_blas_dnrm2(const mat *x)
         LATAN_ERROR_VAL("vector operation on matrix",LATAN_EBADLEN,GSL_NAN);
     }
     
-    return (latan_errno)gsl_blas_dnrm2(&(x_vview.vector));
+    return gsl_blas_dnrm2(&(x_vview.vector));
 }
 
 /*                              level 2                                     */
@@ -161,10 +161,14 @@ latan_errno latan_blas_dgemv(const char opA, const double alpha,            \
     latan_errno status;
     gsl_vector_view x_vview,y_vview;
     CBLAS_TRANSPOSE_t opA_no;
+    size_t op_nrow,op_ncol;
 
     status = LATAN_SUCCESS;
     opA_no = CblasNoTrans;
 
+    USTAT(parse_op(&opA_no,opA));
+    op_nrow = (opA_no == CblasNoTrans) ? nrow(A) : ncol(A);
+    op_ncol = (opA_no == CblasNoTrans) ? ncol(A) : nrow(A);
     if (mat_is_row_vector(x))
     {
         x_vview = gsl_matrix_row(x->data_cpu,0);
@@ -189,17 +193,11 @@ latan_errno latan_blas_dgemv(const char opA, const double alpha,            \
     {
         LATAN_ERROR("vector operation on matrix",LATAN_EBADLEN);
     }
-    if (x_vview.vector.size != y_vview.vector.size)
-    {
-        LATAN_ERROR("operation between vectors with dimension mismatch",\
-                    LATAN_EBADLEN);
-    }
-    if (ncol(A) != x_vview.vector.size)
+    if ((op_ncol != x_vview.vector.size)||(op_nrow != y_vview.vector.size))
     {
         LATAN_ERROR("operation between matrix and vector with dimension mismatch",\
                     LATAN_EBADLEN);
     }
-    USTAT(parse_op(&opA_no,opA));
     USTAT(gsl_blas_dgemv(opA_no,alpha,A->data_cpu,&(x_vview.vector),beta,\
                          &(y_vview.vector)));
 
@@ -333,4 +331,32 @@ latan_errno latan_blas_dsymm(const char side, const char uploA,             \
     return status;
 }
 
-
+latan_errno latan_blas_dsyrk(const char uploC, const char opA,              \
+                             const double alpha, const mat *A,              \
+                             const double beta, mat *C)
+{
+    latan_errno status;
+    CBLAS_UPLO_t uploC_no;
+    CBLAS_TRANSPOSE_t opA_no;
+    size_t nropA;
+    
+    status   = LATAN_SUCCESS;
+    uploC_no = CblasUpper;
+    opA_no   = CblasNoTrans;
+    
+    USTAT(parse_uplo(&uploC_no,uploC));
+    USTAT(parse_op(&opA_no,opA));
+    nropA = (opA_no == CblasNoTrans) ? nrow(A) : ncol(A);
+    if (!mat_is_square(C))
+    {
+        LATAN_ERROR("symmetric matrix is not square",LATAN_ENOTSQR);
+    }
+    if (nrow(C) != nropA)
+    {
+        LATAN_ERROR("operation between matrices with dimension mismatch",\
+                    LATAN_EBADLEN);
+    }
+    USTAT(gsl_blas_dsyrk(uploC_no,opA_no,alpha,A->data_cpu,beta,C->data_cpu));
+    
+    return status;
+}
@@ -42,5 +42,8 @@ latan_errno latan_blas_dgemm(const char opA, const char opB,                \
 latan_errno latan_blas_dsymm(const char side, const char uploA,             \
                              const double alpha, const mat *A, const mat *B,\
                              const double beta, mat *C);
+latan_errno latan_blas_dsyrk(const char uploC, const char opA,              \
+                             const double alpha, const mat *A,              \
+                             const double beta, mat *C);
 
 #endif
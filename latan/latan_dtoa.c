@@ -0,0 +1,440 @@
+/* latan_dtoa.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <latan/latan_dtoa.h>
+#include <latan/latan_includes.h>
+
+/* the digits are generated with the Grisu2 algorithm (F. Loitsch, "Printing
+ * floating-point numbers quickly and accurately with integers", PLDI 2010) :
+ * the boundaries of the rounding interval of x are scaled by a cached power
+ * of 10 into 64 bits fixed point numbers and the digits are produced with
+ * integer operations only, the result is always inside the rounding interval
+ * (so it is read back exactly) and is the shortest one in most of the
+ * cases ; as in Grisu3, the digits are also generated for the interval
+ * widened by the rounding errors and, when they are shorter, they are kept if
+ * strtod reads them back exactly (e.g. 1e23, which is exactly on a boundary
+ * of its rounding interval) */
+
+/*                              internal code                               */
+/****************************************************************************/
+typedef unsigned long long dtoa_u64;
+
+#define DP_SIGNIF_SIZE 52
+#define DP_EXP_BIAS    (0x3FF + DP_SIGNIF_SIZE)
+#define DP_MIN_EXP     (-DP_EXP_BIAS)
+#define DP_EXP_MASK    0x7FF0000000000000ULL
+#define DP_SIGNIF_MASK 0x000FFFFFFFFFFFFFULL
+#define DP_HIDDEN_BIT  0x0010000000000000ULL
+#define DP_SIGN_MASK   0x8000000000000000ULL
+
+typedef struct
+{
+    dtoa_u64 f;
+    int e;
+} diy_fp;
+
+/* normalized 64 bits significands and binary exponents of 10^k for
+ * k = -348,-340,...,340 */
+static const dtoa_u64 dtoa_cached_f[] =
+{
+    0xfa8fd5a0081c0288ULL,0xbaaee17fa23ebf76ULL,0x8b16fb203055ac76ULL,\
+    0xcf42894a5dce35eaULL,0x9a6bb0aa55653b2dULL,0xe61acf033d1a45dfULL,\
+    0xab70fe17c79ac6caULL,0xff77b1fcbebcdc4fULL,0xbe5691ef416bd60cULL,\
+    0x8dd01fad907ffc3cULL,0xd3515c2831559a83ULL,0x9d71ac8fada6c9b5ULL,\
+    0xea9c227723ee8bcbULL,0xaecc49914078536dULL,0x823c12795db6ce57ULL,\
+    0xc21094364dfb5637ULL,0x9096ea6f3848984fULL,0xd77485cb25823ac7ULL,\
+    0xa086cfcd97bf97f4ULL,0xef340a98172aace5ULL,0xb23867fb2a35b28eULL,\
+    0x84c8d4dfd2c63f3bULL,0xc5dd44271ad3cdbaULL,0x936b9fcebb25c996ULL,\
+    0xdbac6c247d62a584ULL,0xa3ab66580d5fdaf6ULL,0xf3e2f893dec3f126ULL,\
+    0xb5b5ada8aaff80b8ULL,0x87625f056c7c4a8bULL,0xc9bcff6034c13053ULL,\
+    0x964e858c91ba2655ULL,0xdff9772470297ebdULL,0xa6dfbd9fb8e5b88fULL,\
+    0xf8a95fcf88747d94ULL,0xb94470938fa89bcfULL,0x8a08f0f8bf0f156bULL,\
+    0xcdb02555653131b6ULL,0x993fe2c6d07b7facULL,0xe45c10c42a2b3b06ULL,\
+    0xaa242499697392d3ULL,0xfd87b5f28300ca0eULL,0xbce5086492111aebULL,\
+    0x8cbccc096f5088ccULL,0xd1b71758e219652cULL,0x9c40000000000000ULL,\
+    0xe8d4a51000000000ULL,0xad78ebc5ac620000ULL,0x813f3978f8940984ULL,\
+    0xc097ce7bc90715b3ULL,0x8f7e32ce7bea5c70ULL,0xd5d238a4abe98068ULL,\
+    0x9f4f2726179a2245ULL,0xed63a231d4c4fb27ULL,0xb0de65388cc8ada8ULL,\
+    0x83c7088e1aab65dbULL,0xc45d1df942711d9aULL,0x924d692ca61be758ULL,\
+    0xda01ee641a708deaULL,0xa26da3999aef774aULL,0xf209787bb47d6b85ULL,\
+    0xb454e4a179dd1877ULL,0x865b86925b9bc5c2ULL,0xc83553c5c8965d3dULL,\
+    0x952ab45cfa97a0b3ULL,0xde469fbd99a05fe3ULL,0xa59bc234db398c25ULL,\
+    0xf6c69a72a3989f5cULL,0xb7dcbf5354e9beceULL,0x88fcf317f22241e2ULL,\
+    0xcc20ce9bd35c78a5ULL,0x98165af37b2153dfULL,0xe2a0b5dc971f303aULL,\
+    0xa8d9d1535ce3b396ULL,0xfb9b7cd9a4a7443cULL,0xbb764c4ca7a44410ULL,\
+    0x8bab8eefb6409c1aULL,0xd01fef10a657842cULL,0x9b10a4e5e9913129ULL,\
+    0xe7109bfba19c0c9dULL,0xac2820d9623bf429ULL,0x80444b5e7aa7cf85ULL,\
+    0xbf21e44003acdd2dULL,0x8e679c2f5e44ff8fULL,0xd433179d9c8cb841ULL,\
+    0x9e19db92b4e31ba9ULL,0xeb96bf6ebadf77d9ULL,0xaf87023b9bf0ee6bULL
+};
+
+static const int dtoa_cached_e[] =
+{
+    -1220,-1193,-1166,-1140,-1113,-1087,-1060,-1034,-1007, -980,\
+     -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,\
+     -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,\
+     -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,\
+     -157, -130, -103,  -77,  -50,  -24,    3,   30,   56,   83,\
+      109,  136,  162,  189,  216,  242,  269,  295,  322,  348,\
+      375,  402,  428,  455,  481,  508,  534,  561,  588,  614,\
+      641,  667,  694,  720,  747,  774,  800,  827,  853,  880,\
+      907,  933,  960,  986, 1013, 1039, 1066
+};
+
+#define DTOA_NPOW10 20
+
+static const dtoa_u64 dtoa_pow10[DTOA_NPOW10] =
+{
+    1ULL,10ULL,100ULL,1000ULL,10000ULL,100000ULL,1000000ULL,10000000ULL,\
+    100000000ULL,1000000000ULL,10000000000ULL,100000000000ULL,           \
+    1000000000000ULL,10000000000000ULL,100000000000000ULL,               \
+    1000000000000000ULL,10000000000000000ULL,100000000000000000ULL,      \
+    1000000000000000000ULL,10000000000000000000ULL
+};
+
+static diy_fp diy_fp_normalize(diy_fp x);
+static diy_fp diy_fp_mul(const diy_fp x, const diy_fp y);
+static void dtoa_boundaries(diy_fp *m, diy_fp *p, const diy_fp x);
+static diy_fp dtoa_cached_pow(int *k, const int e);
+static int dtoa_ndigit(const unsigned int n);
+static void dtoa_round(char *digit, const int len, const dtoa_u64 delta,\
+                       dtoa_u64 rest, const dtoa_u64 ten_kappa,           \
+                       const dtoa_u64 wp_w);
+static int dtoa_grisu2(char *digit, int *k, const dtoa_u64 u,\
+                       const bool unsafe);
+static size_t dtoa_write_exp(char *buf, const int e);
+static size_t dtoa_write(char *buf, const char *digit, const int len,\
+                         const int k);
+
+static diy_fp diy_fp_normalize(diy_fp x)
+{
+    while (!(x.f & DP_SIGN_MASK))
+    {
+        x.f <<= 1;
+        x.e--;
+    }
+
+    return x;
+}
+
+static diy_fp diy_fp_mul(const diy_fp x, const diy_fp y)
+{
+    const dtoa_u64 m32 = 0xFFFFFFFFULL;
+    dtoa_u64 a,b,c,d,ac,bc,ad,bd,tmp;
+    diy_fp res;
+
+    a   = x.f >> 32;
+    b   = x.f & m32;
+    c   = y.f >> 32;
+    d   = y.f & m32;
+    ac  = a*c;
+    bc  = b*c;
+    ad  = a*d;
+    bd  = b*d;
+    tmp = (bd >> 32) + (ad & m32) + (bc & m32);
+    tmp += 1ULL << 31;
+    res.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+    res.e = x.e + y.e + 64;
+
+    return res;
+}
+
+/* normalized boundaries of the rounding interval of x, with the same
+ * exponent */
+static void dtoa_boundaries(diy_fp *m, diy_fp *p, const diy_fp x)
+{
+    p->f = (x.f << 1) + 1;
+    p->e = x.e - 1;
+    while (!(p->f & (DP_HIDDEN_BIT << 1)))
+    {
+        p->f <<= 1;
+        p->e--;
+    }
+    p->f <<= 64 - DP_SIGNIF_SIZE - 2;
+    p->e -= 64 - DP_SIGNIF_SIZE - 2;
+    if (x.f == DP_HIDDEN_BIT)
+    {
+        m->f = (x.f << 2) - 1;
+        m->e = x.e - 2;
+    }
+    else
+    {
+        m->f = (x.f << 1) - 1;
+        m->e = x.e - 1;
+    }
+    m->f <<= m->e - p->e;
+    m->e = p->e;
+}
+
+/* cached power c = 10^(-k) such that the exponent of a normalized number
+ * with binary exponent e multiplied by c is in [-60,-32] */
+static diy_fp dtoa_cached_pow(int *k, const int e)
+{
+    double dk;
+    int ik,ind;
+    diy_fp c;
+
+    dk  = (double)(-61 - e)*0.30102999566398114 + 347.0;
+    ik  = (int)dk;
+    if (dk - (double)ik > 0.0)
+    {
+        ik++;
+    }
+    ind = (ik >> 3) + 1;
+    *k  = -(-348 + ind*8);
+    c.f = dtoa_cached_f[ind];
+    c.e = dtoa_cached_e[ind];
+
+    return c;
+}
+
+static int dtoa_ndigit(const unsigned int n)
+{
+    int nd;
+
+    for (nd=1;(nd < 10)&&(n >= dtoa_pow10[nd]);nd++)
+    {
+    }
+
+    return nd;
+}
+
+/* move the last digit toward the scaled value of x as long as the result
+ * stays in the rounding interval */
+static void dtoa_round(char *digit, const int len, const dtoa_u64 delta,\
+                       dtoa_u64 rest, const dtoa_u64 ten_kappa,           \
+                       const dtoa_u64 wp_w)
+{
+    while ((rest < wp_w)&&(delta - rest >= ten_kappa)      \
+           &&((rest + ten_kappa < wp_w)                     \
+              ||(wp_w - rest > rest + ten_kappa - wp_w)))
+    {
+        digit[len-1]--;
+        rest += ten_kappa;
+    }
+}
+
+/* digits of the positive finite non-zero number of bit pattern u, the number
+ * is digit*10^k, the number of digits is returned ; if unsafe is true the
+ * rounding interval is widened instead of narrowed by the rounding errors of
+ * the scaling, so the result may not be read back exactly */
+static int dtoa_grisu2(char *digit, int *k, const dtoa_u64 u,\
+                       const bool unsafe)
+{
+    diy_fp v,w,w_m,w_p,c,one;
+    dtoa_u64 delta,wp_w,p2,tmp;
+    unsigned int p1,d;
+    int bexp,kappa,len;
+
+    bexp = (int)((u & DP_EXP_MASK) >> DP_SIGNIF_SIZE);
+    if (bexp != 0)
+    {
+        v.f = (u & DP_SIGNIF_MASK) + DP_HIDDEN_BIT;
+        v.e = bexp - DP_EXP_BIAS;
+    }
+    else
+    {
+        v.f = u & DP_SIGNIF_MASK;
+        v.e = DP_MIN_EXP + 1;
+    }
+    dtoa_boundaries(&w_m,&w_p,v);
+    c      = dtoa_cached_pow(k,w_p.e);
+    w      = diy_fp_mul(diy_fp_normalize(v),c);
+    w_p    = diy_fp_mul(w_p,c);
+    w_m    = diy_fp_mul(w_m,c);
+    if (unsafe)
+    {
+        w_m.f--;
+        w_p.f++;
+    }
+    else
+    {
+        w_m.f++;
+        w_p.f--;
+    }
+    delta  = w_p.f - w_m.f;
+    wp_w   = w_p.f - w.f;
+    one.e  = w_p.e;
+    one.f  = 1ULL << (-one.e);
+    p1     = (unsigned int)(w_p.f >> (-one.e));
+    p2     = w_p.f & (one.f - 1);
+    kappa  = dtoa_ndigit(p1);
+    len    = 0;
+    while (kappa > 0)
+    {
+        d  = p1/(unsigned int)dtoa_pow10[kappa-1];
+        p1 = p1%(unsigned int)dtoa_pow10[kappa-1];
+        if ((d != 0)||(len > 0))
+        {
+            digit[len++] = (char)('0' + d);
+        }
+        kappa--;
+        tmp = ((dtoa_u64)p1 << (-one.e)) + p2;
+        if (tmp <= delta)
+        {
+            *k += kappa;
+            dtoa_round(digit,len,delta,tmp,dtoa_pow10[kappa] << (-one.e),\
+                       wp_w);
+
+            return len;
+        }
+    }
+    while (true)
+    {
+        p2    *= 10;
+        delta *= 10;
+        d      = (unsigned int)(p2 >> (-one.e));
+        if ((d != 0)||(len > 0))
+        {
+            digit[len++] = (char)('0' + d);
+        }
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *k += kappa;
+            dtoa_round(digit,len,delta,p2,one.f,                     \
+                       (-kappa < DTOA_NPOW10) ? wp_w*dtoa_pow10[-kappa] : 0);
+
+            return len;
+        }
+    }
+}
+
+static size_t dtoa_write_exp(char *buf, const int e)
+{
+    size_t n;
+    int ae;
+
+    n        = 0;
+    ae       = (e < 0) ? -e : e;
+    buf[n++] = 'e';
+    buf[n++] = (e < 0) ? '-' : '+';
+    if (ae >= 100)
+    {
+        buf[n++] = (char)('0' + ae/100);
+        ae       = ae%100;
+    }
+    buf[n++] = (char)('0' + ae/10);
+    buf[n++] = (char)('0' + ae%10);
+    buf[n]   = '\0';
+
+    return n;
+}
+
+/* fixed notation is used when there are at most 16 digits before the decimal
+ * point or at most 2 zeros between the decimal point and the first digit,
+ * scientific notation is used otherwise */
+static size_t dtoa_write(char *buf, const char *digit, const int len,\
+                         const int k)
+{
+    size_t n;
+    int i,pt;
+
+    n  = 0;
+    pt = len + k;
+    if ((pt > 0)&&(pt <= 16))
+    {
+        for (i=0;i<len;i++)
+        {
+            if (i == pt)
+            {
+                buf[n++] = '.';
+            }
+            buf[n++] = digit[i];
+        }
+        for (i=len;i<pt;i++)
+        {
+            buf[n++] = '0';
+        }
+    }
+    else if ((pt <= 0)&&(pt > -3))
+    {
+        buf[n++] = '0';
+        buf[n++] = '.';
+        for (i=pt;i<0;i++)
+        {
+            buf[n++] = '0';
+        }
+        for (i=0;i<len;i++)
+        {
+            buf[n++] = digit[i];
+        }
+    }
+    else
+    {
+        buf[n++] = digit[0];
+        if (len > 1)
+        {
+            buf[n++] = '.';
+            for (i=1;i<len;i++)
+            {
+                buf[n++] = digit[i];
+            }
+        }
+
+        return n + dtoa_write_exp(buf+n,pt-1);
+    }
+    buf[n] = '\0';
+
+    return n;
+}
+
+/*                        double to string conversion                       */
+/****************************************************************************/
+size_t latan_dtoa(char *buf, const double x)
+{
+    dtoa_u64 u;
+    char digit[20],digit_u[20];
+    size_t n;
+    int k,k_u,len,len_u;
+
+    memcpy(&u,&x,sizeof(double));
+    n = 0;
+    if ((u & DP_EXP_MASK) == DP_EXP_MASK)
+    {
+        strcpy(buf,((u & DP_SIGNIF_MASK) != 0) ? "nan" :\
+               ((u & DP_SIGN_MASK) ? "-inf" : "inf"));
+
+        return strlen(buf);
+    }
+    if (u & DP_SIGN_MASK)
+    {
+        buf[n++] = '-';
+    }
+    if ((u & ~DP_SIGN_MASK) == 0)
+    {
+        buf[n++] = '0';
+        buf[n]   = '\0';
+
+        return n;
+    }
+    len   = dtoa_grisu2(digit,&k,u & ~DP_SIGN_MASK,false);
+    len_u = dtoa_grisu2(digit_u,&k_u,u & ~DP_SIGN_MASK,true);
+    if (len_u < len)
+    {
+        dtoa_write(buf+n,digit_u,len_u,k_u);
+        if (strtod(buf,NULL) == x)
+        {
+            return strlen(buf);
+        }
+    }
+
+    return n + dtoa_write(buf+n,digit,len,k);
+}
@@ -0,0 +1,36 @@
+/* latan_dtoa.h, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef LATAN_DTOA_H_
+#define	LATAN_DTOA_H_
+
+#include <latan/latan_globals.h>
+
+/* size of a buffer large enough for any number written by latan_dtoa */
+#define LATAN_DTOA_SIZE 32
+
+__BEGIN_DECLS
+
+/* write in buf a short decimal representation of x which is converted back
+ * exactly to x by strtod, and return its length */
+size_t latan_dtoa(char *buf, const double x);
+
+__END_DECLS
+
+#endif
@@ -23,6 +23,9 @@
 #include <latan/latan_io.h>
 #include <latan/latan_math.h>
 #include <latan/latan_minimizer.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_cblas.h>
+#include <gsl/gsl_eigen.h>
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_math.h>
 #include <gsl/gsl_vector.h>
@@ -38,10 +41,34 @@ static size_t get_Ysize(const fit_data *d);
 static void set_var_subm(mat *var, const mat *subm, const size_t k1,\
                          const size_t k2, const fit_data *d);
 static void pseudoinvert_var(mat *var, const bool is_corr);
+static latan_errno chol_var(double **l_pk, const mat *var);
+static void whiten_var_inv(mat **w, const double *l_pk, const mat *var_inv);
+static double chol_quad(const double *l_pk, const mat *v, mat *buf);
+static void chol_solve(const double *l_pk, gsl_vector *v, const bool trans);
+static void whiten(mat *r, const double *l_pk, const mat *w, const mat *v);
+static void get_buf_ind(int *thread, int *nthread, const fit_data *d);
+static bool is_chi2_ready(const fit_data *d, const int thread);
 static void init_chi2(fit_data *d, const int thread, const int nthread);
-static void set_X_Y(mat* X, mat *Y, mat *x_buf, const mat *p, \
+static void init_chi2_res(fit_data *d);
+static void set_X_Y(mat* X, mat *Y, mat *x_buf, mat *f_buf, const mat *p,\
                     const fit_data *d);
 static double chi2_base(const mat *p, void *vd);
+static latan_errno set_sample(fit_data *d, mat *pbuf, const mat *pinit,\
+                              rs_sample * const *x,                     \
+                              rs_sample * const *data,                  \
+                              const bool *use_x_var, const size_t s);
+static void print_progress(const fit_data *d, const size_t s,\
+                           const size_t nsample);
+
+typedef struct
+{
+    bool par_rs_fit;
+} fit_env;
+
+static fit_env env =
+{
+    false
+};
 
 /*                          fit model structure                             */
 /****************************************************************************/
@@ -88,6 +115,48 @@ double fit_model_eval(const fit_model *model, const size_t k, const mat *x,\
     return res;
 }
 
+bool fit_model_have_grad(const fit_model *model)
+{
+    size_t k;
+    
+    for (k=0;k<model->nydim;k++)
+    {
+        if (model->dfunc[k] == NULL)
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void fit_model_eval_grad(mat *df, const fit_model *model, const size_t k,\
+                         const mat *x, const mat *p, void *model_param)
+{
+    model->dfunc[k](df,x,p,model_param);
+}
+
+bool fit_model_have_batch(const fit_model *model)
+{
+    size_t k;
+    
+    for (k=0;k<model->nydim;k++)
+    {
+        if (model->batch[k] == NULL)
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void fit_model_eval_batch(mat *res, const fit_model *model, const size_t k,\
+                          const mat *x, const mat *p, void *model_param)
+{
+    model->batch[k](res,x,p,model_param);
+}
+
 /*                          fit data structure                              */
 /****************************************************************************/
 static size_t rowmaj(const size_t i, const size_t j, const size_t dim1,\
@@ -151,8 +220,14 @@ fit_data *fit_data_create(const size_t ndata, const size_t nxdim,\
     d->model_param     = NULL;
     d->npar            = 0;
     d->ndpar           = 0;
-    d->x_var_inv       = NULL;
-    d->y_var_inv       = NULL;
+    d->x_var       = NULL;
+    d->y_var       = NULL;
+    d->x_var_wht       = NULL;
+    d->y_var_wht       = NULL;
+    d->var_wht         = NULL;
+    d->x_var_chol      = NULL;
+    d->y_var_chol      = NULL;
+    d->var_chol        = NULL;
     d->is_x_correlated = false;
     for (k=0;k<nxdim;k++)
     {
@@ -167,8 +242,9 @@ fit_data *fit_data_create(const size_t ndata, const size_t nxdim,\
     {
         d->have_xy_covar[k] = false;
     }
-    d->var_inv       = NULL;
+    d->var       = NULL;
     d->is_inverted   = false;
+    d->is_whitened   = false;
     d->chi2_ext      = &zero;
     d->chi2_val      = latan_nan();
     d->chi2_comp     = NULL;
@@ -178,6 +254,7 @@ fit_data *fit_data_create(const size_t ndata, const size_t nxdim,\
     d->s             = 0;
     d->matperf       = latan_nan();
     d->callps        = latan_nan();
+    d->is_clone      = false;
     for (k1=0;k1<nxdim;k1++)
     {
         for (k2=k1;k2<nxdim;k2++)
@@ -217,6 +294,30 @@ fit_data *fit_data_create(const size_t ndata, const size_t nxdim,\
     return d;
 }
 
+fit_data *fit_data_create_clone(fit_data *d)
+{
+    fit_data *c;
+    
+    /* the whitening factors are shared, they are computed now so that a
+     * clone never allocates them */
+    if (d->is_inverted)
+    {
+        init_chi2_res(d);
+    }
+    MALLOC_ERRVAL(c,fit_data *,1,NULL);
+    *c = *d;
+    c->x         = mat_create_from_mat(d->x);
+    c->y         = mat_create_from_mat(d->y);
+    c->chi2_comp = (d->chi2_comp != NULL) ? mat_create_from_mat(d->chi2_comp)\
+                                          : NULL;
+    c->buf       = NULL;
+    c->nbuf      = 0;
+    c->is_clone  = true;
+    init_chi2(c,0,1);
+    
+    return c;
+}
+
 void fit_data_destroy(fit_data *d)
 {
     int i;
@@ -224,25 +325,7 @@ void fit_data_destroy(fit_data *d)
     if (d)
     {
         mat_destroy(d->x);
-        mat_ar_destroy(d->x_covar,d->nxdim*(d->nxdim+1)/2);
-        FREE(d->have_x_covar);
-        FREE(d->have_xy_covar);
         mat_destroy(d->y);
-        mat_ar_destroy(d->y_covar,d->nydim*(d->nydim+1)/2);
-        mat_ar_destroy(d->xy_covar,d->nydim*d->nxdim);
-        mat_destroy(d->cor_filter);
-        if (d->x_var_inv != NULL)
-        {
-            mat_destroy(d->x_var_inv);
-        }
-        if (d->y_var_inv != NULL)
-        {
-            mat_destroy(d->y_var_inv);
-        }
-        if (d->var_inv != NULL)
-        {
-            mat_destroy(d->var_inv);
-        }
         if (d->chi2_comp != NULL)
         {
             mat_destroy(d->chi2_comp);
@@ -250,8 +333,11 @@ void fit_data_destroy(fit_data *d)
         for(i=0;i<d->nbuf;i++)
         {
             mat_destroy(d->buf[i].x_f);
+            mat_destroy(d->buf[i].f);
             mat_destroy(d->buf[i].Y);
             mat_destroy(d->buf[i].CyY);
+            mat_destroy(d->buf[i].df);
+            mat_destroy(d->buf[i].J);
             if (d->buf[i].is_xpart_alloc)
             {
                 mat_destroy(d->buf[i].X);
@@ -261,7 +347,34 @@ void fit_data_destroy(fit_data *d)
             }
         }
         FREE(d->buf);
-        FREE(d->to_fit);
+        if (!d->is_clone)
+        {
+            mat_ar_destroy(d->x_covar,d->nxdim*(d->nxdim+1)/2);
+            FREE(d->have_x_covar);
+            FREE(d->have_xy_covar);
+            mat_ar_destroy(d->y_covar,d->nydim*(d->nydim+1)/2);
+            mat_ar_destroy(d->xy_covar,d->nydim*d->nxdim);
+            mat_destroy(d->cor_filter);
+            if (d->x_var != NULL)
+            {
+                mat_destroy(d->x_var);
+            }
+            if (d->y_var != NULL)
+            {
+                mat_destroy(d->y_var);
+            }
+            if (d->var != NULL)
+            {
+                mat_destroy(d->var);
+            }
+            mat_destroy(d->x_var_wht);
+            mat_destroy(d->y_var_wht);
+            mat_destroy(d->var_wht);
+            FREE(d->x_var_chol);
+            FREE(d->y_var_chol);
+            FREE(d->var_chol);
+            FREE(d->to_fit);
+        }
         FREE(d);
     }
 }
@@ -920,7 +1033,7 @@ static void set_var_subm(mat *var, const mat *subm, const size_t k1,\
 {\
     FILE *f_;\
     f_=fopen(fname,"w");\
-    mat_dump(f_,m,"% .15e");\
+    mat_dump(f_,m,NULL);\
     fclose(f_);\
 }
 
@@ -976,6 +1089,82 @@ static void pseudoinvert_var(mat *var, const bool is_corr)
         mat_destroy(sig);
     }
 }
+
+/** Cholesky factorization of a variance matrix **/
+/* packed (row major lower) L with C = L*t(L), if C is not positive definite
+ * l_pk is set to NULL and LATAN_EDOM is returned */
+static latan_errno chol_var(double **l_pk, const mat *var)
+{
+    latan_errno status;
+    mat *L;
+    size_t n;
+    size_t i,j;
+    
+    n      = nrow(var);
+    L      = mat_create(n,n);
+    status = mat_cholesky(L,var);
+    if (status == LATAN_SUCCESS)
+    {
+        REALLOC_NOERRET(*l_pk,*l_pk,double *,n*(n+1)/2);
+        for (i=0;i<n;i++)
+        for (j=0;j<=i;j++)
+        {
+            (*l_pk)[i*(i+1)/2+j] = mat_get(L,i,j);
+        }
+    }
+    else
+    {
+        FREE(*l_pk);
+    }
+    mat_destroy(L);
+    
+    return status;
+}
+
+/** whitening factor of a pseudo-inverse variance matrix **/
+/* only needed if the variance matrix C is not positive definite (l_pk is
+ * NULL), W is then V*sqrt(S) from the eigendecomposition of C^+ which can be
+ * singular because of the singular value cut in pseudoinvert_var, else the
+ * Cholesky factor of C is used and W is destroyed */
+static void whiten_var_inv(mat **w, const double *l_pk, const mat *var_inv)
+{
+    mat *V;
+    gsl_vector_view V_j;
+    gsl_vector *S;
+    gsl_eigen_symmv_workspace *works;
+    size_t n;
+    size_t j;
+    double s_j;
+    
+    if (l_pk != NULL)
+    {
+        mat_destroy(*w);
+        *w = NULL;
+        return;
+    }
+    n = nrow(var_inv);
+    if ((*w == NULL)||(nrow(*w) != n))
+    {
+        mat_destroy(*w);
+        *w = mat_create(n,n);
+    }
+    V     = mat_create(n,n);
+    S     = gsl_vector_alloc(n);
+    works = gsl_eigen_symmv_alloc(n);
+    mat_cp(*w,var_inv);
+    gsl_eigen_symmv((*w)->data_cpu,S,V->data_cpu,works);
+    for (j=0;j<n;j++)
+    {
+        s_j = gsl_vector_get(S,j);
+        V_j = gsl_matrix_column(V->data_cpu,j);
+        gsl_vector_scale(&(V_j.vector),(s_j > 0.0) ? sqrt(s_j) : 0.0);
+    }
+    mat_cp(*w,V);
+    mat_reset_assump(*w);
+    gsl_eigen_symmv_free(works);
+    gsl_vector_free(S);
+    mat_destroy(V);
+}
     
 /* chi^2 function :
  * ----------------
@@ -1017,7 +1206,58 @@ static void pseudoinvert_var(mat *var, const bool is_corr)
  * 
  */
 
-/* (re)allocate chi2 buffers and compute C^-1 */
+/* index of the chi2 buffer used by the calling thread, a clone is only
+ * used by one thread and has a single buffer */
+static void get_buf_ind(int *thread, int *nthread, const fit_data *d __dumb)
+{
+#ifdef _OPENMP
+    if (!d->is_clone)
+    {
+        *nthread = omp_get_num_threads();
+        *thread  = omp_get_thread_num();
+        return;
+    }
+#endif
+    *nthread = 1;
+    *thread  = 0;
+}
+
+/* are the thread buffers and C ready to compute chi2 ? */
+static bool is_chi2_ready(const fit_data *d, const int thread)
+{
+    const chi2_buf *b;
+    size_t Ysize,Xsize,lXsize;
+    
+    if ((!d->is_inverted)||(thread >= d->nbuf)||(d->chi2_comp == NULL))
+    {
+        return false;
+    }
+    b      = d->buf + thread;
+    Ysize  = get_Ysize(d);
+    Xsize  = get_Xsize(d);
+    lXsize = Ysize + Xsize;
+    if ((nrow(b->Y) != Ysize)||(nrow(b->CyY) != Ysize)\
+        ||(nrow(d->chi2_comp) != lXsize+2))
+    {
+        return false;
+    }
+    if ((Xsize > 0)&&((!b->is_xpart_alloc)||(nrow(b->X) != Xsize)\
+                      ||(nrow(b->lX) != lXsize)))
+    {
+        return false;
+    }
+    if (fit_data_have_xy_covar(d)&&((d->var == NULL)\
+                                    ||(nrow(d->var) != lXsize)))
+    {
+        return false;
+    }
+    
+    return true;
+}
+
+/* (re)allocate chi2 buffers and factorize or pseudo-invert C, the check is
+ * done a first time without lock so that concurrent chi2 calls only
+ * serialize when something has to be (re)computed */
 static void init_chi2(fit_data *d, const int thread, const int nthread)
 {
     mat *tmp_covar;
@@ -1026,8 +1266,15 @@ static void init_chi2(fit_data *d, const int thread, const int nthread)
     size_t ind,ndata,nydim,nxdim,lXsize,Ysize,Xsize,px_ind,px_ind1,px_ind2;
     bool have_xy_covar;
     
+    if (is_chi2_ready(d,thread))
+    {
 #ifdef _OPENMP
-#pragma omp critical
+#pragma omp flush
+#endif
+        return;
+    }
+#ifdef _OPENMP
+#pragma omp critical(latan_fit_init_chi2)
 #endif
     {
         tmp_covar      = NULL;
@@ -1046,8 +1293,11 @@ static void init_chi2(fit_data *d, const int thread, const int nthread)
             for (t=d->nbuf;t<nthread;t++)
             {
                 d->buf[t].x_f = mat_create(nxdim,1);
+                d->buf[t].f   = mat_create(ndata,1);
                 d->buf[t].Y   = mat_create(Ysize,1);
                 d->buf[t].CyY = mat_create(Ysize,1);
+                d->buf[t].df  = NULL;
+                d->buf[t].J   = NULL;
                 if (Xsize > 0)
                 {
                     d->buf[t].X              = mat_create(Xsize,1);
@@ -1102,22 +1352,22 @@ static void init_chi2(fit_data *d, const int thread, const int nthread)
             }
         }
         
-        /* (re)allocating global inverse variance matrix if necessary */
+        /* (re)allocating global variance matrix if necessary */
         if (have_xy_covar)
         {
-            if (d->var_inv == NULL)
+            if (d->var == NULL)
             {
-                d->var_inv = mat_create(lXsize,lXsize);
-                mat_assume(d->var_inv,(mat_flag)(MAT_SYM|MAT_POS));
-                mat_zero(d->var_inv);
+                d->var = mat_create(lXsize,lXsize);
+                mat_assume(d->var,(mat_flag)(MAT_SYM|MAT_POS));
+                mat_zero(d->var);
                 d->is_inverted = false;
             }
-            else if (nrow(d->var_inv) != lXsize)
+            else if (nrow(d->var) != lXsize)
             {
-                mat_destroy(d->var_inv);
-                d->var_inv = mat_create(lXsize,lXsize);
-                mat_assume(d->var_inv,(mat_flag)(MAT_SYM|MAT_POS));
-                mat_zero(d->var_inv);
+                mat_destroy(d->var);
+                d->var = mat_create(lXsize,lXsize);
+                mat_assume(d->var,(mat_flag)(MAT_SYM|MAT_POS));
+                mat_zero(d->var);
                 d->is_inverted = false;
             }
         }
@@ -1139,64 +1389,67 @@ static void init_chi2(fit_data *d, const int thread, const int nthread)
             tmp_covar = mat_create(ndata,ndata);
             
             /** inverting data variance matrix **/
-            /*** (re)allocating y inverse variance matrix if necessary ***/
-            if (d->y_var_inv == NULL)
+            /*** (re)allocating y variance matrix if necessary ***/
+            if (d->y_var == NULL)
             {
-                d->y_var_inv = mat_create(Ysize,Ysize);
-                mat_assume(d->y_var_inv,(mat_flag)(MAT_SYM|MAT_POS));
+                d->y_var = mat_create(Ysize,Ysize);
+                mat_assume(d->y_var,(mat_flag)(MAT_SYM|MAT_POS));
             }
-            else if (nrow(d->y_var_inv) != Ysize)
+            else if (nrow(d->y_var) != Ysize)
             {
-                mat_destroy(d->y_var_inv);
-                d->y_var_inv = mat_create(Ysize,Ysize);
-                mat_assume(d->y_var_inv,(mat_flag)(MAT_SYM|MAT_POS));
+                mat_destroy(d->y_var);
+                d->y_var = mat_create(Ysize,Ysize);
+                mat_assume(d->y_var,(mat_flag)(MAT_SYM|MAT_POS));
             }
-            mat_zero(d->y_var_inv);
+            mat_zero(d->y_var);
             /*** building y variance matrix by blocks ***/
             for (k1=0;k1<nydim;k1++)
             for (k2=k1;k2<nydim;k2++)
             {
                 ind = sym_rowmaj(k1,k2,nydim);
                 mat_mulp(tmp_covar,d->y_covar[ind],d->cor_filter);
-                set_var_subm(d->y_var_inv,tmp_covar,k1,k2,d);
+                set_var_subm(d->y_var,tmp_covar,k1,k2,d);
                 if (k1 != k2)
                 {
                     mat_eqtranspose(tmp_covar);
-                    set_var_subm(d->y_var_inv,tmp_covar,k2,k1,d);
+                    set_var_subm(d->y_var,tmp_covar,k2,k1,d);
                 }
             }
             if (have_xy_covar)
             {
-                mat_set_subm(d->var_inv,d->y_var_inv,0,0,Ysize-1,Ysize-1);
+                mat_set_subm(d->var,d->y_var,0,0,Ysize-1,Ysize-1);
             }
             /*** inversion ***/
             latan_printf(DEBUG1,"Cd=\n");
             if (latan_get_verb() >= DEBUG1)
             {
-                mat_print(d->y_var_inv,"% 10e");
+                mat_print(d->y_var,"% 10e");
             }
-            pseudoinvert_var(d->y_var_inv,fit_data_is_y_correlated(d));
-            latan_printf(DEBUG1,"Cd^-1=\n");
-            if (latan_get_verb() >= DEBUG1)
+            if (chol_var(&(d->y_var_chol),d->y_var) != LATAN_SUCCESS)
             {
-                mat_print(d->y_var_inv,"% 10e");
+                pseudoinvert_var(d->y_var,fit_data_is_y_correlated(d));
+                latan_printf(DEBUG1,"Cd^-1=\n");
+                if (latan_get_verb() >= DEBUG1)
+                {
+                    mat_print(d->y_var,"% 10e");
+                }
             }
             /** inverting x variance matrix **/
             if (fit_data_have_x_var(d)||have_xy_covar)
             {
-                /*** (re)allocating x inverse variance matrix if necessary ***/
-                if (d->x_var_inv == NULL)
+                /*** (re)allocating x variance matrix if necessary ***/
+                if (d->x_var == NULL)
                 {
-                    d->x_var_inv = mat_create(Xsize,Xsize);
-                    mat_assume(d->x_var_inv,(mat_flag)(MAT_SYM|MAT_POS));
+                    d->x_var = mat_create(Xsize,Xsize);
+                    mat_assume(d->x_var,(mat_flag)(MAT_SYM|MAT_POS));
                 }
-                else if (nrow(d->x_var_inv) != Xsize)
+                else if (nrow(d->x_var) != Xsize)
                 {
-                    mat_destroy(d->x_var_inv);
-                    d->x_var_inv = mat_create(Xsize,Xsize);
-                    mat_assume(d->x_var_inv,(mat_flag)(MAT_SYM|MAT_POS));
+                    mat_destroy(d->x_var);
+                    d->x_var = mat_create(Xsize,Xsize);
+                    mat_assume(d->x_var,(mat_flag)(MAT_SYM|MAT_POS));
                 }
-                mat_zero(d->x_var_inv);
+                mat_zero(d->x_var);
                 /*** building x variance matrix by blocks ***/
                 px_ind1 = 0;
                 for (k1=0;k1<nxdim;k1++)
@@ -1211,12 +1464,12 @@ static void init_chi2(fit_data *d, const int thread, const int nthread)
                                 ind = sym_rowmaj(k1,k2,nxdim);
                                 mat_mulp(tmp_covar,d->x_covar[ind],\
                                          d->cor_filter);
-                                set_var_subm(d->x_var_inv,tmp_covar,px_ind1,\
+                                set_var_subm(d->x_var,tmp_covar,px_ind1,\
                                              px_ind2,d);
                                 if (k1 != k2)
                                 {
                                     mat_eqtranspose(tmp_covar);
-                                    set_var_subm(d->x_var_inv,tmp_covar,\
+                                    set_var_subm(d->x_var,tmp_covar,\
                                                  px_ind2,px_ind1,d);
                                 }
                                 px_ind2++;
@@ -1228,20 +1481,24 @@ static void init_chi2(fit_data *d, const int thread, const int nthread)
                 }
                 if (have_xy_covar)
                 {
-                    mat_set_subm(d->var_inv,d->x_var_inv,Ysize,Ysize,\
+                    mat_set_subm(d->var,d->x_var,Ysize,Ysize,\
                                  lXsize-1,lXsize-1);
                 }
                 /*** inversion ***/
                 latan_printf(DEBUG1,"Cx=\n");
                 if (latan_get_verb() >= DEBUG1)
                 {
-                    mat_print(d->x_var_inv,"% 10e");
+                    mat_print(d->x_var,"% 10e");
                 }
-                pseudoinvert_var(d->x_var_inv,fit_data_is_x_correlated(d));
-                latan_printf(DEBUG1,"Cx^-1=\n");
-                if (latan_get_verb() >= DEBUG1)
+                if (chol_var(&(d->x_var_chol),d->x_var) != LATAN_SUCCESS)
                 {
-                    mat_print(d->x_var_inv,"% 10e");
+                    pseudoinvert_var(d->x_var,\
+                                     fit_data_is_x_correlated(d));
+                    latan_printf(DEBUG1,"Cx^-1=\n");
+                    if (latan_get_verb() >= DEBUG1)
+                    {
+                        mat_print(d->x_var,"% 10e");
+                    }
                 }
                 
             }
@@ -1257,10 +1514,10 @@ static void init_chi2(fit_data *d, const int thread, const int nthread)
                         if (d->have_xy_covar[k2])
                         {
                             mat_mulp(tmp_covar,d->xy_covar[ind],d->cor_filter);
-                            set_var_subm(d->var_inv,tmp_covar,k1,px_ind+nydim,\
+                            set_var_subm(d->var,tmp_covar,k1,px_ind+nydim,\
                                          d);
                             mat_eqtranspose(tmp_covar);
-                            set_var_subm(d->var_inv,tmp_covar,px_ind+nydim,k1,\
+                            set_var_subm(d->var,tmp_covar,px_ind+nydim,k1,\
                                          d);
                             px_ind++;
                         }
@@ -1269,15 +1526,23 @@ static void init_chi2(fit_data *d, const int thread, const int nthread)
                 latan_printf(DEBUG1,"C=\n");
                 if (latan_get_verb() >= DEBUG1)
                 {
-                    mat_print(d->var_inv,"% 10e");
+                    mat_print(d->var,"% 10e");
                 }
-                pseudoinvert_var(d->var_inv,true);
-                latan_printf(DEBUG1,"C^-1=\n");
-                if (latan_get_verb() >= DEBUG1)
+                if (chol_var(&(d->var_chol),d->var) != LATAN_SUCCESS)
                 {
-                    mat_print(d->var_inv,"% 10e");
+                    pseudoinvert_var(d->var,true);
+                    latan_printf(DEBUG1,"C^-1=\n");
+                    if (latan_get_verb() >= DEBUG1)
+                    {
+                        mat_print(d->var,"% 10e");
+                    }
                 }
             }
+            /** whitening factors are computed by init_chi2_res on demand **/
+            d->is_whitened = false;
+#ifdef _OPENMP
+#pragma omp flush
+#endif
             d->is_inverted = true;
             
             mat_destroy(tmp_covar);
@@ -1286,7 +1551,8 @@ static void init_chi2(fit_data *d, const int thread, const int nthread)
 }
 
 /* set X and Y */
-static void set_X_Y(mat* X, mat *Y, mat *x_buf, const mat *p, const fit_data *d)
+static void set_X_Y(mat* X, mat *Y, mat *x_buf, mat *f_buf, const mat *p,\
+                    const fit_data *d)
 {
     size_t ndata,npt,nxdim,nydim,npar,px_ind;
     size_t i,k,k_i;
@@ -1330,7 +1596,25 @@ static void set_X_Y(mat* X, mat *Y, mat *x_buf, const mat *p, const fit_data *d)
             }
         }
     }
-    /* setting Y in case of no covariance in x */
+    /* setting Y in case of no covariance in x, with one model call per
+     * dimension if the model supports batch evaluation */
+    else if (fit_model_have_batch(d->model))
+    {
+        for (k=0;k<nydim;k++)
+        {
+            fit_model_eval_batch(f_buf,d->model,k,d->x,p,d->model_param);
+            k_i = 0;
+            for (i=0;i<ndata;i++)
+            {
+                if (fit_data_is_fit_point(d,i))
+                {
+                    mat_set(Y,k*npt+k_i,0,mat_get(f_buf,i,0)\
+                            -fit_data_get_y(d,i,k));
+                    k_i++;
+                }
+            }
+        }
+    }
     else
     {
         for (i=0;i<ndata;i++)
@@ -1351,6 +1635,28 @@ static void set_X_Y(mat* X, mat *Y, mat *x_buf, const mat *p, const fit_data *d)
 #define NFLOP_MAT_MUL_NN(b,c)\
 (2.0*(double)(nrow(b)*ncol(c)*ncol(b)))
 #define NFLOP_DDOT(b) (2.0*(double)(nrow(b)))
+#define NFLOP_DTPSV(b) ((double)(nrow(b)*nrow(b)))
+
+/* v <- L^-1*v (or t(L)^-1*v) where L is the packed Cholesky factor of C */
+static void chol_solve(const double *l_pk, gsl_vector *v, const bool trans)
+{
+    cblas_dtpsv(CblasRowMajor,CblasLower,trans ? CblasTrans : CblasNoTrans,\
+                CblasNonUnit,(int)v->size,l_pk,v->data,(int)v->stride);
+}
+
+/* t(v)*C^-1*v = |L^-1*v|^2 where L is the packed Cholesky factor of C */
+static double chol_quad(const double *l_pk, const mat *v, mat *buf)
+{
+    gsl_vector_view buf_vview;
+    double res;
+    
+    mat_cp(buf,v);
+    buf_vview = gsl_matrix_column(buf->data_cpu,0);
+    chol_solve(l_pk,&(buf_vview.vector),false);
+    latan_blas_ddot(buf,buf,&res);
+    
+    return res;
+}
 
 /* compute t(lX)*C^-1*lX */
 static double chi2_base(const mat *p, void *vd)
@@ -1361,53 +1667,72 @@ static double chi2_base(const mat *p, void *vd)
     double res,buf;
     
     d       = (fit_data *)vd;
-#ifdef _OPENMP
-    nthread = omp_get_num_threads();
-    thread  = omp_get_thread_num();
-#else
-    nthread = 1;
-    thread  = 0;
-#endif
+    get_buf_ind(&thread,&nthread,d);
 
-    /* buffers and inverse variance matrices initialization */
+    /* buffers and variance matrices initialization */
     init_chi2(d,thread,nthread);
     x_f = d->buf[thread].x_f;
     Y   = d->buf[thread].Y;
     CyY = d->buf[thread].CyY;
-    Cy  = d->y_var_inv;
+    Cy  = d->y_var;
     X   = d->buf[thread].X;
     CxX = d->buf[thread].CxX;
-    Cx  = d->x_var_inv;
+    Cx  = d->x_var;
     lX  = d->buf[thread].lX;
     ClX = d->buf[thread].ClX;
-    C   = d->var_inv;
+    C   = d->var;
 
     /* setting X and Y */
-    set_X_Y(X,Y,x_f,p,d);
+    set_X_Y(X,Y,x_f,d->buf[thread].f,p,d);
     d->callps += (double)(nrow(Y));
     
-    /* setting lX and computing chi^2 in case of data/x covariance */
+    /* setting lX and computing chi^2 in case of data/x covariance, using
+     * the Cholesky factor of C when it exists */
     if (fit_data_have_xy_covar(d))
     {
         mat_set_subm(lX,Y,0,0,nrow(Y)-1,0);
         mat_set_subm(lX,X,nrow(Y),0,nrow(lX)-1,0);
-        mat_mul(ClX,C,'n',lX,'n');
-        d->matperf += NFLOP_MAT_MUL_NN(C,lX);
-        latan_blas_ddot(ClX,lX,&res);
+        if (d->var_chol != NULL)
+        {
+            res = chol_quad(d->var_chol,lX,ClX);
+            d->matperf += NFLOP_DTPSV(lX);
+        }
+        else
+        {
+            mat_mul(ClX,C,'n',lX,'n');
+            d->matperf += NFLOP_MAT_MUL_NN(C,lX);
+            latan_blas_ddot(ClX,lX,&res);
+        }
         d->matperf += NFLOP_DDOT(ClX);
     }
     /* computing chi^2 by blocks in case of no data/x covariance */
     else
     {
-        mat_mul(CyY,Cy,'n',Y,'n');
-        d->matperf += NFLOP_MAT_MUL_NN(Cy,Y);
-        latan_blas_ddot(CyY,Y,&res);
+        if (d->y_var_chol != NULL)
+        {
+            res = chol_quad(d->y_var_chol,Y,CyY);
+            d->matperf += NFLOP_DTPSV(Y);
+        }
+        else
+        {
+            mat_mul(CyY,Cy,'n',Y,'n');
+            d->matperf += NFLOP_MAT_MUL_NN(Cy,Y);
+            latan_blas_ddot(CyY,Y,&res);
+        }
         d->matperf += NFLOP_DDOT(CyY);
         if (fit_data_have_x_var(d))
         {
-            mat_mul(CxX,Cx,'n',X,'n');
-            d->matperf += NFLOP_MAT_MUL_NN(Cx,X);
-            latan_blas_ddot(CxX,X,&buf);
+            if (d->x_var_chol != NULL)
+            {
+                buf = chol_quad(d->x_var_chol,X,CxX);
+                d->matperf += NFLOP_DTPSV(X);
+            }
+            else
+            {
+                mat_mul(CxX,Cx,'n',X,'n');
+                d->matperf += NFLOP_MAT_MUL_NN(Cx,X);
+                latan_blas_ddot(CxX,X,&buf);
+            }
             d->matperf += NFLOP_DDOT(CxX);
             res += buf;
         }
@@ -1422,6 +1747,270 @@ double chi2(const mat *p, void *vd)
     return chi2_base(p,vd) + ((fit_data *)vd)->chi2_ext(p,vd);
 }
 
+/* analytic chi^2 gradient :
+ * -------------------------
+ *
+ * when there is no variance on the points and no chi^2 extension,
+ * chi^2 = t(Y)*Cy^-1*Y and its gradient is 2*t(J)*Cy^-1*Y where J is the
+ * jacobian of Y with respect to the parameters, given by the model
+ * derivatives
+ *
+ */
+bool chi2_have_grad(const fit_data *d)
+{
+    return (d->model != NULL)&&fit_model_have_grad(d->model)            \
+           &&(!fit_data_have_x_var(d))&&(!fit_data_have_xy_covar(d)) \
+           &&(d->chi2_ext == &zero);
+}
+
+void chi2_grad(mat *df, const mat *p, void *vd)
+{
+    fit_data *d;
+    int nthread,thread;
+    mat *x_f,*Y,*CyY,*Cy,*X,*dY;
+    mat x_i;
+    gsl_matrix_view x_view;
+    gsl_vector_view dY_vview,df_vview,CyY_vview;
+    size_t ndata,nydim,npt,npar;
+    size_t i,k,k_i;
+    double w;
+    
+    d       = (fit_data *)vd;
+    get_buf_ind(&thread,&nthread,d);
+    ndata   = fit_data_get_ndata(d);
+    nydim   = fit_data_get_nydim(d);
+    npt     = fit_data_fit_point_num(d);
+    npar    = nrow(p);
+    
+    /* buffers and variance matrices initialization */
+    init_chi2(d,thread,nthread);
+    x_f = d->buf[thread].x_f;
+    Y   = d->buf[thread].Y;
+    CyY = d->buf[thread].CyY;
+    Cy  = d->y_var;
+    X   = d->buf[thread].X;
+    if ((d->buf[thread].df == NULL)||(nrow(d->buf[thread].df) != npar))
+    {
+        mat_destroy(d->buf[thread].df);
+        d->buf[thread].df = mat_create(npar,1);
+    }
+    dY  = d->buf[thread].df;
+    
+    /* Cy^-1*Y, with two triangular solves if Cy = L*t(L) */
+    set_X_Y(X,Y,x_f,d->buf[thread].f,p,d);
+    if (d->y_var_chol != NULL)
+    {
+        mat_cp(CyY,Y);
+        CyY_vview = gsl_matrix_column(CyY->data_cpu,0);
+        chol_solve(d->y_var_chol,&(CyY_vview.vector),false);
+        chol_solve(d->y_var_chol,&(CyY_vview.vector),true);
+    }
+    else
+    {
+        mat_mul(CyY,Cy,'n',Y,'n');
+    }
+    
+    /* 2*t(J)*Cy^-1*Y */
+    mat_zero(df);
+    dY_vview = gsl_matrix_column(dY->data_cpu,0);
+    df_vview = gsl_matrix_column(df->data_cpu,0);
+    k_i      = 0;
+    for (i=0;i<ndata;i++)
+    {
+        if (fit_data_is_fit_point(d,i))
+        {
+            x_view        = gsl_matrix_submatrix(d->x->data_cpu,0,i,d->nxdim,1);
+            x_i.data_cpu  = &(x_view.matrix);
+            x_i.prop_flag = MAT_GEN;
+            for (k=0;k<nydim;k++)
+            {
+                fit_model_eval_grad(dY,d->model,k,&x_i,p,d->model_param);
+                w = 2.0*mat_get(CyY,k*npt+k_i,0);
+                gsl_blas_daxpy(w,&(dY_vview.vector),&(df_vview.vector));
+            }
+            k_i++;
+        }
+    }
+}
+
+/* whitened residuals :
+ * ---------------------
+ *
+ * with W*t(W) = C^-1, chi^2 = t(r)*r where r = t(W)*lX is the residual
+ * vector minimized by least-squares algorithms ; if C = L*t(L) is positive
+ * definite t(W) = L^-1 and r is obtained with a triangular solve, else W is
+ * computed from the pseudo-inverse of C ; when chi2_have_grad is true, the
+ * jacobian of r is t(Wy)*J where J is the jacobian of Y
+ *
+ */
+/* whitening factors are only used by least-squares minimizers, they are
+ * computed by the first chi2_res or chi2_res_jac call after an inversion */
+static void init_chi2_res(fit_data *d)
+{
+    if (d->is_whitened)
+    {
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+        return;
+    }
+#ifdef _OPENMP
+#pragma omp critical(latan_fit_init_chi2)
+#endif
+    {
+        if (!d->is_whitened)
+        {
+            whiten_var_inv(&(d->y_var_wht),d->y_var_chol,d->y_var);
+            if (fit_data_have_x_var(d))
+            {
+                whiten_var_inv(&(d->x_var_wht),d->x_var_chol,d->x_var);
+            }
+            if (fit_data_have_xy_covar(d))
+            {
+                whiten_var_inv(&(d->var_wht),d->var_chol,d->var);
+            }
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+            d->is_whitened = true;
+        }
+    }
+}
+
+static void whiten(mat *r, const double *l_pk, const mat *w, const mat *v)
+{
+    gsl_vector_view r_j;
+    size_t j;
+    
+    if (l_pk != NULL)
+    {
+        mat_cp(r,v);
+        for (j=0;j<ncol(r);j++)
+        {
+            r_j = gsl_matrix_column(r->data_cpu,j);
+            chol_solve(l_pk,&(r_j.vector),false);
+        }
+    }
+    else
+    {
+        mat_mul(r,w,'t',v,'n');
+    }
+}
+
+#define NFLOP_WHITEN(l_pk,w,v)\
+(((l_pk) != NULL) ? NFLOP_DTPSV(v)*(double)ncol(v) : NFLOP_MAT_MUL_NN(w,v))
+
+void chi2_res(mat *res, const mat *p, void *vd)
+{
+    fit_data *d;
+    int nthread,thread;
+    mat *x_f,*Y,*X,*lX;
+    mat res_y,res_x;
+    gsl_matrix_view res_y_view,res_x_view;
+    
+    d       = (fit_data *)vd;
+    get_buf_ind(&thread,&nthread,d);
+    
+    /* buffers, variance matrices and whitening initialization */
+    init_chi2(d,thread,nthread);
+    init_chi2_res(d);
+    x_f = d->buf[thread].x_f;
+    Y   = d->buf[thread].Y;
+    X   = d->buf[thread].X;
+    lX  = d->buf[thread].lX;
+    
+    /* setting X and Y */
+    set_X_Y(X,Y,x_f,d->buf[thread].f,p,d);
+    d->callps += (double)(nrow(Y));
+    
+    /* t(W)*lX in case of data/x covariance */
+    if (fit_data_have_xy_covar(d))
+    {
+        mat_set_subm(lX,Y,0,0,nrow(Y)-1,0);
+        mat_set_subm(lX,X,nrow(Y),0,nrow(lX)-1,0);
+        whiten(res,d->var_chol,d->var_wht,lX);
+        d->matperf += NFLOP_WHITEN(d->var_chol,d->var_wht,lX);
+    }
+    /* t(W)*lX by blocks in case of no data/x covariance */
+    else
+    {
+        res_y_view      = gsl_matrix_submatrix(res->data_cpu,0,0,nrow(Y),1);
+        res_y.data_cpu  = &(res_y_view.matrix);
+        res_y.prop_flag = MAT_GEN;
+        whiten(&res_y,d->y_var_chol,d->y_var_wht,Y);
+        d->matperf += NFLOP_WHITEN(d->y_var_chol,d->y_var_wht,Y);
+        if (fit_data_have_x_var(d))
+        {
+            res_x_view      = gsl_matrix_submatrix(res->data_cpu,nrow(Y),0,\
+                                                   nrow(X),1);
+            res_x.data_cpu  = &(res_x_view.matrix);
+            res_x.prop_flag = MAT_GEN;
+            whiten(&res_x,d->x_var_chol,d->x_var_wht,X);
+            d->matperf += NFLOP_WHITEN(d->x_var_chol,d->x_var_wht,X);
+        }
+    }
+}
+
+void chi2_res_jac(mat *J, const mat *p, void *vd)
+{
+    fit_data *d;
+    int nthread,thread;
+    mat *JY,*dY;
+    mat x_i;
+    gsl_matrix_view x_view;
+    size_t ndata,nydim,npt,npar,Ysize;
+    size_t i,j,k,k_i;
+    
+    d       = (fit_data *)vd;
+    get_buf_ind(&thread,&nthread,d);
+    ndata   = fit_data_get_ndata(d);
+    nydim   = fit_data_get_nydim(d);
+    npt     = fit_data_fit_point_num(d);
+    npar    = nrow(p);
+    Ysize   = get_Ysize(d);
+    
+    /* buffers, variance matrices and whitening initialization */
+    init_chi2(d,thread,nthread);
+    init_chi2_res(d);
+    if ((d->buf[thread].df == NULL)||(nrow(d->buf[thread].df) != npar))
+    {
+        mat_destroy(d->buf[thread].df);
+        d->buf[thread].df = mat_create(npar,1);
+    }
+    if ((d->buf[thread].J == NULL)||(nrow(d->buf[thread].J) != Ysize)\
+        ||(ncol(d->buf[thread].J) != npar))
+    {
+        mat_destroy(d->buf[thread].J);
+        d->buf[thread].J = mat_create(Ysize,npar);
+    }
+    dY = d->buf[thread].df;
+    JY = d->buf[thread].J;
+    
+    /* jacobian of Y */
+    k_i = 0;
+    for (i=0;i<ndata;i++)
+    {
+        if (fit_data_is_fit_point(d,i))
+        {
+            x_view        = gsl_matrix_submatrix(d->x->data_cpu,0,i,d->nxdim,1);
+            x_i.data_cpu  = &(x_view.matrix);
+            x_i.prop_flag = MAT_GEN;
+            for (k=0;k<nydim;k++)
+            {
+                fit_model_eval_grad(dY,d->model,k,&x_i,p,d->model_param);
+                for (j=0;j<npar;j++)
+                {
+                    mat_set(JY,k*npt+k_i,j,mat_get(dY,j,0));
+                }
+            }
+            k_i++;
+        }
+    }
+    
+    /* t(Wy)*J */
+    whiten(J,d->y_var_chol,d->y_var_wht,JY);
+}
+
 /* compute chi^2 composition */
 latan_errno chi2_get_comp(mat *comp, mat *p, fit_data *d)
 {
@@ -1449,21 +2038,15 @@ latan_errno chi2_get_comp(mat *comp, mat *p, fit_data *d)
     mat_set(comp,Xsize+Ysize+1,0,d->chi2_ext(p,d));
     
     /* compute diagonal chi^2 elements */
-#ifdef _OPENMP
-    nthread = omp_get_num_threads();
-    thread  = omp_get_thread_num();
-#else
-    nthread = 1;
-    thread  = 0;
-#endif
-    /** buffers and inverse variance matrices initialization **/
+    get_buf_ind(&thread,&nthread,d);
+    /** buffers and variance matrices initialization **/
     init_chi2(d,thread,nthread);
     x   = d->buf[thread].x_f;
     Y   = d->buf[thread].Y;
     X   = d->buf[thread].X;
     
     /** setting X and Y **/
-    set_X_Y(X,Y,x,p,d);
+    set_X_Y(X,Y,x,d->buf[thread].f,p,d);
     
     /** diagonal y elements **/
     uncor = 0.0;
@@ -1511,6 +2094,92 @@ latan_errno chi2_get_comp(mat *comp, mat *p, fit_data *d)
 
 /*                          fit functions                                   */
 /****************************************************************************/
+/** environment **/
+bool rs_data_fit_get_parallel(void)
+{
+    return env.par_rs_fit;
+}
+
+void rs_data_fit_set_parallel(const bool par_rs_fit)
+{
+    env.par_rs_fit = par_rs_fit;
+}
+
+/** sample fit helpers **/
+static latan_errno set_sample(fit_data *d, mat *pbuf, const mat *pinit,\
+                              rs_sample * const *x,                     \
+                              rs_sample * const *data,                  \
+                              const bool *use_x_var, const size_t s)
+{
+    latan_errno status;
+    mat *x_k;
+    size_t npt,ndata,nxdim,nydim,npar,px_ind;
+    size_t i,k,k_i;
+    
+    status = LATAN_SUCCESS;
+    npt    = fit_data_fit_point_num(d);
+    ndata  = fit_data_get_ndata(d);
+    nxdim  = fit_data_get_nxdim(d);
+    nydim  = fit_data_get_nydim(d);
+    npar   = fit_data_get_npar(d);
+    
+    USTAT(mat_set_subm(pbuf,pinit,0,0,npar-1,0));
+    for (k=0;k<nydim;k++)
+    {
+        USTAT(fit_data_set_y_k(d,k,rs_sample_pt_sample(data[k],s)));
+    }
+    if (x != NULL)
+    {
+        px_ind = 0;
+        for (k=0;k<nxdim;k++)
+        {
+            USTAT(fit_data_set_x_k(d,k,rs_sample_pt_sample(x[k],s)));
+            if (use_x_var[k])
+            {
+                k_i = 0;
+                x_k = rs_sample_pt_sample(x[k],s);
+                for (i=0;i<ndata;i++)
+                {
+                    if (fit_data_is_fit_point(d,i))
+                    {
+                        mat_set(pbuf,npar+px_ind*npt+k_i,0,mat_get(x_k,i,0));
+                        k_i++;
+                    }
+                }
+                px_ind++;
+            }
+        }
+    }
+    
+    return status;
+}
+
+static void print_progress(const fit_data *d, const size_t s,\
+                           const size_t nsample)
+{
+    size_t i;
+    
+    if (latan_get_use_car_ret())
+    {
+        printf("[");
+        for (i=0;i<60*(s+1)/nsample;i++)
+        {
+            printf("=");
+        }
+        for (i=60*(s+1)/nsample;i<60;i++)
+        {
+            printf(" ");
+        }
+        printf("]  %d/%d\r",(int)s+1,(int)nsample);
+        fflush(stdout);
+    }
+    else
+    {
+        latan_printf(VERB,"fit: sample %d/%d chi^2/dof = %e\n",    \
+                     (int)s+1,(int)nsample,fit_data_get_chi2pdof(d));
+    }
+}
+
 latan_errno data_fit(mat *p, const mat *p_limit, fit_data *d)
 {
     latan_errno status;
@@ -1541,7 +2210,25 @@ latan_errno data_fit(mat *p, const mat *p_limit, fit_data *d)
     d->matperf  = 0.0;
     d->callps   = 0.0;
     dur         = clock();
-    status      = minimize(p,p_limit,&chi2_min,&chi2,d);
+    if (minimizer_get_lib() == LSQ)
+    {
+        if (d->chi2_ext != &zero)
+        {
+            LATAN_ERROR("least-squares minimization is not possible with a chi^2 extension",\
+                        LATAN_EINVAL);
+        }
+        status = minimize_lsq(p,p_limit,&chi2_min,get_Ysize(d)+get_Xsize(d),\
+                              &chi2_res,                                 \
+                              chi2_have_grad(d) ? &chi2_res_jac : NULL,d);
+    }
+    else if (chi2_have_grad(d))
+    {
+        status = minimize_grad(p,p_limit,&chi2_min,&chi2,&chi2_grad,d);
+    }
+    else
+    {
+        status = minimize(p,p_limit,&chi2_min,&chi2,d);
+    }
     dur         = clock() - dur;
     d->matperf /= DRATIO(dur,CLOCKS_PER_SEC);
     d->callps  /= DRATIO(dur,CLOCKS_PER_SEC);
@@ -1561,7 +2248,7 @@ latan_errno rs_data_fit(rs_sample *p, const mat *p_limit, rs_sample * const *x,\
     latan_errno status;
     mat *pbuf,*plimbuf,*pinit,*comp_backup,*x_k;
     size_t npt,ndata,nxdim,nydim,npar,nsample,Xsize,Ysize,px_ind;
-    size_t i,k,k_i,s;
+    size_t i,k,k_i,s,ndone;
     int verb_backup;
     double chi2_backup;
     
@@ -1634,70 +2321,91 @@ latan_errno rs_data_fit(rs_sample *p, const mat *p_limit, rs_sample * const *x,\
                  d->matperf/(1.0e+09),d->callps);
     
     /* sample fits */
-    for (s=0;s<nsample;s++)
+    if (env.par_rs_fit)
     {
-        (d->s)++;
-        /** setting data and initial parameters **/
-        USTAT(mat_set_subm(pbuf,pinit,0,0,npar-1,0));
-        for (k=0;k<nydim;k++)
+        if (verb_backup != DEBUG2)
         {
-            USTAT(fit_data_set_y_k(d,k,rs_sample_pt_sample(data[k],s)));
+            USTAT(latan_set_verb(QUIET));
         }
-        if (x != NULL)
+        ndone = 0;
+#ifdef _OPENMP
+        #pragma omp parallel
+#endif
         {
-            px_ind = 0;
-            for (k=0;k<nxdim;k++)
+            fit_data *d_t;
+            mat *pbuf_t;
+            long ls;
+            size_t s_t;
+            latan_errno tstatus;
+            
+            tstatus = LATAN_SUCCESS;
+#ifdef _OPENMP
+            #pragma omp critical
+#endif
             {
-                USTAT(fit_data_set_x_k(d,k,rs_sample_pt_sample(x[k],s)));
-                if (use_x_var[k])
+                d_t    = fit_data_create_clone(d);
+                pbuf_t = mat_create(npar+Xsize,1);
+            }
+#ifdef _OPENMP
+            #pragma omp for schedule(dynamic)
+#endif
+            for (ls=0;ls<(long)(nsample);ls++)
+            {
+                s_t    = (size_t)(ls);
+                d_t->s = s_t + 1;
+                LATAN_UPDATE_STATUS(tstatus,set_sample(d_t,pbuf_t,pinit,x,   \
+                                                       data,use_x_var,s_t));
+                LATAN_UPDATE_STATUS(tstatus,data_fit(pbuf_t,plimbuf,d_t));
+                LATAN_UPDATE_STATUS(tstatus,                                 \
+                                    mat_get_subm(rs_sample_pt_sample(p,s_t),\
+                                                 pbuf_t,0,0,npar-1,0));
+#ifdef _OPENMP
+                #pragma omp critical
+#endif
                 {
-                    k_i = 0;
-                    x_k = rs_sample_pt_sample(x[k],s);
-                    for (i=0;i<ndata;i++)
+                    if (verb_backup == VERB)
                     {
-                        if (fit_data_is_fit_point(d,i))
-                        {
-                            mat_set(pbuf,npar+px_ind*npt+k_i,0,\
-                                    mat_get(x_k,i,0));
-                            k_i++;
-                        }
+                        print_progress(d_t,ndone,nsample);
                     }
-                    px_ind++;
+                    latan_printf(DEBUG2,"fit: sample %d/%d chi^2/dof = %e\n",\
+                                 (int)s_t+1,(int)nsample,                   \
+                                 fit_data_get_chi2pdof(d_t));
+                    ndone++;
                 }
             }
+#ifdef _OPENMP
+            #pragma omp critical
+#endif
+            {
+                USTAT(tstatus);
+                mat_destroy(pbuf_t);
+                fit_data_destroy(d_t);
+            }
         }
-        /** fit **/
-        if (verb_backup != DEBUG2)
-        {
-            USTAT(latan_set_verb(QUIET));
-        }
-        USTAT(data_fit(pbuf,plimbuf,d));
         USTAT(latan_set_verb(verb_backup));
-        if (latan_get_verb() == VERB)
+    }
+    else
+    {
+        for (s=0;s<nsample;s++)
         {
-            if (latan_get_use_car_ret())
+            (d->s)++;
+            /** setting data and initial parameters **/
+            USTAT(set_sample(d,pbuf,pinit,x,data,use_x_var,s));
+            /** fit **/
+            if (verb_backup != DEBUG2)
             {
-                printf("[");
-                for (i=0;i<60*(s+1)/nsample;i++)
-                {
-                    printf("=");
-                }
-                for (i=60*(s+1)/nsample;i<60;i++)
-                {
-                    printf(" ");
-                }
-                printf("]  %d/%d\r",(int)s+1,(int)nsample);
-                fflush(stdout);
+                USTAT(latan_set_verb(QUIET));
             }
-            else
+            USTAT(data_fit(pbuf,plimbuf,d));
+            USTAT(latan_set_verb(verb_backup));
+            if (latan_get_verb() == VERB)
             {
-                latan_printf(VERB,"fit: sample %d/%d chi^2/dof = %e\n",    \
-                             (int)s+1,(int)nsample,fit_data_get_chi2pdof(d));
+                print_progress(d,s,nsample);
             }
+            latan_printf(DEBUG2,"fit: sample %d/%d chi^2/dof = %e\n",(int)s+1,\
+                         (int)nsample,fit_data_get_chi2pdof(d));
+            USTAT(mat_get_subm(rs_sample_pt_sample(p,s),pbuf,0,0,npar-1,0));
         }
-        latan_printf(DEBUG2,"fit: sample %d/%d chi^2/dof = %e\n",(int)s+1,\
-                     (int)nsample,fit_data_get_chi2pdof(d));
-        USTAT(mat_get_subm(rs_sample_pt_sample(p,s),pbuf,0,0,npar-1,0));
     }
     if (latan_get_verb() == VERB)
     {
@@ -32,7 +32,15 @@
 __BEGIN_DECLS
 
 /* fit model structure */
+/** dfunc (optional) fills the npar x 1 matrix df with the derivatives of
+ *  func with respect to the parameters, batch (optional) fills the n x 1
+ *  matrix res with func evaluated on the n columns of the nxdim x n
+ *  matrix x **/
 typedef double model_func(const mat *x, const mat *p, void *model_param);
+typedef void model_dfunc(mat *df, const mat *x, const mat *p,\
+                         void *model_param);
+typedef void model_batch_func(mat *res, const mat *x, const mat *p,\
+                              void *model_param);
 typedef size_t npar_func(void *model_param);
 
 typedef struct
@@ -42,6 +50,8 @@ typedef struct
     npar_func *npar;
     size_t nxdim;
     size_t nydim;
+    model_dfunc *dfunc[MAX_YDIM];
+    model_batch_func *batch[MAX_YDIM];
 } fit_model;
 
 /** some useful constant npar_func **/
@@ -61,18 +71,27 @@ void fit_model_get_name(strbuf name, const fit_model *model);
 size_t fit_model_get_npar(const fit_model *model, void *model_param);
 double fit_model_eval(const fit_model *model, const size_t k, const mat *x,\
                       const mat *p, void *model_param);
+bool fit_model_have_grad(const fit_model *model);
+void fit_model_eval_grad(mat *df, const fit_model *model, const size_t k,\
+                         const mat *x, const mat *p, void *model_param);
+bool fit_model_have_batch(const fit_model *model);
+void fit_model_eval_batch(mat *res, const fit_model *model, const size_t k,\
+                          const mat *x, const mat *p, void *model_param);
 
 /* fit data structure */
 /** chi^2 buffer **/
 typedef struct chi2_buf_s
 {
     mat *x_f;
+    mat *f;
     mat *Y;
     mat *CyY;
     mat *X;
     mat *CxX;
     mat *lX;
     mat *ClX;
+    mat *df;
+    mat *J;
     bool is_xpart_alloc;
     bool is_ypart_alloc;
 } chi2_buf;
@@ -89,24 +108,37 @@ typedef struct fid_data_s
     /* point matrices */
     mat *x;
     mat **x_covar;
-    mat *x_var_inv;
+    mat *x_var;
     bool is_x_correlated;
     bool *have_x_covar;
     bool *to_fit;
     /* data matrices */
     mat *y;
     mat **y_covar;
-    mat *y_var_inv;
+    mat *y_var;
     bool is_y_correlated;
     /* data/point covariance matrix */
     mat **xy_covar;
     bool *have_xy_covar;
     /* correlation filter */
     mat *cor_filter;
-    /* inverse variance matrix */
-    mat *var_inv;
+    /* variance matrices C of the points (x_var), of the data (y_var) and
+     * global (var), each one is overwritten with its pseudo-inverse C^+ when
+     * it is not positive definite */
+    mat *var;
+    /* packed (row major lower) Cholesky factors L*t(L) = C of the variance
+     * matrices, NULL if they are not positive definite */
+    double *x_var_chol;
+    double *y_var_chol;
+    double *var_chol;
+    /* whitening factors W*t(W) = C^+ of the pseudo-inverse variance
+     * matrices, only used when the Cholesky factor is NULL */
+    mat *x_var_wht;
+    mat *y_var_wht;
+    mat *var_wht;
     /* is everything ready to perform a fit ? */
     bool is_inverted;
+    bool is_whitened;
     /* fit model */
     fit_model *model;
     void *model_param;
@@ -122,11 +154,20 @@ typedef struct fid_data_s
     /* chi^2 performance */
     double matperf;
     double callps;
+    /* clone sharing covariance matrices with another fit_data */
+    bool is_clone;
 } fit_data;
 
 /** allocation **/
 fit_data *fit_data_create(const size_t ndata, const size_t nxdim,\
                           const size_t nydim);
+/*** a clone owns its data, points and chi^2 buffers but shares everything
+ *   else (covariances, inverse covariances, whitening factors, model...)
+ *   with the original which must stay allocated and unmodified while the
+ *   clone is used, these shared matrices are only computed by the original
+ *   so it must have been fitted before cloning (the whitening factors used
+ *   by least-squares minimizers are computed by fit_data_create_clone) ***/
+fit_data *fit_data_create_clone(fit_data *d);
 void fit_data_destroy(fit_data *d);
 
 /** access **/
@@ -221,9 +262,18 @@ latan_errno fit_data_set_covar_from_sample(fit_data *d, rs_sample * const *x,\
 
 /* chi2 function */
 double chi2(const mat *p, void *vd);
+bool chi2_have_grad(const fit_data *d);
+void chi2_grad(mat *df, const mat *p, void *vd);
+void chi2_res(mat *res, const mat *p, void *vd);
+void chi2_res_jac(mat *J, const mat *p, void *vd);
 latan_errno chi2_get_comp(mat *comp, mat *p, fit_data *d);
 
 /* fit functions */
+/** in parallel mode, rs_data_fit fits the samples concurrently on
+ *  fit_data clones, the chi^2 extension and the model must be
+ *  thread-safe **/
+bool rs_data_fit_get_parallel(void);
+void rs_data_fit_set_parallel(const bool par_fit);
 latan_errno data_fit(mat *p, const mat *p_limit, fit_data *d);
 latan_errno rs_data_fit(rs_sample *p, const mat *p_limit, rs_sample * const *x,\
                         rs_sample * const *data, fit_data *d,                  \
@@ -123,7 +123,7 @@ extern double acosh(double x); /* acosh is not ANSI compliant */
 /* file opening */
 #define FOPEN(f,fname,mode)\
 {\
-    f = fopen(fname,mode);\
+    f = io_fopen(fname,mode);\
     if (f == NULL)\
     {\
         strbuf _errmsg;\
@@ -133,7 +133,7 @@ extern double acosh(double x); /* acosh is not ANSI compliant */
 }
 #define FOPEN_ERRVAL(f,fname,mode,value)\
 {\
-    f = fopen(fname,mode);\
+    f = io_fopen(fname,mode);\
     if (f == NULL)\
     {\
         strbuf _errmsg;\
@@ -143,7 +143,7 @@ extern double acosh(double x); /* acosh is not ANSI compliant */
 }
 #define FOPEN_NOERRET(f,fname,mode)\
 {\
-    f = fopen(fname,mode);\
+    f = io_fopen(fname,mode);\
     if (f == NULL)\
     {\
         strbuf _errmsg;\
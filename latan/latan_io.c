@@ -21,7 +21,9 @@
 
 #include <latan/latan_io.h>
 #include <latan/latan_includes.h>
+#include <latan/latan_dtoa.h>
 #include <latan/latan_io_ascii.h>
+#include <latan/latan_io_bin.h>
 #ifdef HAVE_LIBXML2
 #include <latan/latan_io_xml.h>
 #endif
@@ -35,10 +37,13 @@
 #define DEF_IO_FINISH              IO_FUNC(io_finish,ascii)
 #define DEF_MAT_SAVE               IO_FUNC(mat_save,ascii)
 #define DEF_MAT_LOAD               IO_FUNC(mat_load,ascii)
+#define DEF_MAT_LOAD_SUBM          IO_FUNC(mat_load_subm,ascii)
 #define DEF_RANDGEN_SAVE_STATE     IO_FUNC(randgen_save_state,ascii)
 #define DEF_RANDGEN_LOAD_STATE     IO_FUNC(randgen_load_state,ascii)
 #define DEF_RS_SAMPLE_SAVE         IO_FUNC(rs_sample_save,ascii)
 #define DEF_RS_SAMPLE_LOAD         IO_FUNC(rs_sample_load,ascii)
+#define DEF_RS_SAMPLE_LOAD_SUBSAMP IO_FUNC(rs_sample_load_subsamp,ascii)
+#define DEF_RS_SEED_SAVE           IO_FUNC(rs_seed_save,ascii)
 
 /*                               environment                                */
 /****************************************************************************/
@@ -46,11 +51,15 @@ typedef struct io_env_s
 {
     io_fmt_no fmt;
     bool      is_init;
+    int       nthread;
+    bool      xml_b64;
 } io_env;
 
 static io_env env =\
 {                  \
     DEF_IO_FMT,    \
+    false,         \
+    0,             \
     false          \
 };
 
@@ -64,6 +73,10 @@ static latan_errno (*mat_save_pt)(const strbuf fname, const char mode,\
 static latan_errno (*mat_load_pt)(mat *m, size_t *dim, const strbuf fname,\
                                   const strbuf name)                      \
     = &DEF_MAT_LOAD;
+static latan_errno (*mat_load_subm_pt)(mat *m, const strbuf fname,         \
+                                       const strbuf name, const size_t k1,\
+                                       const size_t l1)                   \
+    = &DEF_MAT_LOAD_SUBM;
 static latan_errno (*randgen_save_state_pt)(const strbuf f_name, \
                                             const char mode,     \
                                             const rg_state state,\
@@ -80,6 +93,15 @@ static latan_errno (*rs_sample_load_pt)(rs_sample *s, size_t *nsample,  \
                                         size_t *dim, const strbuf fname,\
                                         const strbuf name)              \
     = &DEF_RS_SAMPLE_LOAD;
+static latan_errno (*rs_sample_load_subsamp_pt)(rs_sample *s,             \
+                                                const strbuf fname,       \
+                                                const strbuf name,        \
+                                                const size_t k1,          \
+                                                const size_t l1)          \
+    = &DEF_RS_SAMPLE_LOAD_SUBSAMP;
+static latan_errno (*rs_seed_save_pt)(const strbuf fname, const char mode, \
+                                      const rs_seed *sd, const strbuf name)\
+    = &DEF_RS_SEED_SAVE;
 
 /*                              I/O format                                  */
 /****************************************************************************/
@@ -89,10 +111,13 @@ SET_IO_FUNC(io_init,suf);\
 SET_IO_FUNC(io_finish,suf);\
 SET_IO_FUNC(mat_save,suf);\
 SET_IO_FUNC(mat_load,suf);\
+SET_IO_FUNC(mat_load_subm,suf);\
 SET_IO_FUNC(randgen_save_state,suf);\
 SET_IO_FUNC(randgen_load_state,suf);\
 SET_IO_FUNC(rs_sample_save,suf);\
-SET_IO_FUNC(rs_sample_load,suf);
+SET_IO_FUNC(rs_sample_load,suf);\
+SET_IO_FUNC(rs_sample_load_subsamp,suf);\
+SET_IO_FUNC(rs_seed_save,suf);
 
 latan_errno io_set_fmt(const io_fmt_no fmt)
 {
@@ -117,6 +142,9 @@ latan_errno io_set_fmt(const io_fmt_no fmt)
         case IO_ASCII:
             SET_IO_FUNCS(ascii);
             break;
+        case IO_BIN:
+            SET_IO_FUNCS(bin);
+            break;
         default:
             LATAN_ERROR("I/O format flag unknown",LATAN_EINVAL);
             break;
@@ -136,6 +164,26 @@ io_fmt_no io_get_fmt(void)
     return env.fmt;
 }
 
+void io_set_nthread(const int nthread)
+{
+    env.nthread = (nthread > 0) ? nthread : 0;
+}
+
+int io_get_nthread(void)
+{
+    return env.nthread;
+}
+
+void io_set_xml_base64(const bool is_b64)
+{
+    env.xml_b64 = is_b64;
+}
+
+bool io_get_xml_base64(void)
+{
+    return env.xml_b64;
+}
+
 /*                              I/O init/finish                             */
 /****************************************************************************/
 void io_init(void)
@@ -235,7 +283,22 @@ void get_elname(strbuf fname, strbuf elname, const strbuf latan_path)
 void mat_dump(FILE* stream, const mat *m, const strbuf fmt)
 {
     size_t i,j;
+    char buf[LATAN_DTOA_SIZE];
     
+    if (fmt == NULL)
+    {
+        for (i=0;i<nrow(m);i++)
+        {
+            for (j=0;j<ncol(m);j++)
+            {
+                latan_dtoa(buf,mat_get(m,i,j));
+                fputs(buf,stream);
+                fputc((j < ncol(m) - 1) ? ' ' : '\n',stream);
+            }
+        }
+        
+        return;
+    }
     for (i=0;i<nrow(m);i++)
     {
         for (j=0;j<ncol(m)-1;j++)
@@ -293,63 +356,133 @@ latan_errno mat_load(mat *m, size_t *dim, const strbuf latan_path)
     return status;
 }
 
+/* only the sub-matrix is converted (text formats) or read (binary format),
+ * the whole matrix is never allocated */
 latan_errno mat_load_subm(mat *m, const strbuf latan_path, const size_t k1, \
                           const size_t l1, const size_t k2, const size_t l2)
 {
-    mat *big_m;
-    size_t dim[2];
     latan_errno status;
+    strbuf fname,elname;
     
-    status = LATAN_SUCCESS;
-    
-    USTAT(mat_load(NULL,dim,latan_path));
-    big_m = mat_create(dim[0],dim[1]);
-    USTAT(mat_load(big_m,NULL,latan_path));
-    USTAT(mat_get_subm(m,big_m,k1,l1,k2,l2));
-    
-    mat_destroy(big_m);
+    if ((k2 < k1)||(l2 < l1))
+    {
+        LATAN_ERROR("invalid sub-matrix dimensions",LATAN_EBADLEN);
+    }
+    if ((k2-k1+1 != nrow(m))||(l2-l1+1 != ncol(m)))
+    {
+        LATAN_ERROR("sub-matrix and destination matrix dimensions do not match"\
+                    ,LATAN_EBADLEN);
+    }
+    FUNC_INIT(fname,elname);
+    status = mat_load_subm_pt(m,fname,elname,k1,l1);
     
     return status;
 }
 
+/* the bins are loaded concurrently, each thread reading the files of a bin
+ * through its own I/O file buffer and accumulating them directly in the
+ * binned matrix (in the same order as mat_mean), so the unbinned data are
+ * never stored */
 latan_errno mat_ar_loadbin(mat **m, size_t *dim, const strbuf man_fname,\
                            const strbuf m_name, const size_t binsize)
 {
     latan_errno status;
-    strbuf *field,latan_path;
-    mat **m_prebin;
-    size_t nf,lc,nmat;
+    strbuf *field,*flist,latan_path;
+    size_t nf,lc,nfile,nbin;
     size_t i;
+#ifdef _OPENMP
+    int nthread;
+#endif
     
     status = LATAN_SUCCESS;
     i      = 0;
-    nmat   = get_nfile(man_fname);
+    nfile  = (size_t)(get_nfile(man_fname));
     field  = NULL;
 
-    m_prebin = (m) ? mat_ar_create_from_dim(nmat,m[0]) : NULL;
-    
+    if (nfile == 0)
+    {
+        strbuf errmsg;
+        
+        sprintf(errmsg,"no file listed in manifest %s",man_fname);
+        LATAN_ERROR(errmsg,LATAN_EINVAL);
+    }
+    if ((m)&&(binsize == 0))
+    {
+        LATAN_ERROR("zero bin size",LATAN_EINVAL);
+    }
+    MALLOC(flist,strbuf *,nfile);
     BEGIN_FOR_LINE_TOK(field,man_fname," \t",nf,lc)
     {
-        if (field[0][0] != '#')
+        if ((field[0][0] != '#')&&(i < nfile))
         {
-            sprintf(latan_path,"%s%c%s",field[0],LATAN_PATH_SEP,m_name);
-            if (m)
+            strbufcpy(flist[i],field[0]);
+            i++;
+        }
+    }
+    END_FOR_LINE_TOK(field)
+    if (!m)
+    {
+        sprintf(latan_path,"%s%c%s",flist[0],LATAN_PATH_SEP,m_name);
+        USTAT(mat_load(NULL,dim,latan_path));
+        FREE(flist);
+        
+        return status;
+    }
+    nbin = (nfile + binsize - 1)/binsize;
+    io_init();
+#ifdef _OPENMP
+    nthread = (env.nthread > 0) ? env.nthread : omp_get_max_threads();
+    #pragma omp parallel num_threads(nthread)
+#endif
+    {
+        mat *buf;
+        strbuf path;
+        long lb;
+        size_t j,bsize;
+        latan_errno tstatus,lstatus;
+        
+        tstatus = LATAN_SUCCESS;
+        buf     = mat_create_from_dim(m[0]);
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (lb=0;lb<(long)(nbin);lb++)
+        {
+            bsize = MIN(binsize,nfile-(size_t)(lb)*binsize);
+            mat_zero(m[lb]);
+            for (j=0;j<bsize;j++)
             {
-                USTAT(mat_load(m_prebin[i],dim,latan_path));
+                sprintf(path,"%s%c%s",flist[(size_t)(lb)*binsize+j],\
+                        LATAN_PATH_SEP,m_name);
+                lstatus = mat_load(buf,NULL,path);
+                /* buf is not valid, the rest of the bin is skipped */
+                if (lstatus != LATAN_SUCCESS)
+                {
+                    LATAN_UPDATE_STATUS(tstatus,lstatus);
+                    break;
+                }
+                LATAN_UPDATE_STATUS(tstatus,mat_eqadd(m[lb],buf));
             }
-            else
+            if (j == bsize)
             {
-                USTAT(mat_load(NULL,dim,latan_path));
-                break;
+                LATAN_UPDATE_STATUS(tstatus,\
+                                    mat_eqmuls(m[lb],1.0/(double)(bsize)));
             }
-            i++;
+        }
+        mat_destroy(buf);
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        {
+            USTAT(tstatus);
         }
     }
-    END_FOR_LINE_TOK(field)
-    if (m)
+    FREE(flist);
+    /* mat_load fails on files with dimensions different from m[0] */
+    if (dim)
     {
-        USTAT(mat_ar_bin(m,m_prebin,nmat,binsize));
-        mat_ar_destroy(m_prebin,nmat);
+        dim[0] = nrow(m[0]);
+        dim[1] = ncol(m[0]);
     }
     
     return status;
@@ -384,6 +517,103 @@ latan_errno randgen_load_state(rg_state state, const strbuf latan_path)
     return status;
 }
 
+/*                        seeded resampled sample                           */
+/****************************************************************************/
+latan_errno rs_sample_seed(rs_sample *s, rs_seed *sd, const strbuf man_fname,\
+                           const strbuf m_name, const size_t binsize,       \
+                           const unsigned long seed)
+{
+    strbufcpy(sd->man_fname,man_fname);
+    strbufcpy(sd->m_name,m_name);
+    sd->binsize = binsize;
+    sd->nsample = rs_sample_get_nsample(s);
+    sd->dim[0]  = nrow(rs_sample_pt_cent_val(s));
+    sd->dim[1]  = ncol(rs_sample_pt_cent_val(s));
+    sd->seed    = seed;
+    
+    return rs_sample_from_seed(s,sd);
+}
+
+latan_errno rs_sample_from_seed(rs_sample *s, const rs_seed *sd)
+{
+    latan_errno status;
+    mat **dat;
+    size_t dim[2],ndat;
+    
+    status = LATAN_SUCCESS;
+    
+    if (sd->binsize == 0)
+    {
+        LATAN_ERROR("seeded sample with zero bin size",LATAN_EINVAL);
+    }
+    if (rs_sample_get_nsample(s) != sd->nsample)
+    {
+        LATAN_ERROR("sample number mismatch",LATAN_EBADLEN);
+    }
+    if ((nrow(rs_sample_pt_cent_val(s)) != sd->dim[0])||\
+        (ncol(rs_sample_pt_cent_val(s)) != sd->dim[1]))
+    {
+        LATAN_ERROR("sample dimension mismatch",LATAN_EBADLEN);
+    }
+    ndat = (size_t)(get_nfile(sd->man_fname));
+    ndat = (ndat + sd->binsize - 1)/sd->binsize;
+    USTAT(mat_ar_loadbin(NULL,dim,sd->man_fname,sd->m_name,sd->binsize));
+    if ((dim[0] != sd->dim[0])||(dim[1] != sd->dim[1]))
+    {
+        strbuf errmsg;
+        sprintf(errmsg,"seeded sample source data dimension mismatch (%s)",\
+                sd->man_fname);
+        LATAN_ERROR(errmsg,LATAN_EBADLEN);
+    }
+    dat = mat_ar_create(ndat,dim[0],dim[1]);
+    USTAT(mat_ar_loadbin(dat,NULL,sd->man_fname,sd->m_name,sd->binsize));
+    USTAT(resample_seeded(s,dat,ndat,&rs_mean,NULL,sd->seed));
+    
+    mat_ar_destroy(dat,ndat);
+    
+    return status;
+}
+
+latan_errno rs_sample_from_seed_subsamp(rs_sample *s, const rs_seed *sd,\
+                                        const size_t k1, const size_t l1)
+{
+    latan_errno status;
+    rs_sample *big_s;
+    
+    status = LATAN_SUCCESS;
+    
+    if ((k1 + nrow(rs_sample_pt_cent_val(s)) > sd->dim[0])||\
+        (l1 + ncol(rs_sample_pt_cent_val(s)) > sd->dim[1]))
+    {
+        LATAN_ERROR("invalid sub-matrix dimensions",LATAN_EBADLEN);
+    }
+    big_s = rs_sample_create(sd->dim[0],sd->dim[1],rs_sample_get_nsample(s));
+    USTAT(rs_sample_from_seed(big_s,sd));
+    USTAT(rs_sample_get_subsamp(s,big_s,k1,l1,                      \
+                                k1+nrow(rs_sample_pt_cent_val(s))-1,\
+                                l1+ncol(rs_sample_pt_cent_val(s))-1));
+    
+    rs_sample_destroy(big_s);
+    
+    return status;
+}
+
+latan_errno rs_sample_save_seed(const strbuf latan_path, const char mode,\
+                                const rs_seed *sd)
+{
+    latan_errno status;
+    strbuf fname,elname;
+    
+    FUNC_INIT(fname,elname);
+    if (strlen(elname) == 0)
+    {
+        LATAN_ERROR("no name specified",LATAN_EINVAL);
+    }
+    status = rs_seed_save_pt(fname,mode,sd,elname);
+    
+    return status;
+}
+
 /*                          resampled sample I/O                            */
 /****************************************************************************/
 latan_errno rs_sample_save(const strbuf latan_path, const char mode,\
@@ -465,24 +695,26 @@ latan_errno rs_sample_load(rs_sample *s, size_t *nsample, size_t *dim,\
     return status;
 }
 
+/* same as mat_load_subm for each matrix of the sample */
 latan_errno rs_sample_load_subsamp(rs_sample *s, const strbuf latan_path,\
                                    const size_t k1, const size_t l1,     \
                                    const size_t k2, const size_t l2)
 {
     latan_errno status;
-    rs_sample *big_s;
-    size_t dim[2],nsample;
-    
-    status  = LATAN_SUCCESS;
-    dim[0]  = nrow(rs_sample_pt_cent_val(s));
-    dim[1]  = ncol(rs_sample_pt_cent_val(s));
-    nsample = rs_sample_get_nsample(s);
-    
-    big_s = rs_sample_create(dim[0],dim[1],nsample);
-    USTAT(rs_sample_load(big_s,NULL,NULL,latan_path));
-    USTAT(rs_sample_get_subsamp(s,big_s,k1,l1,k2,l2));
+    strbuf fname,elname;
     
-    rs_sample_destroy(big_s);
+    if ((k2 < k1)||(l2 < l1))
+    {
+        LATAN_ERROR("invalid sub-matrix dimensions",LATAN_EBADLEN);
+    }
+    if ((k2-k1+1 != nrow(rs_sample_pt_cent_val(s)))||\
+        (l2-l1+1 != ncol(rs_sample_pt_cent_val(s))))
+    {
+        LATAN_ERROR("sub-matrix and destination matrix dimensions do not match"\
+                    ,LATAN_EBADLEN);
+    }
+    FUNC_INIT(fname,elname);
+    status = rs_sample_load_subsamp_pt(s,fname,elname,k1,l1);
     
     return status;
 }
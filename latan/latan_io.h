@@ -61,7 +61,7 @@
 
 #define _FOPEN_NOERRET(f,fname,mode)\
 {\
-    f = fopen(fname,mode);\
+    f = io_fopen(fname,mode);\
     if (f == NULL)\
     {\
         strbuf _errmsg;\
@@ -144,12 +144,29 @@ __BEGIN_DECLS
 typedef enum
 {
     IO_XML   = 0,\
-    IO_ASCII = 1 \
+    IO_ASCII = 1,\
+    IO_BIN   = 2 \
 } io_fmt_no;
 
 latan_errno io_set_fmt(const io_fmt_no fmt);
 io_fmt_no io_get_fmt(void);
 
+/* number of threads loading the files of a manifest (0: OpenMP default) */
+void io_set_nthread(const int nthread);
+int io_get_nthread(void);
+
+/* XML matrix encoding (false: one text element per number, true: base64
+ * string of the little-endian row-major data), both are readable */
+void io_set_xml_base64(const bool is_b64);
+bool io_get_xml_base64(void);
+
+/* file opening */
+/** files whose name ends with .gz or .zst are (de)compressed on the fly,
+ *  such a stream is either read-only or write-only ('+' in mode is ignored)
+ *  and positioning it backward restarts the decompression **/
+FILE * io_fopen(const char *fname, const char *mode);
+size_t io_zip_ext_len(const char *fname);
+
 /* I/O init/finish */
 void io_init(void);
 void io_finish(void);
@@ -160,6 +177,8 @@ void get_firstfname(strbuf fname, const strbuf manifestfname);
 void get_elname(strbuf fname, strbuf elname, const strbuf latan_path);
 
 /* mat I/O */
+/** if fmt is NULL, the shortest strings converted back exactly by strtod
+ *  are written **/
 void mat_dump(FILE* stream, const mat *m, const strbuf fmt);
 #define mat_print(m,fmt) mat_dump(stdout,m,fmt)
 latan_errno mat_save(const strbuf latan_path, const char mode, const mat *m);
@@ -177,6 +196,35 @@ latan_errno randgen_save_state(const strbuf latan_path, const char mode,\
                                const rg_state state);
 latan_errno randgen_load_state(rg_state state, const strbuf latan_path);
 
+/* seeded resampled sample */
+/** only the recipe of a bootstrap sample of the mean is stored (manifest of
+ *  the source files, matrix name, bin size, counter-based resampling seed,
+ *  number of samples and matrix dimensions), the samples are regenerated
+ *  from the source data when the element is loaded with rs_sample_load ;
+ *  rs_sample_seed generates a sample and records its recipe at the same
+ *  time, a recipe filled by hand is only guaranteed to match a sample
+ *  generated by rs_sample_from_seed ; the content of the source files is
+ *  not recorded, modifying them changes the regenerated samples **/
+typedef struct
+{
+    strbuf man_fname;
+    strbuf m_name;
+    size_t binsize;
+    size_t nsample;
+    size_t dim[2];
+    unsigned long seed;
+} rs_seed;
+
+latan_errno rs_sample_seed(rs_sample *s, rs_seed *sd, const strbuf man_fname,\
+                           const strbuf m_name, const size_t binsize,       \
+                           const unsigned long seed);
+latan_errno rs_sample_from_seed(rs_sample *s, const rs_seed *sd);
+/** sub-sample of the size of s starting at row k1 and column l1 **/
+latan_errno rs_sample_from_seed_subsamp(rs_sample *s, const rs_seed *sd,\
+                                        const size_t k1, const size_t l1);
+latan_errno rs_sample_save_seed(const strbuf latan_path, const char mode,\
+                                const rs_seed *sd);
+
 /* resampled sample I/O */
 latan_errno rs_sample_save(const strbuf latan_path, const char mode,\
                            const rs_sample *s);
@@ -17,7 +17,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
-#define _POSIX_C_SOURCE 199506L /* strtok_r is used here */
+#define _POSIX_C_SOURCE 199506L /* fileno is used here */
 
 #ifndef LATAN_COMMENT
 #define LATAN_COMMENT "#L"
@@ -37,45 +37,102 @@
 #ifndef LATAN_RS_SAMPLE
 #define LATAN_RS_SAMPLE "rs_sample"
 #endif
+#ifndef LATAN_RS_SEED
+#define LATAN_RS_SEED "rs_seed"
+#endif
 
 #include <latan/latan_io_ascii.h>
 #include <latan/latan_includes.h>
 #include <latan/latan_io.h>
+#include <sys/stat.h>
+
+typedef enum
+{
+    ASCII_NONE      = 0,\
+    ASCII_MAT       = 1,\
+    ASCII_RG_STATE  = 2,\
+    ASCII_RS_SAMPLE = 3
+} ascii_obj_no;
 
 static latan_errno ascii_open_file_buf(const strbuf fname, const char mode);
+static void ascii_rewind(const int thread, const long offset);
+static char * ascii_get_line(long *offset, const int thread);
+static latan_errno ascii_tokenize(size_t *nf, const int thread, char *line);
+static bool ascii_strtod(double *x, const char *str);
+static ascii_obj_no ascii_obj_type(const char *type);
+static bool ascii_build_index(const int thread);
+static void ascii_seek(int *lc, const int thread, const ascii_obj_no type,\
+                       const strbuf name);
 
 /*                       file buffer management (internal)                  */
 /****************************************************************************/
+/* index entry of a top-level object : position and line count of its
+ * "latan_begin" line */
+typedef struct
+{
+    ascii_obj_no type;
+    long offset;
+    int lc;
+    strbuf name;
+} ascii_obj;
+
+/* in read mode the file is read by large blocks in rbuf, lines are
+ * returned as pointers in this buffer and split in place into fields */
 typedef struct
 {
     FILE *f;
     strbuf fname;
     char mode;
+    char *rbuf;
+    size_t rbuf_size,rbuf_len,rbuf_pos;
+    long rbuf_offset;
+    char **field;
+    size_t nfield_alloc;
+    ascii_obj *index;
+    size_t nobj,nobj_alloc;
+    bool has_index;
+    off_t size;
+    time_t mtime;
+    ino_t ino;
+    unsigned long nwrite;
 } ascii_file;
 
+/* nwrite counts the files opened for writing by this process, an index is
+ * only reused if nothing was written since it was built, since a file
+ * rewritten within the same second with the same size has the same stat */
 typedef struct
 {
     ascii_file *ascii_buf;
     bool *file_is_loaded;
     int nfile;
+    unsigned long nwrite;
 } io_ascii_env;
 
 static io_ascii_env env =
 {
     NULL,\
     NULL,\
+    0,   \
     0    \
 };
 
 #define FILE_BUF(thread)  env.ascii_buf[thread].f
 #define FILE_NAME(thread) env.ascii_buf[thread].fname
 #define FILE_MODE(thread) env.ascii_buf[thread].mode
+#define FILE_IND(thread)  env.ascii_buf[thread]
+#define FIELD(thread)     env.ascii_buf[thread].field
+
+#ifndef ASCII_RBUF_SIZE
+#define ASCII_RBUF_SIZE (1 << 20)
+#endif
 
 static latan_errno ascii_open_file_buf(const strbuf fname, const char mode)
 {
     latan_errno status;
     strbuf smode,errmsg;
+    struct stat st;
     int nthread,thread,i;
+    bool is_replaced;
 
 #ifdef _OPENMP
     nthread = omp_get_num_threads();
@@ -113,40 +170,434 @@ static latan_errno ascii_open_file_buf(const strbuf fname, const char mode)
                             nthread);
             for (i=env.nfile;i<nthread;i++)
             {
-                env.file_is_loaded[i] = false;
+                env.file_is_loaded[i]  = false;
                 strbufcpy(FILE_NAME(i),"");
-                FILE_BUF(i)           = NULL;
-                FILE_MODE(i)          = '\0';
+                FILE_BUF(i)            = NULL;
+                FILE_MODE(i)           = '\0';
+                FILE_IND(i).rbuf         = NULL;
+                FILE_IND(i).rbuf_size    = 0;
+                FILE_IND(i).field        = NULL;
+                FILE_IND(i).nfield_alloc = 0;
+                FILE_IND(i).index        = NULL;
+                FILE_IND(i).nobj         = 0;
+                FILE_IND(i).nobj_alloc   = 0;
+                FILE_IND(i).has_index    = false;
             }
             env.nfile = nthread;
         }
     }
+    if (mode != 'r')
+    {
+#ifdef _OPENMP
+        #pragma omp atomic
+#endif
+        env.nwrite++;
+    }
     if (env.file_is_loaded[thread])
     {
+        /* a file replaced since it was opened is opened again */
+        is_replaced = (mode == 'r')&&((stat(fname,&st) != 0)||\
+                                      (st.st_ino != FILE_IND(thread).ino));
         if ((strbufcmp(FILE_NAME(thread),fname) != 0)||(mode == 'w')||\
-            (mode != FILE_MODE(thread)))
+            (mode != FILE_MODE(thread))||is_replaced)
         {
             fclose(FILE_BUF(thread));
+            env.file_is_loaded[thread] = false;
             FOPEN(FILE_BUF(thread),fname,smode);
+            FILE_IND(thread).ino = (stat(fname,&st) == 0) ? st.st_ino : 0;
             strbufcpy(FILE_NAME(thread),fname);
-            FILE_MODE(thread) = mode;
+            FILE_MODE(thread)          = mode;
+            FILE_IND(thread).has_index = false;
+            env.file_is_loaded[thread] = true;
+            ascii_rewind(thread,0);
         }
         else if (mode == 'r')
         {
-            rewind(FILE_BUF(thread));
+            ascii_rewind(thread,0);
         }
     }
     else
     {
         FOPEN(FILE_BUF(thread),fname,smode);
+        FILE_IND(thread).ino = (stat(fname,&st) == 0) ? st.st_ino : 0;
         strbufcpy(FILE_NAME(thread),fname);
-        FILE_MODE(thread) = mode;
+        FILE_MODE(thread)          = mode;
+        FILE_IND(thread).has_index = false;
         env.file_is_loaded[thread] = true;
+        ascii_rewind(thread,0);
     }
 
     return status;
 }
 
+/*                          line reading (internal)                         */
+/****************************************************************************/
+static void ascii_rewind(const int thread, const long offset)
+{
+    ascii_file *af;
+
+    af = &(FILE_IND(thread));
+    if (af->mode == 'r')
+    {
+        fseek(af->f,offset,SEEK_SET);
+    }
+    af->rbuf_len    = 0;
+    af->rbuf_pos    = 0;
+    af->rbuf_offset = offset;
+}
+
+/* return the next line (without the end of line character), NULL at the end
+ * of the file ; the line is valid until the next call */
+static char * ascii_get_line(long *offset, const int thread)
+{
+    ascii_file *af;
+    char *line,*eol;
+    size_t nread;
+
+    af = &(FILE_IND(thread));
+    while (true)
+    {
+        if (af->rbuf_pos < af->rbuf_len)
+        {
+            line = af->rbuf + af->rbuf_pos;
+            eol  = (char *)memchr(line,'\n',af->rbuf_len - af->rbuf_pos);
+            if (eol != NULL)
+            {
+                *eol = '\0';
+                if (offset)
+                {
+                    *offset = af->rbuf_offset + (long)(af->rbuf_pos);
+                }
+                af->rbuf_pos = (size_t)(eol - af->rbuf) + 1;
+
+                return line;
+            }
+        }
+        if (feof(af->f)||ferror(af->f))
+        {
+            if (af->rbuf_pos < af->rbuf_len)
+            {
+                line                   = af->rbuf + af->rbuf_pos;
+                af->rbuf[af->rbuf_len] = '\0';
+                if (offset)
+                {
+                    *offset = af->rbuf_offset + (long)(af->rbuf_pos);
+                }
+                af->rbuf_pos = af->rbuf_len;
+
+                return line;
+            }
+            else
+            {
+                return NULL;
+            }
+        }
+        /* keep the incomplete line at the beginning of the buffer, grow the
+         * buffer if the line is longer than it, and read the next block */
+        if (af->rbuf_pos > 0)
+        {
+            memmove(af->rbuf,af->rbuf + af->rbuf_pos,\
+                    af->rbuf_len - af->rbuf_pos);
+            af->rbuf_offset += (long)(af->rbuf_pos);
+            af->rbuf_len    -= af->rbuf_pos;
+            af->rbuf_pos     = 0;
+        }
+        if (af->rbuf_len + 1 >= af->rbuf_size)
+        {
+            af->rbuf_size = (af->rbuf_size == 0) ? ASCII_RBUF_SIZE :\
+                            2*af->rbuf_size;
+            REALLOC_ERRVAL(af->rbuf,af->rbuf,char *,af->rbuf_size,NULL);
+        }
+        nread         = fread(af->rbuf + af->rbuf_len,1,\
+                              af->rbuf_size - af->rbuf_len - 1,af->f);
+        af->rbuf_len += nread;
+    }
+}
+
+/* split the line in place into space separated fields, the fields are stored
+ * in FIELD(thread) */
+static latan_errno ascii_tokenize(size_t *nf, const int thread, char *line)
+{
+    ascii_file *af;
+    char *pt;
+
+    af  = &(FILE_IND(thread));
+    *nf = 0;
+    pt  = line;
+    while (true)
+    {
+        while (*pt == ' ')
+        {
+            pt++;
+        }
+        if (*pt == '\0')
+        {
+            break;
+        }
+        if (*nf == af->nfield_alloc)
+        {
+            af->nfield_alloc = (af->nfield_alloc == 0) ? 16 :\
+                               2*af->nfield_alloc;
+            REALLOC(af->field,af->field,char **,af->nfield_alloc);
+        }
+        af->field[*nf] = pt;
+        (*nf)++;
+        while ((*pt != ' ')&&(*pt != '\0'))
+        {
+            pt++;
+        }
+        if (*pt == '\0')
+        {
+            break;
+        }
+        *pt = '\0';
+        pt++;
+    }
+    /* lines containing only blank characters are ignored */
+    if ((*nf == 1)&&(strspn(af->field[0]," \t\r") == strlen(af->field[0])))
+    {
+        *nf = 0;
+    }
+
+    return LATAN_SUCCESS;
+}
+
+/* locale independent conversion of a whole field to a double : numbers with
+ * at most 16 significant digits whose integer mantissa and power of 10 are
+ * exactly representable are converted with a single correctly rounded
+ * floating point operation (it is the case of most numbers written by
+ * mat_dump), the other ones are converted by strtod */
+static const double ascii_pow10[] =
+{
+    1.0e0 ,1.0e1 ,1.0e2 ,1.0e3 ,1.0e4 ,1.0e5 ,1.0e6 ,1.0e7 ,1.0e8 ,1.0e9 ,\
+    1.0e10,1.0e11,1.0e12,1.0e13,1.0e14,1.0e15,1.0e16,1.0e17,1.0e18,1.0e19,\
+    1.0e20,1.0e21,1.0e22
+};
+
+#define ASCII_MAX_DIG   16
+#define ASCII_MAX_POW10 22
+#define ASCII_MAX_MANT  9007199254740992.0
+
+static bool ascii_strtod(double *x, const char *str)
+{
+    const char *pt;
+    char *end;
+    double m,sign;
+    int e,e_exp,e_sign,nd,ndig;
+
+    pt   = str;
+    sign = 1.0;
+    m    = 0.0;
+    e    = 0;
+    nd   = 0;
+    ndig = 0;
+    if ((*pt == '-')||(*pt == '+'))
+    {
+        sign = (*pt == '-') ? -1.0 : 1.0;
+        pt++;
+    }
+    for (;(*pt >= '0')&&(*pt <= '9');pt++)
+    {
+        ndig++;
+        if ((nd > 0)||(*pt != '0'))
+        {
+            m = 10.0*m + (double)(*pt - '0');
+            nd++;
+        }
+    }
+    if (*pt == '.')
+    {
+        pt++;
+        for (;(*pt >= '0')&&(*pt <= '9');pt++)
+        {
+            ndig++;
+            if ((nd > 0)||(*pt != '0'))
+            {
+                m = 10.0*m + (double)(*pt - '0');
+                nd++;
+            }
+            e--;
+        }
+    }
+    if ((ndig > 0)&&((*pt == 'e')||(*pt == 'E')))
+    {
+        pt++;
+        e_sign = 1;
+        e_exp  = 0;
+        if ((*pt == '-')||(*pt == '+'))
+        {
+            e_sign = (*pt == '-') ? -1 : 1;
+            pt++;
+        }
+        if ((*pt < '0')||(*pt > '9'))
+        {
+            ndig = 0;
+        }
+        for (;(*pt >= '0')&&(*pt <= '9');pt++)
+        {
+            if (e_exp < 10000)
+            {
+                e_exp = 10*e_exp + (*pt - '0');
+            }
+        }
+        e += e_sign*e_exp;
+    }
+    if ((ndig > 0)&&(*pt == '\0')&&(nd <= ASCII_MAX_DIG))
+    {
+        if (nd == 0)
+        {
+            *x = sign*0.0;
+
+            return true;
+        }
+        else if ((m < ASCII_MAX_MANT)&&(e >= -ASCII_MAX_POW10)\
+                 &&(e <= ASCII_MAX_POW10))
+        {
+            *x = (e < 0) ? sign*(m/ascii_pow10[-e]) : sign*(m*ascii_pow10[e]);
+
+            return true;
+        }
+    }
+    *x = strtod(str,&end);
+
+    return (end != str);
+}
+
+/*                     object index management (internal)                   */
+/****************************************************************************/
+/* the first named lookup in a file opened for reading builds, in a single
+ * pass, an index of the top-level objects ; the next lookups in the same file
+ * seek directly to the object. The index is rebuilt if the file is reopened
+ * or if its size or modification time changed. */
+static ascii_obj_no ascii_obj_type(const char *type)
+{
+    if (strbufcmp(type,LATAN_MAT) == 0)
+    {
+        return ASCII_MAT;
+    }
+    else if (strbufcmp(type,LATAN_RG_STATE) == 0)
+    {
+        return ASCII_RG_STATE;
+    }
+    else if (strbufcmp(type,LATAN_RS_SAMPLE) == 0)
+    {
+        return ASCII_RS_SAMPLE;
+    }
+    else
+    {
+        return ASCII_NONE;
+    }
+}
+
+static bool ascii_build_index(const int thread)
+{
+    ascii_file *af;
+    char *line;
+    char **field;
+    long offset;
+    int lc,depth;
+    size_t nf;
+    ascii_obj_no type;
+
+    af       = &(FILE_IND(thread));
+    af->nobj = 0;
+    lc       = 0;
+    depth    = 0;
+    ascii_rewind(thread,0);
+    while ((line = ascii_get_line(&offset,thread)) != NULL)
+    {
+        lc++;
+        if (strncmp(line,LATAN_COMMENT,strlen(LATAN_COMMENT)) != 0)
+        {
+            continue;
+        }
+        if (ascii_tokenize(&nf,thread,line) != LATAN_SUCCESS)
+        {
+            return false;
+        }
+        field = FIELD(thread);
+        if ((nf < 3)||(strbufcmp(field[0],LATAN_COMMENT) != 0))
+        {
+            continue;
+        }
+        if (strbufcmp(field[1],LATAN_BEGIN) == 0)
+        {
+            type = ascii_obj_type(field[2]);
+            if ((depth == 0)&&(type != ASCII_NONE)&&(nf >= 4))
+            {
+                if (af->nobj == af->nobj_alloc)
+                {
+                    af->nobj_alloc = (af->nobj_alloc == 0) ? 16 :\
+                                     2*af->nobj_alloc;
+                    REALLOC_ERRVAL(af->index,af->index,ascii_obj *,\
+                                   af->nobj_alloc,false);
+                }
+                af->index[af->nobj].type   = type;
+                af->index[af->nobj].offset = offset;
+                af->index[af->nobj].lc     = lc - 1;
+                strbufcpy(af->index[af->nobj].name,field[3]);
+                af->nobj++;
+            }
+            depth++;
+        }
+        else if ((strbufcmp(field[1],LATAN_END) == 0)&&(depth > 0))
+        {
+            depth--;
+        }
+    }
+    af->has_index = true;
+
+    return true;
+}
+
+/* position the file buffer on the top-level object of given type and name if
+ * it is indexed, at the beginning of the file otherwise */
+static void ascii_seek(int *lc, const int thread, const ascii_obj_no type,\
+                       const strbuf name)
+{
+    ascii_file *af;
+    struct stat st;
+    size_t i;
+    unsigned long nwrite;
+
+    af  = &(FILE_IND(thread));
+    *lc = 0;
+#ifdef _OPENMP
+    #pragma omp flush
+#endif
+    nwrite = env.nwrite;
+    if ((strlen(name) == 0)||(af->mode != 'r')||\
+        (fstat(fileno(af->f),&st) != 0))
+    {
+        ascii_rewind(thread,0);
+        return;
+    }
+    if ((!af->has_index)||(af->size != st.st_size)||\
+        (af->mtime != st.st_mtime)||(af->nwrite != nwrite))
+    {
+        af->size   = st.st_size;
+        af->mtime  = st.st_mtime;
+        af->nwrite = nwrite;
+        if (!ascii_build_index(thread))
+        {
+            af->has_index = false;
+            ascii_rewind(thread,0);
+            return;
+        }
+    }
+    for (i=0;i<af->nobj;i++)
+    {
+        if ((af->index[i].type == type)&&\
+            (strbufcmp(af->index[i].name,name) == 0))
+        {
+            *lc = af->index[i].lc;
+            ascii_rewind(thread,af->index[i].offset);
+            return;
+        }
+    }
+    ascii_rewind(thread,0);
+}
+
 /*                              I/O init/finish                             */
 /****************************************************************************/
 void io_init_ascii(void)
@@ -179,47 +630,61 @@ void io_finish_ascii(void)
             strbufcpy(FILE_NAME(i),"");
             env.file_is_loaded[i] = false;
         }
+        FREE(FILE_IND(i).rbuf);
+        FREE(FILE_IND(i).field);
+        FREE(FILE_IND(i).index);
     }
     FREE(env.ascii_buf);
     FREE(env.file_is_loaded);
+    env.nfile = 0;
 }
 
 /*                   parsing kernel declarations                            */
 /****************************************************************************/
+/* if sub is not NULL, only the sub-block of the size of the destination
+ * matrix starting at row sub[0] and column sub[1] is converted */
 typedef struct mat_ker_state_s
 {
     int j,nr,nc;
     bool got_ncol;
+    const size_t *sub;
 } mat_ker_state;
 
 typedef struct rs_sample_ker_state_s
 {
     int ns,i;
-    bool got_ns;
+    bool got_ns,in_seed,got_seed;
     strbuf read_name,sname;
     mat *pt;
     mat_ker_state sampks;
+    rs_seed sd;
 } rs_sample_ker_state;
 
 static latan_errno mat_load_ascii_ker(mat *m, size_t *dim, const strbuf fname,\
-                                      const strbuf name, strbuf *field,       \
+                                      const strbuf name, char **field,        \
                                       const size_t nf, const int lc,          \
                                       bool *is_inmat, bool *is_end,           \
                                       mat_ker_state *ks);
 static latan_errno randgen_load_state_ascii_ker(rg_state state,                \
                                                 const strbuf fname,            \
                                                 const strbuf name,             \
-                                                strbuf *field, const size_t nf,\
+                                                char **field, const size_t nf, \
                                                 const int lc, bool *is_inrgs,  \
                                                 bool *is_end,                  \
                                                 int *j);
 static latan_errno rs_sample_load_ascii_ker(rs_sample *s, size_t *nsample,    \
                                             size_t *dim, const strbuf fname,  \
-                                            const strbuf name, strbuf *field, \
+                                            const strbuf name, char **field,  \
                                             const size_t nf, const int lc,    \
                                             bool *is_inrss, bool *is_end,     \
                                             bool *is_insamp, bool *is_sampend,\
                                             rs_sample_ker_state *ks);
+static latan_errno mat_load_ascii_gen(mat *m, size_t *dim, const strbuf fname,\
+                                      const strbuf name, const size_t *sub);
+static latan_errno rs_sample_load_ascii_gen(rs_sample *s, size_t *nsample,   \
+                                            size_t *dim, const strbuf fname, \
+                                            const strbuf name,               \
+                                            const size_t *sub);
 
 /*                             mat I/O                                      */
 /****************************************************************************/
@@ -245,7 +710,7 @@ latan_errno mat_save_ascii(const strbuf fname, const char mode, const mat *m,\
     fprintf(FILE_BUF(thread),"%s %s %s %s\n",LATAN_COMMENT,LATAN_BEGIN,\
             LATAN_MAT,name);
     fprintf(FILE_BUF(thread),"%lu\n",(long unsigned int)ncol(m));
-    mat_dump(FILE_BUF(thread),m,"% .15e");
+    mat_dump(FILE_BUF(thread),m,NULL);
     fprintf(FILE_BUF(thread),"%s %s %s\n",LATAN_COMMENT,LATAN_END,LATAN_MAT);
     
     return LATAN_SUCCESS;
@@ -253,10 +718,28 @@ latan_errno mat_save_ascii(const strbuf fname, const char mode, const mat *m,\
 
 latan_errno mat_load_ascii(mat *m, size_t *dim, const strbuf fname,\
                            const strbuf name)
+{
+    return mat_load_ascii_gen(m,dim,fname,name,NULL);
+}
+
+latan_errno mat_load_subm_ascii(mat *m, const strbuf fname, const strbuf name,\
+                                const size_t k1, const size_t l1)
+{
+    size_t sub[2];
+    
+    sub[0] = k1;
+    sub[1] = l1;
+    
+    return mat_load_ascii_gen(m,NULL,fname,name,sub);
+}
+
+static latan_errno mat_load_ascii_gen(mat *m, size_t *dim, const strbuf fname,\
+                                      const strbuf name, const size_t *sub)
 {
     latan_errno status;
-    int thread,nf,lc;
-    strbuf *field;
+    int thread,lc;
+    size_t nf;
+    char *line;
     bool is_inmat,is_end;
     mat_ker_state ks;
     
@@ -266,21 +749,31 @@ latan_errno mat_load_ascii(mat *m, size_t *dim, const strbuf fname,\
     thread = 0;
 #endif
     status   = LATAN_SUCCESS;
-    field    = NULL;
     is_inmat = false;
     is_end   = false;
+    ks.sub   = sub;
     
-    ascii_open_file_buf(fname,'r');
-    BEGIN_FOR_LINE_TOK_F(field,FILE_BUF(thread)," ",nf,lc)
+    status = ascii_open_file_buf(fname,'r');
+    if (status != LATAN_SUCCESS)
     {
-        USTAT(mat_load_ascii_ker(m,dim,fname,name,field,nf,lc,&is_inmat,\
-                                 &is_end,&ks));
+        return status;
+    }
+    ascii_seek(&lc,thread,ASCII_MAT,name);
+    while ((line = ascii_get_line(NULL,thread)) != NULL)
+    {
+        lc++;
+        USTAT(ascii_tokenize(&nf,thread,line));
+        if (nf == 0)
+        {
+            continue;
+        }
+        USTAT(mat_load_ascii_ker(m,dim,fname,name,FIELD(thread),nf,lc,\
+                                 &is_inmat,&is_end,&ks));
         if (is_end)
         {
             break;
         }
     }
-    END_FOR_LINE_TOK_F(field);
     if (!is_end)
     {
         strbuf errmsg,buf;
@@ -347,8 +840,9 @@ latan_errno randgen_load_state_ascii(rg_state state, const strbuf fname,\
                                      const strbuf name)
 {
     latan_errno status;
-    int thread,nf,lc;
-    strbuf *field;
+    int thread,lc;
+    size_t nf;
+    char *line;
     bool is_inrgs,is_end;
     int j;
 
@@ -358,22 +852,31 @@ latan_errno randgen_load_state_ascii(rg_state state, const strbuf fname,\
     thread = 0;
 #endif
     status   = LATAN_SUCCESS;
-    field    = NULL;
     is_inrgs = false;
     is_end   = false;
     j        = 0;
 
-    ascii_open_file_buf(fname,'r');
-    BEGIN_FOR_LINE_TOK_F(field,FILE_BUF(thread)," ",nf,lc)
+    status = ascii_open_file_buf(fname,'r');
+    if (status != LATAN_SUCCESS)
     {
-        USTAT(randgen_load_state_ascii_ker(state,fname,name,field,nf,lc,\
-                                           &is_inrgs,&is_end,&j));
+        return status;
+    }
+    ascii_seek(&lc,thread,ASCII_RG_STATE,name);
+    while ((line = ascii_get_line(NULL,thread)) != NULL)
+    {
+        lc++;
+        USTAT(ascii_tokenize(&nf,thread,line));
+        if (nf == 0)
+        {
+            continue;
+        }
+        USTAT(randgen_load_state_ascii_ker(state,fname,name,FIELD(thread),\
+                                           nf,lc,&is_inrgs,&is_end,&j));
         if (is_end)
         {
             break;
         }
     }
-    END_FOR_LINE_TOK_F(field);
     if (!is_end)
     {
         strbuf errmsg,buf;
@@ -448,10 +951,31 @@ latan_errno rs_sample_save_ascii(const strbuf fname, const char mode,\
 
 latan_errno rs_sample_load_ascii(rs_sample *s, size_t *nsample, size_t *dim,\
                                  const strbuf fname, const strbuf name)
+{
+    return rs_sample_load_ascii_gen(s,nsample,dim,fname,name,NULL);
+}
+
+latan_errno rs_sample_load_subsamp_ascii(rs_sample *s, const strbuf fname,\
+                                         const strbuf name, const size_t k1,\
+                                         const size_t l1)
+{
+    size_t sub[2];
+    
+    sub[0] = k1;
+    sub[1] = l1;
+    
+    return rs_sample_load_ascii_gen(s,NULL,NULL,fname,name,sub);
+}
+
+static latan_errno rs_sample_load_ascii_gen(rs_sample *s, size_t *nsample,   \
+                                            size_t *dim, const strbuf fname, \
+                                            const strbuf name,               \
+                                            const size_t *sub)
 {
     latan_errno status;
-    int thread,nf,lc;
-    strbuf *field;
+    int thread,lc;
+    size_t nf;
+    char *line;
     bool is_inrss,is_end,is_insamp,is_sampend;
     rs_sample_ker_state ks;
 
@@ -460,25 +984,36 @@ latan_errno rs_sample_load_ascii(rs_sample *s, size_t *nsample, size_t *dim,\
 #else
     thread = 0;
 #endif
-    status     = LATAN_SUCCESS;
-    field      = NULL;
-    is_inrss   = false;
-    is_end     = false;
-    is_insamp  = false;
-    is_sampend = false;
-
-    ascii_open_file_buf(fname,'r');
-    BEGIN_FOR_LINE_TOK_F(field,FILE_BUF(thread)," ",nf,lc)
-    {
-        USTAT(rs_sample_load_ascii_ker(s,nsample,dim,fname,name,field,nf,lc,\
-                                       &is_inrss,&is_end,&is_insamp,        \
-                                       &is_sampend,&ks));
+    status        = LATAN_SUCCESS;
+    is_inrss      = false;
+    is_end        = false;
+    is_insamp     = false;
+    is_sampend    = false;
+    ks.got_seed   = false;
+    ks.sampks.sub = sub;
+
+    status = ascii_open_file_buf(fname,'r');
+    if (status != LATAN_SUCCESS)
+    {
+        return status;
+    }
+    ascii_seek(&lc,thread,ASCII_RS_SAMPLE,name);
+    while ((line = ascii_get_line(NULL,thread)) != NULL)
+    {
+        lc++;
+        USTAT(ascii_tokenize(&nf,thread,line));
+        if (nf == 0)
+        {
+            continue;
+        }
+        USTAT(rs_sample_load_ascii_ker(s,nsample,dim,fname,name,         \
+                                       FIELD(thread),nf,lc,&is_inrss,&is_end,\
+                                       &is_insamp,&is_sampend,&ks));
         if (is_end)
         {
             break;
         }
     }
-    END_FOR_LINE_TOK_F(field);
     if (!is_sampend)
     {
         strbuf errmsg,buf;
@@ -528,20 +1063,78 @@ latan_errno rs_sample_load_ascii(rs_sample *s, size_t *nsample, size_t *dim,\
             LATAN_ERROR(errmsg,LATAN_EINVAL);
         }
     }
+    if (ks.got_seed)
+    {
+        if (s&&sub)
+        {
+            USTAT(rs_sample_from_seed_subsamp(s,&(ks.sd),sub[0],sub[1]));
+        }
+        else if (s)
+        {
+            USTAT(rs_sample_from_seed(s,&(ks.sd)));
+        }
+        if (dim)
+        {
+            dim[0] = ks.sd.dim[0];
+            dim[1] = ks.sd.dim[1];
+        }
+    }
     
     return status;
 }
 
+/* a seeded sample is written as a sample block containing the line
+ * "binsize seed nrow ncol manifest [matrix name]" instead of the matrices */
+latan_errno rs_seed_save_ascii(const strbuf fname, const char mode,\
+                               const rs_seed *sd, const strbuf name)
+{
+    int thread;
+    
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
+
+    if ((mode == 'w')||(mode == 'a'))
+    {
+        ascii_open_file_buf(fname,mode);
+    }
+    else
+    {
+        LATAN_ERROR("unknown or read-only file mode",LATAN_EINVAL);
+    }
+    fprintf(FILE_BUF(thread),"%s %s %s %s\n",LATAN_COMMENT,LATAN_BEGIN,\
+            LATAN_RS_SAMPLE,name);
+    fprintf(FILE_BUF(thread),"%lu\n",(long unsigned int)(sd->nsample));
+    fprintf(FILE_BUF(thread),"%s %s %s\n",LATAN_COMMENT,LATAN_BEGIN,\
+            LATAN_RS_SEED);
+    fprintf(FILE_BUF(thread),"%lu %lu %lu %lu %s %s\n",                   \
+            (long unsigned int)(sd->binsize),(long unsigned int)(sd->seed),\
+            (long unsigned int)(sd->dim[0]),(long unsigned int)(sd->dim[1]),\
+            sd->man_fname,sd->m_name);
+    fprintf(FILE_BUF(thread),"%s %s %s\n",LATAN_COMMENT,LATAN_END,\
+            LATAN_RS_SEED);
+    fprintf(FILE_BUF(thread),"%s %s %s\n",LATAN_COMMENT,LATAN_END,\
+            LATAN_RS_SAMPLE);
+    
+    return LATAN_SUCCESS;
+}
+
 /*                        parsing kernels (internal)                        */
 /****************************************************************************/
 static latan_errno mat_load_ascii_ker(mat *m, size_t *dim, const strbuf fname,\
-                                      const strbuf name, strbuf *field,       \
+                                      const strbuf name, char **field,        \
                                       const size_t nf, const int lc,          \
                                       bool *is_inmat, bool *is_end,           \
                                       mat_ker_state *ks)
 {
-    size_t i;
+    size_t i,r,c;
     double dbuf;
+    bool is_in;
+    
+    r = 0;
+    c = 0;
     
     if ((nf >= 4)&&!*is_inmat)
     {
@@ -581,7 +1174,17 @@ static latan_errno mat_load_ascii_ker(mat *m, size_t *dim, const strbuf fname,\
                 else
                 {
                     ks->nr = (ks->nc != 0) ? (ks->j)/(ks->nc) : 0;
-                    if (m)
+                    if (m&&(ks->sub))
+                    {
+                        if (ks->sub[0] + nrow(m) > (size_t)(ks->nr))
+                        {
+                            strbuf errmsg;
+                            sprintf(errmsg,"invalid sub-matrix dimensions (%s:%d)",\
+                                    fname,lc);
+                            LATAN_ERROR(errmsg,LATAN_EBADLEN);
+                        }
+                    }
+                    else if (m)
                     {
                         if (nrow(m) != (size_t)(ks->nr))
                         {
@@ -610,7 +1213,17 @@ static latan_errno mat_load_ascii_ker(mat *m, size_t *dim, const strbuf fname,\
         {
             if (sscanf(field[0],"%d",&(ks->nc)) > 0)
             {
-                if (m)
+                if (m&&(ks->sub))
+                {
+                    if (ks->sub[1] + ncol(m) > (size_t)(ks->nc))
+                    {
+                        strbuf errmsg;
+                        sprintf(errmsg,"invalid sub-matrix dimensions (%s:%d)",\
+                                fname,lc);
+                        LATAN_ERROR(errmsg,LATAN_EBADLEN);
+                    }
+                }
+                else if (m)
                 {
                     if (ncol(m) != (size_t)(ks->nc))
                     {
@@ -638,9 +1251,26 @@ static latan_errno mat_load_ascii_ker(mat *m, size_t *dim, const strbuf fname,\
                 {
                     break;
                 }
-                else if (sscanf(field[i],"%lf",&dbuf) > 0)
+                is_in = true;
+                if (m&&(ks->sub))
                 {
-                    if (m)
+                    r     = (size_t)((ks->j)/(ks->nc));
+                    c     = (size_t)((ks->j)%(ks->nc));
+                    is_in = (r >= ks->sub[0])&&(r < ks->sub[0] + nrow(m))&&\
+                            (c >= ks->sub[1])&&(c < ks->sub[1] + ncol(m));
+                }
+                if (!is_in)
+                {
+                    /* elements outside of the sub-block are not converted */
+                    (ks->j)++;
+                }
+                else if (ascii_strtod(&dbuf,field[i]))
+                {
+                    if (m&&(ks->sub))
+                    {
+                        mat_set(m,r-ks->sub[0],c-ks->sub[1],dbuf);
+                    }
+                    else if (m)
                     {
                         if (ks->j >= (int)nel(m))
                         {
@@ -671,7 +1301,7 @@ static latan_errno mat_load_ascii_ker(mat *m, size_t *dim, const strbuf fname,\
 static latan_errno randgen_load_state_ascii_ker(rg_state state,                \
                                                 const strbuf fname,            \
                                                 const strbuf name,             \
-                                                strbuf *field, const size_t nf,\
+                                                char **field, const size_t nf, \
                                                 const int lc, bool *is_inrgs,  \
                                                 bool *is_end,                  \
                                                 int *j)
@@ -741,7 +1371,7 @@ static latan_errno randgen_load_state_ascii_ker(rg_state state,                \
 
 static latan_errno rs_sample_load_ascii_ker(rs_sample *s, size_t *nsample,    \
                                             size_t *dim, const strbuf fname,  \
-                                            const strbuf name, strbuf *field, \
+                                            const strbuf name, char **field,  \
                                             const size_t nf, const int lc,    \
                                             bool *is_inrss, bool *is_end,     \
                                             bool *is_insamp, bool *is_sampend,\
@@ -749,6 +1379,7 @@ static latan_errno rs_sample_load_ascii_ker(rs_sample *s, size_t *nsample,    \
 {
     latan_errno status;
     bool bbuf;
+    long unsigned int lubuf,lubuf_dim[2];
     
     status = LATAN_SUCCESS;
     
@@ -769,13 +1400,15 @@ static latan_errno rs_sample_load_ascii_ker(rs_sample *s, size_t *nsample,    \
         }
         if (*is_inrss)
         {
-            ks->ns      = 0;
-            ks->i       = -1;
-            *is_end     = false;
-            *is_insamp  = false;
-            *is_sampend = false;
-            ks->got_ns  = false;
-            bbuf        = false;
+            ks->ns       = 0;
+            ks->i        = -1;
+            *is_end      = false;
+            *is_insamp   = false;
+            *is_sampend  = false;
+            ks->got_ns   = false;
+            ks->in_seed  = false;
+            ks->got_seed = false;
+            bbuf         = false;
             sprintf(ks->sname,"%s_C",ks->read_name);
             if (s)
             {
@@ -833,6 +1466,54 @@ static latan_errno rs_sample_load_ascii_ker(rs_sample *s, size_t *nsample,    \
                     LATAN_ERROR(errmsg,LATAN_ELATSYN);
                 }
             }
+            else if ((nf >= 3)&&(strbufcmp(field[0],LATAN_COMMENT) == 0)&&\
+                     (strbufcmp(field[2],LATAN_RS_SEED) == 0))
+            {
+                if (strbufcmp(field[1],LATAN_BEGIN) == 0)
+                {
+                    ks->in_seed = true;
+                }
+                else if ((strbufcmp(field[1],LATAN_END) == 0)&&(ks->got_seed))
+                {
+                    ks->in_seed = false;
+                    ks->i       = ks->ns;
+                    *is_sampend = true;
+                    if (!s)
+                    {
+                        *is_end = true;
+                    }
+                }
+                else
+                {
+                    strbuf errmsg;
+                    sprintf(errmsg,"seeded sample parsing unexpected end (%s:%d)",\
+                            fname,lc);
+                    LATAN_ERROR(errmsg,LATAN_ELATSYN);
+                }
+            }
+            else if (ks->in_seed)
+            {
+                if ((nf >= 5)&&(sscanf(field[0],"%lu",&lubuf) > 0)&&\
+                    (sscanf(field[1],"%lu",&(ks->sd.seed)) > 0)&&    \
+                    (sscanf(field[2],"%lu",lubuf_dim) > 0)&&         \
+                    (sscanf(field[3],"%lu",lubuf_dim+1) > 0))
+                {
+                    ks->sd.binsize = (size_t)(lubuf);
+                    ks->sd.nsample = (size_t)(ks->ns);
+                    ks->sd.dim[0]  = (size_t)(lubuf_dim[0]);
+                    ks->sd.dim[1]  = (size_t)(lubuf_dim[1]);
+                    strbufcpy(ks->sd.man_fname,field[4]);
+                    strbufcpy(ks->sd.m_name,(nf >= 6) ? field[5] : "");
+                    ks->got_seed   = true;
+                }
+                else
+                {
+                    strbuf errmsg;
+                    sprintf(errmsg,"error while reading seeded sample (%s:%d)",\
+                            fname,lc);
+                    LATAN_ERROR(errmsg,LATAN_ELATSYN);
+                }
+            }
             else
             {
                 USTAT(mat_load_ascii_ker(ks->pt,dim,fname,ks->sname,field,nf,\
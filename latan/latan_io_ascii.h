@@ -23,6 +23,7 @@
 #include <latan/latan_globals.h>
 #include <latan/latan_mat.h>
 #include <latan/latan_statistics.h>
+#include <latan/latan_io.h>
 
 __BEGIN_DECLS
 
@@ -35,6 +36,8 @@ latan_errno mat_save_ascii(const strbuf fname, const char mode, const mat *m,\
                            const strbuf name);
 latan_errno mat_load_ascii(mat *m, size_t *dim, const strbuf fname,\
                            const strbuf name);
+latan_errno mat_load_subm_ascii(mat *m, const strbuf fname, const strbuf name,\
+                                const size_t k1, const size_t l1);
 
 /* random generator state I/O */
 latan_errno randgen_save_state_ascii(const strbuf fname, const char mode,   \
@@ -47,6 +50,11 @@ latan_errno rs_sample_save_ascii(const strbuf fname, const char mode,\
                                  const rs_sample *s, const strbuf name);
 latan_errno rs_sample_load_ascii(rs_sample *s, size_t *nsample, size_t *dim,\
                                  const strbuf fname, const strbuf name);
+latan_errno rs_sample_load_subsamp_ascii(rs_sample *s, const strbuf fname,\
+                                         const strbuf name, const size_t k1,\
+                                         const size_t l1);
+latan_errno rs_seed_save_ascii(const strbuf fname, const char mode,\
+                               const rs_seed *sd, const strbuf name);
 
 __END_DECLS
 
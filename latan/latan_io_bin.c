@@ -0,0 +1,1000 @@
+/* latan_io_bin.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#define _POSIX_C_SOURCE 200112L /* fileno, stat and mmap are used here */
+
+#include <latan/latan_io_bin.h>
+#include <latan/latan_includes.h>
+#include <latan/latan_io.h>
+#include <sys/stat.h>
+#if (defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H))
+#include <sys/mman.h>
+#define BIN_USE_MMAP
+#endif
+
+/*                    LatAnalyze binary format specification                */
+/****************************************************************************/
+/* file layout (version 1) :
+ * -------------------------
+ *
+ * header  : "LATANBIN", one byte endianness flag (LE=0, BE=1) padded to 8
+ *           bytes, int version, int reserved (24 bytes)
+ * records : int type, int name length (with the terminating '\0'),
+ *           BIN_NDIM int dimensions, name padded to 8 bytes, payload padded
+ *           to 8 bytes
+ *           - mat       : dim = {nrow,ncol}, row-major doubles
+ *           - rg_state  : dim = {state size}, ints
+ *           - rs_sample : dim = {nrow,ncol,nsample}, central value then
+ *                         samples as row-major doubles
+ *           - rs_seed   : dim = {nsample,binsize,seed low 32 bits,seed high
+ *                         32 bits,string length,nrow,ncol},
+ *                         "manifest\0matrix\0"
+ *
+ * numbers are written in the byte order of the machine writing the file and
+ * converted when read on a machine with the other byte order ; records are
+ * 8 bytes aligned so that the doubles of a memory-mapped file are read in
+ * place
+ *
+ */
+#define LATAN_BIN_MAGIC   "LATANBIN"
+#define LATAN_BIN_VERSION 1
+#define BIN_HEAD_SIZE     24
+#define BIN_NDIM          8
+#define BIN_REC_HEAD_SIZE ((2+BIN_NDIM)*sizeof(int))
+#define BIN_PAD(n)        ((((n)+7)/8)*8)
+
+enum
+{
+    bin_mat     = 1,
+    bin_rgstate = 2,
+    bin_sample  = 3,
+    bin_seed    = 4
+};
+
+/*                       file buffer management (internal)                  */
+/****************************************************************************/
+typedef struct
+{
+    FILE *f;
+    unsigned char *data;
+    size_t size;
+    size_t fsize;
+    bool is_mmap;
+    time_t mtime;
+    ino_t ino;
+    unsigned long nwrite;
+    endian_no endian;
+    strbuf fname;
+    char mode;
+} bin_file;
+
+/* nwrite counts the files opened for writing by this process, a read buffer
+ * is only reused if nothing was written since it was loaded, since a file
+ * rewritten within the same second with the same size has the same stat */
+typedef struct
+{
+    bin_file *bin_buf;
+    int nfile;
+    unsigned long nwrite;
+} io_bin_env;
+
+static io_bin_env env =
+{
+    NULL,\
+    0,   \
+    0    \
+};
+
+#define FILE_BUF(thread) (env.bin_buf + (thread)) /* type : bin_file * */
+
+static void bin_close_file(bin_file *bf);
+static latan_errno bin_read_head(bin_file *bf);
+static latan_errno bin_open_file_buf(const strbuf fname, const char mode);
+static int bin_get_int(const bin_file *bf, const size_t offset);
+static void bin_get_double(double *x, const bin_file *bf, const size_t offset,\
+                           const size_t n);
+static latan_errno bin_find(size_t *offset, int *type, int dim[BIN_NDIM], \
+                            const bin_file *bf, const int type1,          \
+                            const int type2, const strbuf name,           \
+                            const strbuf what);
+static latan_errno bin_write(FILE *f, const void *pt, const size_t size,\
+                             const size_t n);
+static latan_errno bin_write_pad(FILE *f, const size_t size);
+static latan_errno bin_write_rec_head(FILE *f, const int type,\
+                                      const int dim[BIN_NDIM],\
+                                      const strbuf name);
+static latan_errno bin_write_mat(FILE *f, const mat *m);
+static latan_errno bin_get_mat(mat *m, const bin_file *bf, size_t offset);
+static latan_errno bin_get_subm(mat *m, const bin_file *bf,              \
+                                const size_t offset, const size_t nc,    \
+                                const size_t k1, const size_t l1);
+static latan_errno rs_sample_load_bin_gen(rs_sample *s, size_t *nsample,   \
+                                          size_t *dim, const strbuf fname, \
+                                          const strbuf name,               \
+                                          const size_t *sub);
+
+static void bin_close_file(bin_file *bf)
+{
+    if (bf->f != NULL)
+    {
+        fclose(bf->f);
+        bf->f = NULL;
+    }
+    if (bf->data != NULL)
+    {
+#ifdef BIN_USE_MMAP
+        if (bf->is_mmap)
+        {
+            munmap((void *)(bf->data),bf->size);
+            bf->data = NULL;
+        }
+#endif
+        FREE(bf->data);
+    }
+    bf->size    = 0;
+    bf->fsize   = 0;
+    bf->is_mmap = false;
+    bf->mode    = '\0';
+    strbufcpy(bf->fname,"");
+}
+
+/* check the header of a file opened for reading and get its byte order */
+static latan_errno bin_read_head(bin_file *bf)
+{
+    int version;
+    strbuf errmsg;
+
+    if ((bf->size < BIN_HEAD_SIZE)||                                     \
+        (memcmp(bf->data,LATAN_BIN_MAGIC,strlen(LATAN_BIN_MAGIC)) != 0)||\
+        (bf->data[8] > 1))
+    {
+        sprintf(errmsg,"file %s is not a LatAnalyze binary file",bf->fname);
+        LATAN_ERROR(errmsg,LATAN_ELATSYN);
+    }
+    bf->endian = (bf->data[8] == 0) ? LE : BE;
+    version    = bin_get_int(bf,16);
+    if ((version < 1)||(version > LATAN_BIN_VERSION))
+    {
+        sprintf(errmsg,"binary file %s has unsupported format version %d",\
+                bf->fname,version);
+        LATAN_ERROR(errmsg,LATAN_ELATSYN);
+    }
+
+    return LATAN_SUCCESS;
+}
+
+/* in read mode the whole file is mapped in memory (or read if mmap is not
+ * available) and kept until the file is modified ; in write mode records
+ * are appended to a stdio stream */
+static latan_errno bin_open_file_buf(const strbuf fname, const char mode)
+{
+    latan_errno status;
+    strbuf errmsg;
+    struct stat st;
+    bin_file *bf;
+    unsigned char head[BIN_HEAD_SIZE];
+    int nthread,thread,i,version;
+    size_t nread;
+    unsigned long nwrite;
+
+#ifdef _OPENMP
+    nthread = omp_get_num_threads();
+    thread  = omp_get_thread_num();
+#else
+    nthread = 1;
+    thread  = 0;
+#endif
+    status = LATAN_SUCCESS;
+
+    if ((mode != 'r')&&(mode != 'w')&&(mode != 'a'))
+    {
+        sprintf(errmsg,"binary file mode %c unknown",mode);
+        LATAN_ERROR(errmsg,LATAN_EINVAL);
+    }
+
+#ifdef _OPENMP
+    #pragma omp critical
+#endif
+    {
+        if (nthread > env.nfile)
+        {
+            REALLOC_NOERRET(env.bin_buf,env.bin_buf,bin_file *,nthread);
+            for (i=env.nfile;i<nthread;i++)
+            {
+                FILE_BUF(i)->f       = NULL;
+                FILE_BUF(i)->data    = NULL;
+                FILE_BUF(i)->size    = 0;
+                FILE_BUF(i)->fsize   = 0;
+                FILE_BUF(i)->is_mmap = false;
+                FILE_BUF(i)->mode    = '\0';
+                strbufcpy(FILE_BUF(i)->fname,"");
+            }
+            env.nfile = nthread;
+        }
+    }
+    bf = FILE_BUF(thread);
+    if (mode != 'r')
+    {
+#ifdef _OPENMP
+        #pragma omp atomic
+#endif
+        env.nwrite++;
+    }
+    if (mode == 'r')
+    {
+        /* the records appended to this file by any thread are flushed
+         * before mapping it by closing the write streams, they are reopened
+         * by the next write */
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        {
+            for (i=0;i<env.nfile;i++)
+            {
+                if ((FILE_BUF(i)->mode == 'a')&&\
+                    (strbufcmp(FILE_BUF(i)->fname,fname) == 0))
+                {
+                    bin_close_file(FILE_BUF(i));
+                }
+            }
+        }
+        if (bf->mode != 'r')
+        {
+            bin_close_file(bf);
+        }
+#ifdef _OPENMP
+        #pragma omp flush
+#endif
+        nwrite = env.nwrite;
+        if (stat(fname,&st) != 0)
+        {
+            sprintf(errmsg,"error opening file %s",fname);
+            LATAN_ERROR(errmsg,LATAN_EFAULT);
+        }
+        if ((bf->mode == 'r')&&(strbufcmp(bf->fname,fname) == 0)&&      \
+            (bf->fsize == (size_t)(st.st_size))&&(bf->mtime == st.st_mtime)\
+            &&(bf->ino == st.st_ino)&&(bf->nwrite == nwrite))
+        {
+            return status;
+        }
+        bin_close_file(bf);
+        FOPEN(bf->f,fname,"rb");
+        strbufcpy(bf->fname,fname);
+        bf->mode   = 'r';
+        bf->fsize  = (size_t)(st.st_size);
+        bf->mtime  = st.st_mtime;
+        bf->ino    = st.st_ino;
+        bf->nwrite = nwrite;
+        bf->size  = bf->fsize;
+#ifdef BIN_USE_MMAP
+        if ((bf->size > 0)&&(fileno(bf->f) >= 0))
+        {
+            void *map;
+
+            map = mmap(NULL,bf->size,PROT_READ,MAP_PRIVATE,fileno(bf->f),0);
+            if (map != MAP_FAILED)
+            {
+                bf->data    = (unsigned char *)(map);
+                bf->is_mmap = true;
+            }
+        }
+#endif
+        /* compressed streams have no descriptor and an unknown size, they
+         * are read until the end in a growing buffer */
+        if (!bf->is_mmap)
+        {
+            size_t nalloc;
+
+            nalloc   = bf->fsize + 1;
+            bf->size = 0;
+            MALLOC(bf->data,unsigned char *,nalloc);
+            while ((nread = fread(bf->data+bf->size,1,nalloc-bf->size,\
+                                  bf->f)) > 0)
+            {
+                bf->size += nread;
+                if (bf->size == nalloc)
+                {
+                    nalloc *= 2;
+                    REALLOC(bf->data,bf->data,unsigned char *,nalloc);
+                }
+            }
+            if (ferror(bf->f))
+            {
+                sprintf(errmsg,"error while reading file %s",fname);
+                bin_close_file(bf);
+                LATAN_ERROR(errmsg,LATAN_EFAULT);
+            }
+        }
+        fclose(bf->f);
+        bf->f = NULL;
+        status = bin_read_head(bf);
+        if (status != LATAN_SUCCESS)
+        {
+            bin_close_file(bf);
+        }
+    }
+    else if ((mode == 'w')||(bf->mode != 'a')||\
+             (strbufcmp(bf->fname,fname) != 0))
+    {
+        bin_close_file(bf);
+        if ((mode == 'w')||(stat(fname,&st) != 0)||(st.st_size == 0))
+        {
+            FOPEN(bf->f,fname,"wb");
+            strbufcpy(bf->fname,fname);
+            memset(head,0,BIN_HEAD_SIZE);
+            memcpy(head,LATAN_BIN_MAGIC,strlen(LATAN_BIN_MAGIC));
+            head[8] = (unsigned char)(latan_get_endianness());
+            version = LATAN_BIN_VERSION;
+            memcpy(head+16,&version,sizeof(int));
+            USTAT(bin_write(bf->f,head,1,BIN_HEAD_SIZE));
+        }
+        else
+        {
+            /* records can only be appended in the byte order of the file,
+             * the header is read through a separate stream since compressed
+             * streams are write-only */
+            FOPEN(bf->f,fname,"rb");
+            nread = fread(head,1,BIN_HEAD_SIZE,bf->f);
+            fclose(bf->f);
+            bf->f = NULL;
+            if ((nread != BIN_HEAD_SIZE)||                                 \
+                (memcmp(head,LATAN_BIN_MAGIC,strlen(LATAN_BIN_MAGIC)) != 0))
+            {
+                sprintf(errmsg,"file %s is not a LatAnalyze binary file",\
+                        fname);
+                LATAN_ERROR(errmsg,LATAN_ELATSYN);
+            }
+            if (head[8] != (unsigned char)(latan_get_endianness()))
+            {
+                sprintf(errmsg,"impossible to append to binary file %s written with another byte order",\
+                        fname);
+                LATAN_ERROR(errmsg,LATAN_EINVAL);
+            }
+            FOPEN(bf->f,fname,"ab");
+            strbufcpy(bf->fname,fname);
+        }
+        /* the stream stays open to append the following records */
+        bf->mode = 'a';
+    }
+
+    return status;
+}
+
+/*                       record reading/writing (internal)                  */
+/****************************************************************************/
+static int bin_get_int(const bin_file *bf, const size_t offset)
+{
+    int x;
+
+    memcpy(&x,bf->data+offset,sizeof(int));
+
+    return latan_conv_endianness_i(x,bf->endian);
+}
+
+static void bin_get_double(double *x, const bin_file *bf, const size_t offset,\
+                           const size_t n)
+{
+    size_t i;
+
+    memcpy(x,bf->data+offset,n*sizeof(double));
+    if (bf->endian != latan_get_endianness())
+    {
+        for (i=0;i<n;i++)
+        {
+            x[i] = latan_swap_byte_d(x[i]);
+        }
+    }
+}
+
+/* look for the first record with type type1 or type2 and with the given
+ * name (or any name if empty), the offset of its payload, its type and its
+ * dimensions are returned */
+static latan_errno bin_find(size_t *offset, int *type, int dim[BIN_NDIM], \
+                            const bin_file *bf, const int type1,          \
+                            const int type2, const strbuf name,           \
+                            const strbuf what)
+{
+    size_t off,name_len,pay_size;
+    int i;
+    bool is_bad;
+    strbuf errmsg,buf;
+    const char *rec_name;
+
+    off = BIN_HEAD_SIZE;
+    while (off < bf->size)
+    {
+        if (off + BIN_REC_HEAD_SIZE > bf->size)
+        {
+            sprintf(errmsg,"unexpected end of binary file %s",bf->fname);
+            LATAN_ERROR(errmsg,LATAN_ELATSYN);
+        }
+        *type = bin_get_int(bf,off);
+        i     = bin_get_int(bf,off+sizeof(int));
+        for (name_len=0;name_len<BIN_NDIM;name_len++)
+        {
+            dim[name_len] = bin_get_int(bf,off+(2+name_len)*sizeof(int));
+        }
+        /* only the dimensions used by the record type are checked, the
+         * seed of a seeded sample is stored in dim[2] and dim[3] */
+        switch (*type)
+        {
+            case bin_mat:
+                is_bad   = (dim[0] < 0)||(dim[1] < 0);
+                pay_size = (size_t)(dim[0])*(size_t)(dim[1])*sizeof(double);
+                break;
+            case bin_rgstate:
+                is_bad   = (dim[0] < 0);
+                pay_size = BIN_PAD((size_t)(dim[0])*sizeof(int));
+                break;
+            case bin_sample:
+                is_bad   = (dim[0] < 0)||(dim[1] < 0)||(dim[2] < 0);
+                pay_size = ((size_t)(dim[2])+1)*(size_t)(dim[0])\
+                           *(size_t)(dim[1])*sizeof(double);
+                break;
+            case bin_seed:
+                is_bad   = (dim[0] < 0)||(dim[1] < 0)||(dim[4] < 0)||\
+                           (dim[5] < 0)||(dim[6] < 0);
+                pay_size = BIN_PAD((size_t)(dim[4]));
+                break;
+            default:
+                sprintf(errmsg,"unknown record type %d in binary file %s",\
+                        *type,bf->fname);
+                LATAN_ERROR(errmsg,LATAN_ELATSYN);
+                break;
+        }
+        if ((i < 1)||is_bad)
+        {
+            sprintf(errmsg,"corrupted record in binary file %s",bf->fname);
+            LATAN_ERROR(errmsg,LATAN_ELATSYN);
+        }
+        name_len = (size_t)(i);
+        rec_name = (const char *)(bf->data+off+BIN_REC_HEAD_SIZE);
+        off     += BIN_REC_HEAD_SIZE + BIN_PAD(name_len);
+        if ((off + pay_size > bf->size)||(rec_name[name_len-1] != '\0'))
+        {
+            sprintf(errmsg,"unexpected end of binary file %s",bf->fname);
+            LATAN_ERROR(errmsg,LATAN_ELATSYN);
+        }
+        if (((*type == type1)||(*type == type2))&&\
+            ((strlen(name) == 0)||(strcmp(rec_name,name) == 0)))
+        {
+            *offset = off;
+
+            return LATAN_SUCCESS;
+        }
+        off += pay_size;
+    }
+    if (strlen(name) == 0)
+    {
+        strcpy(buf,"<no_name>");
+    }
+    else
+    {
+        sprintf(buf,"\"%s\"",name);
+    }
+    sprintf(errmsg,"%s (name= %s) not found in file %s",what,buf,bf->fname);
+    LATAN_ERROR(errmsg,LATAN_EINVAL);
+}
+
+static latan_errno bin_write(FILE *f, const void *pt, const size_t size,\
+                             const size_t n)
+{
+    if (fwrite(pt,size,n,f) != n)
+    {
+        LATAN_ERROR("error while writing binary file",LATAN_EFAULT);
+    }
+
+    return LATAN_SUCCESS;
+}
+
+static latan_errno bin_write_pad(FILE *f, const size_t size)
+{
+    const unsigned char zero[8] = {0,0,0,0,0,0,0,0};
+
+    return bin_write(f,zero,1,BIN_PAD(size)-size);
+}
+
+static latan_errno bin_write_rec_head(FILE *f, const int type,\
+                                      const int dim[BIN_NDIM],\
+                                      const strbuf name)
+{
+    latan_errno status;
+    int head[2];
+    size_t name_len;
+
+    status   = LATAN_SUCCESS;
+    name_len = strlen(name) + 1;
+    head[0]  = type;
+    head[1]  = (int)(name_len);
+
+    USTAT(bin_write(f,head,sizeof(int),2));
+    USTAT(bin_write(f,dim,sizeof(int),BIN_NDIM));
+    USTAT(bin_write(f,name,1,name_len));
+    USTAT(bin_write_pad(f,name_len));
+
+    return status;
+}
+
+static latan_errno bin_write_mat(FILE *f, const mat *m)
+{
+    latan_errno status;
+    size_t i;
+
+    status = LATAN_SUCCESS;
+
+    for (i=0;i<nrow(m);i++)
+    {
+        USTAT(bin_write(f,m->data_cpu->data+i*m->data_cpu->tda,\
+                        sizeof(double),ncol(m)));
+    }
+
+    return status;
+}
+
+static latan_errno bin_get_mat(mat *m, const bin_file *bf, size_t offset)
+{
+    return bin_get_subm(m,bf,offset,ncol(m),0,0);
+}
+
+/* strided read of the sub-block of the size of m starting at row k1 and
+ * column l1 of the stored matrix with nc columns, with a memory-mapped file
+ * only the pages containing the sub-block are accessed */
+static latan_errno bin_get_subm(mat *m, const bin_file *bf,              \
+                                const size_t offset, const size_t nc,    \
+                                const size_t k1, const size_t l1)
+{
+    size_t i;
+
+    for (i=0;i<nrow(m);i++)
+    {
+        bin_get_double(m->data_cpu->data+i*m->data_cpu->tda,bf,          \
+                       offset+((k1+i)*nc+l1)*sizeof(double),ncol(m));
+    }
+
+    return LATAN_SUCCESS;
+}
+
+/*                              I/O init/finish                             */
+/****************************************************************************/
+void io_init_bin(void)
+{
+#ifdef _OPENMP
+    if(omp_in_parallel())
+    {
+        LATAN_WARNING("I/O initialization called from a parallel region",\
+                      LATAN_FAILURE);
+    }
+#endif
+}
+
+void io_finish_bin(void)
+{
+    int i;
+
+#ifdef _OPENMP
+    if(omp_in_parallel())
+    {
+        LATAN_WARNING("I/O finish called from a parallel region",\
+                      LATAN_FAILURE);
+    }
+#endif
+    for (i=0;i<env.nfile;i++)
+    {
+        bin_close_file(FILE_BUF(i));
+    }
+    FREE(env.bin_buf);
+    env.nfile = 0;
+}
+
+/*                             mat I/O                                      */
+/****************************************************************************/
+latan_errno mat_save_bin(const strbuf fname, const char mode, const mat *m,\
+                         const strbuf name)
+{
+    latan_errno status;
+    int thread;
+    int dim[BIN_NDIM] = {0,0,0,0,0,0,0,0};
+
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
+    status = LATAN_SUCCESS;
+
+    if ((mode == 'w')||(mode == 'a'))
+    {
+        USTAT(bin_open_file_buf(fname,mode));
+    }
+    else
+    {
+        LATAN_ERROR("unknown or read-only file mode",LATAN_EINVAL);
+    }
+    dim[0] = (int)(nrow(m));
+    dim[1] = (int)(ncol(m));
+    USTAT(bin_write_rec_head(FILE_BUF(thread)->f,bin_mat,dim,name));
+    USTAT(bin_write_mat(FILE_BUF(thread)->f,m));
+
+    return status;
+}
+
+latan_errno mat_load_bin(mat *m, size_t *dim, const strbuf fname,\
+                         const strbuf name)
+{
+    latan_errno status;
+    int thread,type;
+    int rdim[BIN_NDIM];
+    size_t offset;
+
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
+    status = LATAN_SUCCESS;
+
+    USTAT(bin_open_file_buf(fname,'r'));
+    if (status != LATAN_SUCCESS)
+    {
+        return status;
+    }
+    USTAT(bin_find(&offset,&type,rdim,FILE_BUF(thread),bin_mat,bin_mat,name,\
+                   "matrix"));
+    if (status != LATAN_SUCCESS)
+    {
+        return status;
+    }
+    if (m)
+    {
+        if ((nrow(m) != (size_t)(rdim[0]))||(ncol(m) != (size_t)(rdim[1])))
+        {
+            LATAN_ERROR("matrix dimension mismatch",LATAN_EBADLEN);
+        }
+        USTAT(bin_get_mat(m,FILE_BUF(thread),offset));
+    }
+    if (dim)
+    {
+        dim[0] = (size_t)(rdim[0]);
+        dim[1] = (size_t)(rdim[1]);
+    }
+
+    return status;
+}
+
+latan_errno mat_load_subm_bin(mat *m, const strbuf fname, const strbuf name,\
+                              const size_t k1, const size_t l1)
+{
+    latan_errno status;
+    int thread,type;
+    int rdim[BIN_NDIM];
+    size_t offset;
+
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
+    status = LATAN_SUCCESS;
+
+    USTAT(bin_open_file_buf(fname,'r'));
+    if (status != LATAN_SUCCESS)
+    {
+        return status;
+    }
+    USTAT(bin_find(&offset,&type,rdim,FILE_BUF(thread),bin_mat,bin_mat,name,\
+                   "matrix"));
+    if (status != LATAN_SUCCESS)
+    {
+        return status;
+    }
+    if ((k1 + nrow(m) > (size_t)(rdim[0]))||(l1 + ncol(m) > (size_t)(rdim[1])))
+    {
+        LATAN_ERROR("invalid sub-matrix dimensions",LATAN_EBADLEN);
+    }
+    USTAT(bin_get_subm(m,FILE_BUF(thread),offset,(size_t)(rdim[1]),k1,l1));
+
+    return status;
+}
+
+/*                      random generator state I/O                          */
+/****************************************************************************/
+latan_errno randgen_save_state_bin(const strbuf fname, const char mode,   \
+                                   const rg_state state, const strbuf name)
+{
+    latan_errno status;
+    int thread;
+    int dim[BIN_NDIM] = {RLXG_STATE_SIZE,0,0,0,0,0,0,0};
+
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
+    status = LATAN_SUCCESS;
+
+    if ((mode == 'w')||(mode == 'a'))
+    {
+        USTAT(bin_open_file_buf(fname,mode));
+    }
+    else
+    {
+        LATAN_ERROR("unknown or read-only file mode",LATAN_EINVAL);
+    }
+    USTAT(bin_write_rec_head(FILE_BUF(thread)->f,bin_rgstate,dim,name));
+    USTAT(bin_write(FILE_BUF(thread)->f,state,sizeof(int),RLXG_STATE_SIZE));
+    USTAT(bin_write_pad(FILE_BUF(thread)->f,RLXG_STATE_SIZE*sizeof(int)));
+
+    return status;
+}
+
+latan_errno randgen_load_state_bin(rg_state state, const strbuf fname,\
+                                   const strbuf name)
+{
+    latan_errno status;
+    int thread,type,i;
+    int rdim[BIN_NDIM];
+    size_t offset;
+
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
+    status = LATAN_SUCCESS;
+
+    USTAT(bin_open_file_buf(fname,'r'));
+    if (status != LATAN_SUCCESS)
+    {
+        return status;
+    }
+    USTAT(bin_find(&offset,&type,rdim,FILE_BUF(thread),bin_rgstate,       \
+                   bin_rgstate,name,"random generator state"));
+    if (status != LATAN_SUCCESS)
+    {
+        return status;
+    }
+    if (rdim[0] != RLXG_STATE_SIZE)
+    {
+        LATAN_ERROR("random generator state size mismatch",LATAN_EBADLEN);
+    }
+    for (i=0;i<RLXG_STATE_SIZE;i++)
+    {
+        state[i] = bin_get_int(FILE_BUF(thread),offset+(size_t)(i)*sizeof(int));
+    }
+
+    return status;
+}
+
+/*                          resampled sample I/O                            */
+/****************************************************************************/
+latan_errno rs_sample_save_bin(const strbuf fname, const char mode,\
+                               const rs_sample *s, const strbuf name)
+{
+    latan_errno status;
+    int thread;
+    int dim[BIN_NDIM] = {0,0,0,0,0,0,0,0};
+    const size_t nsample = rs_sample_get_nsample(s);
+    const mat *cent_val  = rs_sample_pt_cent_val(s);
+
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
+    status = LATAN_SUCCESS;
+
+    if ((mode == 'w')||(mode == 'a'))
+    {
+        USTAT(bin_open_file_buf(fname,mode));
+    }
+    else
+    {
+        LATAN_ERROR("unknown or read-only file mode",LATAN_EINVAL);
+    }
+    dim[0] = (int)(nrow(cent_val));
+    dim[1] = (int)(ncol(cent_val));
+    dim[2] = (int)(nsample);
+    USTAT(bin_write_rec_head(FILE_BUF(thread)->f,bin_sample,dim,name));
+    USTAT(bin_write_mat(FILE_BUF(thread)->f,cent_val));
+    USTAT(bin_write(FILE_BUF(thread)->f,                       \
+                    rs_sample_pt_slab(s)->data_cpu->data,      \
+                    sizeof(double),nsample*nel(cent_val)));
+
+    return status;
+}
+
+latan_errno rs_sample_load_bin(rs_sample *s, size_t *nsample, size_t *dim,\
+                               const strbuf fname, const strbuf name)
+{
+    return rs_sample_load_bin_gen(s,nsample,dim,fname,name,NULL);
+}
+
+latan_errno rs_sample_load_subsamp_bin(rs_sample *s, const strbuf fname,\
+                                       const strbuf name, const size_t k1,\
+                                       const size_t l1)
+{
+    size_t sub[2];
+
+    sub[0] = k1;
+    sub[1] = l1;
+
+    return rs_sample_load_bin_gen(s,NULL,NULL,fname,name,sub);
+}
+
+/* the samples are stored contiguously in the file as in the sample slab,
+ * they are loaded with a single copy from the mapped file, or with strided
+ * reads if only the sub-block starting at row sub[0] and column sub[1] is
+ * loaded */
+static latan_errno rs_sample_load_bin_gen(rs_sample *s, size_t *nsample,   \
+                                          size_t *dim, const strbuf fname, \
+                                          const strbuf name,               \
+                                          const size_t *sub)
+{
+    latan_errno status;
+    int thread,type;
+    int rdim[BIN_NDIM];
+    size_t offset,nel_s,i;
+    const char *str;
+    unsigned long seed_hi;
+    rs_seed sd;
+
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
+    status = LATAN_SUCCESS;
+
+    USTAT(bin_open_file_buf(fname,'r'));
+    if (status != LATAN_SUCCESS)
+    {
+        return status;
+    }
+    USTAT(bin_find(&offset,&type,rdim,FILE_BUF(thread),bin_sample,bin_seed,\
+                   name,"sample"));
+    if (status != LATAN_SUCCESS)
+    {
+        return status;
+    }
+    if (type == bin_sample)
+    {
+        nel_s = (size_t)(rdim[0])*(size_t)(rdim[1]);
+        if (s&&sub)
+        {
+            if (rs_sample_get_nsample(s) != (size_t)(rdim[2]))
+            {
+                LATAN_ERROR("sample dimension mismatch",LATAN_EBADLEN);
+            }
+            if ((sub[0] + nrow(rs_sample_pt_cent_val(s)) > (size_t)(rdim[0]))||\
+                (sub[1] + ncol(rs_sample_pt_cent_val(s)) > (size_t)(rdim[1])))
+            {
+                LATAN_ERROR("invalid sub-matrix dimensions",LATAN_EBADLEN);
+            }
+            USTAT(bin_get_subm(rs_sample_pt_cent_val(s),FILE_BUF(thread),\
+                               offset,(size_t)(rdim[1]),sub[0],sub[1]));
+            for (i=0;i<rs_sample_get_nsample(s);i++)
+            {
+                USTAT(bin_get_subm(rs_sample_pt_sample(s,i),FILE_BUF(thread),\
+                                   offset+(i+1)*nel_s*sizeof(double),       \
+                                   (size_t)(rdim[1]),sub[0],sub[1]));
+            }
+        }
+        else if (s)
+        {
+            if ((rs_sample_get_nsample(s) != (size_t)(rdim[2]))||          \
+                (nrow(rs_sample_pt_cent_val(s)) != (size_t)(rdim[0]))||    \
+                (ncol(rs_sample_pt_cent_val(s)) != (size_t)(rdim[1])))
+            {
+                LATAN_ERROR("sample dimension mismatch",LATAN_EBADLEN);
+            }
+            USTAT(bin_get_mat(rs_sample_pt_cent_val(s),FILE_BUF(thread),\
+                              offset));
+            bin_get_double(rs_sample_pt_slab(s)->data_cpu->data,       \
+                           FILE_BUF(thread),offset+nel_s*sizeof(double),\
+                           (size_t)(rdim[2])*nel_s);
+        }
+        if (nsample)
+        {
+            *nsample = (size_t)(rdim[2]);
+        }
+        if (dim)
+        {
+            dim[0] = (size_t)(rdim[0]);
+            dim[1] = (size_t)(rdim[1]);
+        }
+    }
+    else
+    {
+        /* seeded sample, rebuilt once the file buffer is not used anymore */
+        str = (const char *)(FILE_BUF(thread)->data + offset);
+        if ((rdim[4] < 2)||(str[rdim[4]-1] != '\0')||\
+            (strlen(str) + 1 >= (size_t)(rdim[4])))
+        {
+            LATAN_ERROR("corrupted seeded sample record",LATAN_ELATSYN);
+        }
+        seed_hi    = (unsigned long)((unsigned int)(rdim[3]));
+        sd.nsample = (size_t)(rdim[0]);
+        sd.binsize = (size_t)(rdim[1]);
+        sd.dim[0]  = (size_t)(rdim[5]);
+        sd.dim[1]  = (size_t)(rdim[6]);
+        sd.seed    = ((seed_hi << 16) << 16)|\
+                     (unsigned long)((unsigned int)(rdim[2]));
+        strbufcpy(sd.man_fname,str);
+        strbufcpy(sd.m_name,str+strlen(str)+1);
+        if (s&&sub)
+        {
+            USTAT(rs_sample_from_seed_subsamp(s,&sd,sub[0],sub[1]));
+        }
+        else if (s)
+        {
+            USTAT(rs_sample_from_seed(s,&sd));
+        }
+        if (nsample)
+        {
+            *nsample = sd.nsample;
+        }
+        if (dim)
+        {
+            dim[0] = sd.dim[0];
+            dim[1] = sd.dim[1];
+        }
+    }
+
+    return status;
+}
+
+latan_errno rs_seed_save_bin(const strbuf fname, const char mode,\
+                             const rs_seed *sd, const strbuf name)
+{
+    latan_errno status;
+    int thread;
+    int dim[BIN_NDIM] = {0,0,0,0,0,0,0,0};
+    size_t man_len,m_len;
+
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
+    status  = LATAN_SUCCESS;
+    man_len = strlen(sd->man_fname) + 1;
+    m_len   = strlen(sd->m_name) + 1;
+
+    if ((mode == 'w')||(mode == 'a'))
+    {
+        USTAT(bin_open_file_buf(fname,mode));
+    }
+    else
+    {
+        LATAN_ERROR("unknown or read-only file mode",LATAN_EINVAL);
+    }
+    dim[0] = (int)(sd->nsample);
+    dim[1] = (int)(sd->binsize);
+    dim[2] = (int)((unsigned int)(sd->seed & 0xFFFFFFFFUL));
+    dim[3] = (int)((unsigned int)(((sd->seed >> 16) >> 16) & 0xFFFFFFFFUL));
+    dim[4] = (int)(man_len + m_len);
+    dim[5] = (int)(sd->dim[0]);
+    dim[6] = (int)(sd->dim[1]);
+    USTAT(bin_write_rec_head(FILE_BUF(thread)->f,bin_seed,dim,name));
+    USTAT(bin_write(FILE_BUF(thread)->f,sd->man_fname,1,man_len));
+    USTAT(bin_write(FILE_BUF(thread)->f,sd->m_name,1,m_len));
+    USTAT(bin_write_pad(FILE_BUF(thread)->f,man_len+m_len));
+
+    return status;
+}
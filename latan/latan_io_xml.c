@@ -18,44 +18,59 @@
  */
 
 
+#define _POSIX_SOURCE
+
 #include <latan/latan_includes.h>
 #ifdef HAVE_LIBXML2
 #include <latan/latan_io_xml.h>
 #include <latan/latan_io.h>
 #include <latan/latan_xml.h>
+#include <sys/stat.h>
 
 /*                       XML buffer management (internal)                   */
 /****************************************************************************/
+/* a reader left by a streamed sample size query, positioned at the start of
+ * the sample, it is used by the next load of the same sample instead of
+ * parsing the file again */
+typedef struct
+{
+    xmlTextReader *reader;
+    strbuf fname;
+    strbuf name;
+    struct stat st;
+} xml_stream_buf;
+
 typedef struct
 {
     xml_file **xml_buf;
     bool *file_is_loaded;
+    xml_stream_buf *stream_buf;
     int nfile;
 } io_xml_env;
 
 static io_xml_env env =
 {
+    NULL,\
     NULL,\
     NULL,\
     0    \
 };
 
 #define FILE_BUF(thread) env.xml_buf[thread] /* type : xml_file * */
+#define STREAM_BUF(thread) env.stream_buf[thread] /* type : xml_stream_buf */
 
-static latan_errno xml_open_file_buf(const strbuf fname, const char mode)
-{
-    latan_errno status;
-    int nthread,thread,i;
-
-#ifdef _OPENMP
-    nthread = omp_get_num_threads();
-    thread  = omp_get_thread_num();
-#else
-    nthread = 1;
-    thread  = 0;
-#endif
-    status = LATAN_SUCCESS;
+static latan_errno mat_load_xml_gen(mat *m, size_t *dim, const strbuf fname,\
+                                    const strbuf name, const size_t *sub);
+static latan_errno rs_sample_load_xml_gen(rs_sample *s, size_t *nsample,   \
+                                          size_t *dim, const strbuf fname, \
+                                          const strbuf name,               \
+                                          const size_t *sub);
 
+/* one buffer per thread */
+static void xml_buf_alloc(const int nthread)
+{
+    int i;
+    
 #ifdef _OPENMP
     #pragma omp critical
 #endif
@@ -65,14 +80,40 @@ static latan_errno xml_open_file_buf(const strbuf fname, const char mode)
             REALLOC_NOERRET(env.xml_buf,env.xml_buf,xml_file **,nthread);
             REALLOC_NOERRET(env.file_is_loaded,env.file_is_loaded,bool *,\
                             nthread);
+            REALLOC_NOERRET(env.stream_buf,env.stream_buf,xml_stream_buf *,\
+                            nthread);
             for (i=env.nfile;i<nthread;i++)
             {
                 env.file_is_loaded[i] = false;
-                FILE_BUF(i)        = NULL;
+                FILE_BUF(i)           = NULL;
+                STREAM_BUF(i).reader  = NULL;
             }
             env.nfile = nthread;
         }
     }
+}
+
+static latan_errno xml_open_file_buf(const strbuf fname, const char mode)
+{
+    latan_errno status;
+    int nthread,thread;
+
+#ifdef _OPENMP
+    nthread = omp_get_num_threads();
+    thread  = omp_get_thread_num();
+#else
+    nthread = 1;
+    thread  = 0;
+#endif
+    status = LATAN_SUCCESS;
+
+    xml_buf_alloc(nthread);
+    if ((mode != 'r')&&(STREAM_BUF(thread).reader != NULL)&&\
+        (strbufcmp(STREAM_BUF(thread).fname,fname) == 0))
+    {
+        xmlFreeTextReader(STREAM_BUF(thread).reader);
+        STREAM_BUF(thread).reader = NULL;
+    }
     if (env.file_is_loaded[thread])
     {
         if ((strbufcmp(FILE_BUF(thread)->fname,fname) != 0)||(mode == 'w')||\
@@ -84,13 +125,126 @@ static latan_errno xml_open_file_buf(const strbuf fname, const char mode)
     }
     else
     {
-        FILE_BUF(thread)           = xml_open_file(fname,mode);
-        env.file_is_loaded[thread] = true;
+        FILE_BUF(thread) = xml_open_file(fname,mode);
+    }
+    /* the error was reported by xml_open_file */
+    env.file_is_loaded[thread] = (FILE_BUF(thread) != NULL);
+    if (FILE_BUF(thread) == NULL)
+    {
+        return LATAN_EFAULT;
     }
 
     return status;
 }
 
+/* files larger than LATAN_XML_STREAM_SIZE are not loaded in the file buffer
+ * but streamed, compressed files are always streamed since their size on
+ * disk says little about the size of the tree, *reader is NULL if the file
+ * buffer has to be used ; pending modifications of the file in the buffer
+ * are written first */
+static latan_errno xml_open_stream(xmlTextReader **reader, const strbuf fname)
+{
+    latan_errno status;
+    struct stat st;
+    int thread;
+    bool is_buf;
+    
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
+    status  = LATAN_SUCCESS;
+    *reader = NULL;
+    is_buf  = (thread < env.nfile)&&(env.file_is_loaded[thread])&&\
+              (FILE_BUF(thread) != NULL)&&                         \
+              (strbufcmp(FILE_BUF(thread)->fname,fname) == 0);
+    
+    if (is_buf&&(FILE_BUF(thread)->mode == 'r'))
+    {
+        return status;
+    }
+    if (is_buf)
+    {
+        status                     = xml_close_file(FILE_BUF(thread));
+        FILE_BUF(thread)           = NULL;
+        env.file_is_loaded[thread] = false;
+    }
+    if ((stat(fname,&st) == 0)&&((st.st_size >= LATAN_XML_STREAM_SIZE)||\
+                                 (io_zip_ext_len(fname) > 0)))
+    {
+        *reader = xml_stream_open(fname);
+        if (*reader == NULL)
+        {
+            return LATAN_EFAULT;
+        }
+    }
+    
+    return status;
+}
+
+/* keep the reader of a streamed sample size query for the next load */
+static void xml_stream_buf_set(xmlTextReader *reader, const strbuf fname,\
+                               const strbuf name)
+{
+    int nthread,thread;
+    
+#ifdef _OPENMP
+    nthread = omp_get_num_threads();
+    thread  = omp_get_thread_num();
+#else
+    nthread = 1;
+    thread  = 0;
+#endif
+    xml_buf_alloc(nthread);
+    if ((thread >= env.nfile)||(stat(fname,&(STREAM_BUF(thread).st)) != 0))
+    {
+        xmlFreeTextReader(reader);
+        return;
+    }
+    if (STREAM_BUF(thread).reader != NULL)
+    {
+        xmlFreeTextReader(STREAM_BUF(thread).reader);
+    }
+    STREAM_BUF(thread).reader = reader;
+    strbufcpy(STREAM_BUF(thread).fname,fname);
+    strbufcpy(STREAM_BUF(thread).name,name);
+}
+
+/* take the kept reader if it was left on the sample name in fname and the
+ * file did not change since, NULL otherwise */
+static xmlTextReader * xml_stream_buf_get(const strbuf fname,\
+                                          const strbuf name)
+{
+    xmlTextReader *reader;
+    struct stat st;
+    int thread;
+    
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
+    if ((thread >= env.nfile)||(STREAM_BUF(thread).reader == NULL))
+    {
+        return NULL;
+    }
+    reader                    = STREAM_BUF(thread).reader;
+    STREAM_BUF(thread).reader = NULL;
+    if ((strbufcmp(STREAM_BUF(thread).fname,fname) != 0)||           \
+        (strbufcmp(STREAM_BUF(thread).name,name) != 0)||             \
+        (stat(fname,&st) != 0)||                                    \
+        (st.st_ino != STREAM_BUF(thread).st.st_ino)||                \
+        (st.st_size != STREAM_BUF(thread).st.st_size)||              \
+        (st.st_mtime != STREAM_BUF(thread).st.st_mtime))
+    {
+        xmlFreeTextReader(reader);
+        reader = NULL;
+    }
+    
+    return reader;
+}
+
 /*                              I/O init/finish                             */
 /****************************************************************************/
 void io_init_xml(void)
@@ -123,6 +277,11 @@ void io_finish_xml(void)
             xml_close_file(FILE_BUF(i));
             env.file_is_loaded[i] = false;
         }
+        if (STREAM_BUF(i).reader != NULL)
+        {
+            xmlFreeTextReader(STREAM_BUF(i).reader);
+            STREAM_BUF(i).reader = NULL;
+        }
     }
     xmlCleanupParser();
 }
@@ -156,43 +315,100 @@ latan_errno mat_save_xml(const strbuf fname, const char mode, const mat *m,\
 
 latan_errno mat_load_xml(mat *m, size_t *dim, const strbuf fname,\
                          const strbuf name)
+{
+    return mat_load_xml_gen(m,dim,fname,name,NULL);
+}
+
+latan_errno mat_load_subm_xml(mat *m, const strbuf fname, const strbuf name,\
+                              const size_t k1, const size_t l1)
+{
+    size_t sub[2];
+    
+    sub[0] = k1;
+    sub[1] = l1;
+    
+    return mat_load_xml_gen(m,NULL,fname,name,sub);
+}
+
+/* if sub is not NULL, only the sub-block of the size of m starting at row
+ * sub[0] and column sub[1] is loaded */
+static latan_errno mat_load_xml_gen(mat *m, size_t *dim, const strbuf fname,\
+                                    const strbuf name, const size_t *sub)
 {
     xmlXPathObject *nodeset;
+    xmlTextReader *reader;
+    xmlNode *node;
     strbuf xpath_expr,xpath_name;
     latan_errno status;
-    int thread;
+    int thread,ind;
+    const int mark[1] = {i_mat};
     
 #ifdef _OPENMP
     thread = omp_get_thread_num();
 #else
     thread = 0;
 #endif
-    status = LATAN_SUCCESS;
+    status  = LATAN_SUCCESS;
+    nodeset = NULL;
+    node    = NULL;
     
-    USTAT(xml_open_file_buf(fname,'r'));
-    if (strlen(name) == 0)
+    USTAT(xml_open_stream(&reader,fname));
+    if (reader != NULL)
     {
-        strbufcpy(xpath_name,"");
+        USTAT(xml_stream_find(&ind,reader,mark,1,name));
+        if (ind >= 0)
+        {
+            node = xmlTextReaderExpand(reader);
+        }
     }
     else
     {
-        sprintf(xpath_name,"[@name='%s']",name);
+        USTAT(xml_open_file_buf(fname,'r'));
+        if (FILE_BUF(thread) == NULL)
+        {
+            return status;
+        }
+        if (strlen(name) == 0)
+        {
+            strbufcpy(xpath_name,"");
+        }
+        else
+        {
+            sprintf(xpath_name,"[@name='%s']",name);
+        }
+        sprintf(xpath_expr,"/%s:%s/%s:%s%s",LATAN_XMLNS_PREF,\
+                xml_mark[i_main],LATAN_XMLNS_PREF,xml_mark[i_mat],xpath_name);
+        nodeset = xml_get_nodeset(xpath_expr,FILE_BUF(thread));
+        if ((nodeset != NULL)&&(nodeset->nodesetval != NULL)&&\
+            (nodeset->nodesetval->nodeNr > 0))
+        {
+            node = nodeset->nodesetval->nodeTab[0];
+        }
     }
-    sprintf(xpath_expr,"/%s:%s/%s:%s%s",LATAN_XMLNS_PREF,\
-            xml_mark[i_main],LATAN_XMLNS_PREF,xml_mark[i_mat],xpath_name);
-    nodeset = xml_get_nodeset(xpath_expr,FILE_BUF(thread));
-    if (nodeset->nodesetval != NULL)
+    if (node != NULL)
     {
-        if (m)
+        if (m&&sub)
         {
-            USTAT(xml_get_mat(m,nodeset->nodesetval->nodeTab[0]));
+            USTAT(xml_get_subm(m,node,sub[0],sub[1]));
+        }
+        else if (m)
+        {
+            USTAT(xml_get_mat(m,node));
         }
         if (dim) 
         {
-            USTAT(xml_get_mat_size(dim,nodeset->nodesetval->nodeTab[0]));
+            USTAT(xml_get_mat_size(dim,node));
         }
     }
-    else
+    if (nodeset != NULL)
+    {
+        xmlXPathFreeObject(nodeset);
+    }
+    if (reader != NULL)
+    {
+        xmlFreeTextReader(reader);
+    }
+    if (node == NULL)
     {
         strbuf errmsg,buf;
         
@@ -208,8 +424,6 @@ latan_errno mat_load_xml(mat *m, size_t *dim, const strbuf fname,\
         LATAN_ERROR(errmsg,LATAN_ELATSYN);
     }
     
-    xmlXPathFreeObject(nodeset);
-    
     return status;
 }
 
@@ -244,34 +458,69 @@ latan_errno randgen_load_state_xml(rg_state state, const strbuf fname,\
                                    const strbuf name)
 {
     xmlXPathObject *nodeset;
+    xmlTextReader *reader;
+    xmlNode *node;
     strbuf xpath_expr,xpath_name;
     latan_errno status;
-    int thread;
+    int thread,ind;
+    const int mark[1] = {i_rgstate};
 
 #ifdef _OPENMP
     thread = omp_get_thread_num();
 #else
     thread = 0;
 #endif
-    status = LATAN_SUCCESS;
+    status  = LATAN_SUCCESS;
+    nodeset = NULL;
+    node    = NULL;
 
-    USTAT(xml_open_file_buf(fname,'r'));
-    if (strlen(name) == 0)
+    USTAT(xml_open_stream(&reader,fname));
+    if (reader != NULL)
     {
-        strbufcpy(xpath_name,"");
+        USTAT(xml_stream_find(&ind,reader,mark,1,name));
+        if (ind >= 0)
+        {
+            node = xmlTextReaderExpand(reader);
+        }
     }
     else
     {
-        sprintf(xpath_name,"[@name='%s']",name);
+        USTAT(xml_open_file_buf(fname,'r'));
+        if (FILE_BUF(thread) == NULL)
+        {
+            return status;
+        }
+        if (strlen(name) == 0)
+        {
+            strbufcpy(xpath_name,"");
+        }
+        else
+        {
+            sprintf(xpath_name,"[@name='%s']",name);
+        }
+        sprintf(xpath_expr,"/%s:%s/%s:%s%s",LATAN_XMLNS_PREF,       \
+                xml_mark[i_main],LATAN_XMLNS_PREF,xml_mark[i_rgstate],\
+                xpath_name);
+        nodeset = xml_get_nodeset(xpath_expr,FILE_BUF(thread));
+        if ((nodeset != NULL)&&(nodeset->nodesetval != NULL)&&\
+            (nodeset->nodesetval->nodeNr > 0))
+        {
+            node = nodeset->nodesetval->nodeTab[0];
+        }
     }
-    sprintf(xpath_expr,"/%s:%s/%s:%s%s",LATAN_XMLNS_PREF,\
-            xml_mark[i_main],LATAN_XMLNS_PREF,xml_mark[i_rgstate],xpath_name);
-    nodeset = xml_get_nodeset(xpath_expr,FILE_BUF(thread));
-    if (nodeset->nodesetval != NULL)
+    if (node != NULL)
     {
-        USTAT(xml_get_rgstate(state,nodeset->nodesetval->nodeTab[0]));
+        USTAT(xml_get_rgstate(state,node));
     }
-    else
+    if (nodeset != NULL)
+    {
+        xmlXPathFreeObject(nodeset);
+    }
+    if (reader != NULL)
+    {
+        xmlFreeTextReader(reader);
+    }
+    if (node == NULL)
     {
         strbuf errmsg,buf;
         
@@ -287,8 +536,6 @@ latan_errno randgen_load_state_xml(rg_state state, const strbuf fname,\
         LATAN_ERROR(errmsg,LATAN_ELATSYN);
     }
 
-    xmlXPathFreeObject(nodeset);
-
     return status;
 }
 
@@ -321,48 +568,164 @@ latan_errno rs_sample_save_xml(const strbuf fname, const char mode,\
 
 latan_errno rs_sample_load_xml(rs_sample *s, size_t *nsample, size_t *dim,\
                                const strbuf fname, const strbuf name)
+{
+    return rs_sample_load_xml_gen(s,nsample,dim,fname,name,NULL);
+}
+
+latan_errno rs_sample_load_subsamp_xml(rs_sample *s, const strbuf fname,\
+                                       const strbuf name, const size_t k1,\
+                                       const size_t l1)
+{
+    size_t sub[2];
+    
+    sub[0] = k1;
+    sub[1] = l1;
+    
+    return rs_sample_load_xml_gen(s,NULL,NULL,fname,name,sub);
+}
+
+static latan_errno rs_sample_load_xml_gen(rs_sample *s, size_t *nsample,   \
+                                          size_t *dim, const strbuf fname, \
+                                          const strbuf name,               \
+                                          const size_t *sub)
 {
     xmlXPathObject *nodeset;
+    xmlTextReader *reader;
+    xmlNode *node;
     strbuf xpath_expr,xpath_name;
     latan_errno status;
-    int thread;
+    int thread,ind;
+    const int mark[2] = {i_sample,i_seed};
+    rs_seed sd;
+    bool got_attr;
     
 #ifdef _OPENMP
     thread = omp_get_thread_num();
 #else
     thread = 0;
 #endif
-    status = LATAN_SUCCESS;
+    status  = LATAN_SUCCESS;
+    nodeset = NULL;
+    node    = NULL;
+    ind     = -1;
 
-    USTAT(xml_open_file_buf(fname,'r'));
-    if (strlen(name) == 0)
+    reader  = xml_stream_buf_get(fname,name);
+    if (reader != NULL)
     {
-        strbufcpy(xpath_name,"");
+        ind = i_sample;
     }
     else
     {
-        sprintf(xpath_name,"[@name='%s']",name);
+        USTAT(xml_open_stream(&reader,fname));
+        if (reader != NULL)
+        {
+            USTAT(xml_stream_find(&ind,reader,mark,2,name));
+        }
     }
-    sprintf(xpath_expr,"/%s:%s/%s:%s%s",LATAN_XMLNS_PREF,  \
-            xml_mark[i_main],LATAN_XMLNS_PREF,xml_mark[i_sample],xpath_name);
-    nodeset = xml_get_nodeset(xpath_expr,FILE_BUF(thread));
-    if (nodeset->nodesetval != NULL)
+    if (reader != NULL)
     {
-        if (s)
+        /* samples are read one matrix at a time, a size query only reads the
+         * attributes of the sample and keeps the reader for the next load
+         * (rs_sample_load queries the size before loading) */
+        got_attr = false;
+        if (ind == i_sample)
         {
-            USTAT(xml_get_sample(s,nodeset->nodesetval->nodeTab[0]));
+            if (!s)
+            {
+                USTAT(xml_stream_get_sample_attr(&got_attr,nsample,dim,\
+                                                 reader));
+            }
+            if (got_attr)
+            {
+                xml_stream_buf_set(reader,fname,name);
+                reader = NULL;
+            }
+            else
+            {
+                USTAT(xml_stream_get_sample(s,nsample,dim,reader,sub));
+            }
         }
-        if (nsample) 
+        else if (ind == i_seed)
         {
-            USTAT(xml_get_sample_nsample(nsample,                        \
-                                         nodeset->nodesetval->nodeTab[0]));
+            node = xmlTextReaderExpand(reader);
+            if (node != NULL)
+            {
+                USTAT(xml_get_seed(&sd,node));
+            }
+            else
+            {
+                ind = -1;
+            }
         }
-        if (dim)
+    }
+    else
+    {
+        USTAT(xml_open_file_buf(fname,'r'));
+        if (FILE_BUF(thread) == NULL)
         {
-            USTAT(xml_get_sample_size(dim,nodeset->nodesetval->nodeTab[0]));
+            return status;
+        }
+        if (strlen(name) == 0)
+        {
+            strbufcpy(xpath_name,"");
+        }
+        else
+        {
+            sprintf(xpath_name,"[@name='%s']",name);
+        }
+        sprintf(xpath_expr,"/%s:%s/%s:%s%s",LATAN_XMLNS_PREF,      \
+                xml_mark[i_main],LATAN_XMLNS_PREF,xml_mark[i_sample],\
+                xpath_name);
+        nodeset = xml_get_nodeset(xpath_expr,FILE_BUF(thread));
+        if ((nodeset != NULL)&&(nodeset->nodesetval != NULL)&&\
+            (nodeset->nodesetval->nodeNr > 0))
+        {
+            node = nodeset->nodesetval->nodeTab[0];
+            ind  = i_sample;
+            if (s&&sub)
+            {
+                USTAT(xml_get_subsamp(s,node,sub[0],sub[1]));
+            }
+            else if (s)
+            {
+                USTAT(xml_get_sample(s,node));
+            }
+            if (nsample) 
+            {
+                USTAT(xml_get_sample_nsample(nsample,node));
+            }
+            if (dim)
+            {
+                USTAT(xml_get_sample_size(dim,node));
+            }
+        }
+        else
+        {
+            if (nodeset != NULL)
+            {
+                xmlXPathFreeObject(nodeset);
+            }
+            sprintf(xpath_expr,"/%s:%s/%s:%s%s",LATAN_XMLNS_PREF,    \
+                    xml_mark[i_main],LATAN_XMLNS_PREF,xml_mark[i_seed],\
+                    xpath_name);
+            nodeset = xml_get_nodeset(xpath_expr,FILE_BUF(thread));
+            if ((nodeset != NULL)&&(nodeset->nodesetval != NULL)&&\
+                (nodeset->nodesetval->nodeNr > 0))
+            {
+                ind = i_seed;
+                USTAT(xml_get_seed(&sd,nodeset->nodesetval->nodeTab[0]));
+            }
         }
     }
-    else
+    if (nodeset != NULL)
+    {
+        xmlXPathFreeObject(nodeset);
+    }
+    if (reader != NULL)
+    {
+        xmlFreeTextReader(reader);
+    }
+    if (ind < 0)
     {
         strbuf errmsg,buf;
         
@@ -377,8 +740,53 @@ latan_errno rs_sample_load_xml(rs_sample *s, size_t *nsample, size_t *dim,\
         sprintf(errmsg,"sample (name= %s) not found in file %s",buf,fname);
         LATAN_ERROR(errmsg,LATAN_ELATSYN);
     }
+    
+    /* seeded samples are rebuilt once the file buffer is not used anymore */
+    if (ind == i_seed)
+    {
+        if (s&&sub)
+        {
+            USTAT(rs_sample_from_seed_subsamp(s,&sd,sub[0],sub[1]));
+        }
+        else if (s)
+        {
+            USTAT(rs_sample_from_seed(s,&sd));
+        }
+        if (nsample)
+        {
+            *nsample = sd.nsample;
+        }
+        if (dim)
+        {
+            dim[0] = sd.dim[0];
+            dim[1] = sd.dim[1];
+        }
+    }
+
+    return status;
+}
+
+latan_errno rs_seed_save_xml(const strbuf fname, const char mode,\
+                             const rs_seed *sd, const strbuf name)
+{
+    latan_errno status;
+    int thread;
+    
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#else
+    thread = 0;
+#endif
 
-    xmlXPathFreeObject(nodeset);
+    if ((mode == 'w')||(mode == 'a'))
+    {
+        status = xml_open_file_buf(fname,mode);
+    }
+    else
+    {
+        LATAN_ERROR("unknown or read-only file mode",LATAN_EINVAL);
+    }
+    xml_insert_seed(FILE_BUF(thread)->root,sd,name);
 
     return status;
 }
@@ -23,6 +23,7 @@
 #include <latan/latan_globals.h>
 #include <latan/latan_mat.h>
 #include <latan/latan_statistics.h>
+#include <latan/latan_io.h>
 
 /* I/O init/finish */
 void io_init_xml(void);
@@ -35,6 +36,8 @@ latan_errno mat_load_dim_xml(size_t dim[2], const strbuf fname,\
                              const strbuf name);
 latan_errno mat_load_xml(mat *m, size_t *dim, const strbuf fname,\
                          const strbuf name);
+latan_errno mat_load_subm_xml(mat *m, const strbuf fname, const strbuf name,\
+                              const size_t k1, const size_t l1);
 
 /* random generator state I/O */
 latan_errno randgen_save_state_xml(const strbuf f_name, const char mode,
@@ -47,5 +50,10 @@ latan_errno rs_sample_save_xml(const strbuf fname, const char mode,\
                                const rs_sample *s, const strbuf name);
 latan_errno rs_sample_load_xml(rs_sample *s, size_t *nsample, size_t *dim,\
                                const strbuf fname, const strbuf name);
+latan_errno rs_sample_load_subsamp_xml(rs_sample *s, const strbuf fname,\
+                                       const strbuf name, const size_t k1,\
+                                       const size_t l1);
+latan_errno rs_seed_save_xml(const strbuf fname, const char mode,\
+                             const rs_seed *sd, const strbuf name);
 
 #endif
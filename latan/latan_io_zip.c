@@ -0,0 +1,582 @@
+/* latan_io_zip.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#define _GNU_SOURCE /* fopencookie is used here */
+
+#include <latan/latan_io.h>
+#include <latan/latan_includes.h>
+#include <errno.h>
+#if (defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN))
+#if (defined(HAVE_LIBZ) && defined(HAVE_ZLIB_H))
+#include <zlib.h>
+#define ZIP_USE_GZ
+#endif
+#if (defined(HAVE_LIBZSTD) && defined(HAVE_ZSTD_H))
+#include <zstd.h>
+#define ZIP_USE_ZSTD
+#endif
+#endif
+
+#ifndef ZSTD_LEVEL
+#define ZSTD_LEVEL 3
+#endif
+#define ZIP_SKIP_SIZE 16384
+
+/*                        compressed streams (internal)                     */
+/****************************************************************************/
+/* the (de)compression is done on the fly through a stdio stream with custom
+ * callbacks, a stream is either read-only or write-only and it can only be
+ * positioned in read mode : going backward restarts the decompression from
+ * the beginning of the file and going forward decompresses and discards the
+ * data in between */
+typedef enum
+{
+    zip_none = 0,
+    zip_gz   = 1,
+    zip_zstd = 2
+} zip_no;
+
+static const char *zip_ext[3] = {"",".gz",".zst"};
+
+#ifdef ZIP_USE_GZ
+#define ZIP_HAS_GZ true
+#else
+#define ZIP_HAS_GZ false
+#endif
+#ifdef ZIP_USE_ZSTD
+#define ZIP_HAS_ZSTD true
+#else
+#define ZIP_HAS_ZSTD false
+#endif
+
+static const bool zip_is_avail[3] = {true,ZIP_HAS_GZ,ZIP_HAS_ZSTD};
+
+#if (defined(ZIP_USE_GZ) || defined(ZIP_USE_ZSTD))
+typedef struct
+{
+    zip_no type;
+    char mode;
+    long pos;
+#ifdef ZIP_USE_GZ
+    gzFile gz;
+#endif
+#ifdef ZIP_USE_ZSTD
+    FILE *f;
+    ZSTD_CStream *cs;
+    ZSTD_DStream *ds;
+    ZSTD_inBuffer in;
+    unsigned char *buf;
+    size_t buf_size;
+    size_t ds_left; /* last ZSTD_decompressStream return, 0 at frame end */
+    bool is_full;
+#endif
+} zip_file;
+
+static zip_file * zip_open(const char *fname, const zip_no type,\
+                           const char mode);
+static long zip_read(zip_file *zf, char *buf, const size_t n);
+static long zip_write(zip_file *zf, const char *buf, const size_t n);
+static int zip_seek(zip_file *zf, long *offset, const int whence);
+static int zip_close(zip_file *zf);
+#endif
+static zip_no zip_get_type(const char *fname);
+
+static zip_no zip_get_type(const char *fname)
+{
+    size_t len,ext_len;
+    int i;
+
+    len = strlen(fname);
+    for (i=zip_gz;i<=zip_zstd;i++)
+    {
+        ext_len = strlen(zip_ext[i]);
+        if ((len > ext_len)&&(strcmp(fname+len-ext_len,zip_ext[i]) == 0))
+        {
+            return (zip_no)i;
+        }
+    }
+
+    return zip_none;
+}
+
+#if (defined(ZIP_USE_GZ) || defined(ZIP_USE_ZSTD))
+static zip_file * zip_open(const char *fname, const zip_no type,\
+                           const char mode)
+{
+    zip_file *zf;
+    char smode[3];
+
+    zf = (zip_file *)(malloc(sizeof(zip_file)));
+    if (zf == NULL)
+    {
+        return NULL;
+    }
+    zf->type = type;
+    zf->mode = mode;
+    zf->pos  = 0;
+    smode[0] = mode;
+    smode[1] = 'b';
+    smode[2] = '\0';
+    switch (type)
+    {
+#ifdef ZIP_USE_GZ
+        case zip_gz:
+            zf->gz = gzopen(fname,smode);
+            if (zf->gz == NULL)
+            {
+                free(zf);
+                return NULL;
+            }
+            break;
+#endif
+#ifdef ZIP_USE_ZSTD
+        case zip_zstd:
+            zf->f = fopen(fname,smode);
+            if (zf->f == NULL)
+            {
+                free(zf);
+                return NULL;
+            }
+            zf->cs       = NULL;
+            zf->ds       = NULL;
+            zf->in.src   = NULL;
+            zf->in.size  = 0;
+            zf->in.pos   = 0;
+            zf->ds_left  = 0;
+            zf->is_full  = false;
+            if (mode == 'r')
+            {
+                zf->ds       = ZSTD_createDStream();
+                zf->buf_size = ZSTD_DStreamInSize();
+                if (zf->ds != NULL)
+                {
+                    ZSTD_initDStream(zf->ds);
+                }
+            }
+            else
+            {
+                zf->cs       = ZSTD_createCStream();
+                zf->buf_size = ZSTD_CStreamOutSize();
+                if (zf->cs != NULL)
+                {
+                    ZSTD_initCStream(zf->cs,ZSTD_LEVEL);
+                }
+            }
+            zf->buf    = (unsigned char *)(malloc(zf->buf_size));
+            zf->in.src = zf->buf;
+            if ((zf->buf == NULL)||((zf->cs == NULL)&&(zf->ds == NULL)))
+            {
+                zip_close(zf);
+                return NULL;
+            }
+            break;
+#endif
+        default:
+            free(zf);
+            return NULL;
+    }
+
+    return zf;
+}
+
+static long zip_read(zip_file *zf, char *buf, const size_t n)
+{
+    long nread;
+
+    if (zf->mode != 'r')
+    {
+        errno = EBADF;
+        return -1;
+    }
+    nread = -1;
+    switch (zf->type)
+    {
+#ifdef ZIP_USE_GZ
+        case zip_gz:
+            nread = (long)gzread(zf->gz,buf,(unsigned)n);
+            break;
+#endif
+#ifdef ZIP_USE_ZSTD
+        case zip_zstd:
+        {
+            ZSTD_outBuffer out;
+            size_t ret;
+
+            out.dst  = buf;
+            out.size = n;
+            out.pos  = 0;
+            while (out.pos < out.size)
+            {
+                /* when the output was full the decoder may still hold data,
+                 * it is flushed before reading more input */
+                if ((zf->in.pos == zf->in.size)&&(!zf->is_full))
+                {
+                    zf->in.size = fread(zf->buf,1,zf->buf_size,zf->f);
+                    zf->in.pos  = 0;
+                    if (zf->in.size == 0)
+                    {
+                        if (ferror(zf->f))
+                        {
+                            return -1;
+                        }
+                        /* end of file in the middle of a frame */
+                        if (zf->ds_left != 0)
+                        {
+                            errno = EIO;
+                            return -1;
+                        }
+                        break;
+                    }
+                }
+                ret = ZSTD_decompressStream(zf->ds,&out,&(zf->in));
+                if (ZSTD_isError(ret))
+                {
+                    errno = EIO;
+                    return -1;
+                }
+                zf->ds_left = ret;
+                zf->is_full = (out.pos == out.size);
+            }
+            nread = (long)(out.pos);
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+    if (nread > 0)
+    {
+        zf->pos += nread;
+    }
+
+    return nread;
+}
+
+static long zip_write(zip_file *zf, const char *buf, const size_t n)
+{
+    long nwrite;
+
+    if (zf->mode == 'r')
+    {
+        errno = EBADF;
+        return -1;
+    }
+    nwrite = -1;
+    switch (zf->type)
+    {
+#ifdef ZIP_USE_GZ
+        case zip_gz:
+            nwrite = (n > 0) ? (long)gzwrite(zf->gz,buf,(unsigned)n) : 0;
+            if (nwrite == 0)
+            {
+                nwrite = (n > 0) ? -1 : 0;
+            }
+            break;
+#endif
+#ifdef ZIP_USE_ZSTD
+        case zip_zstd:
+        {
+            ZSTD_inBuffer in;
+            ZSTD_outBuffer out;
+            size_t ret;
+
+            in.src = buf;
+            in.size = n;
+            in.pos  = 0;
+            while (in.pos < in.size)
+            {
+                out.dst  = zf->buf;
+                out.size = zf->buf_size;
+                out.pos  = 0;
+                ret      = ZSTD_compressStream(zf->cs,&out,&in);
+                if (ZSTD_isError(ret))
+                {
+                    errno = EIO;
+                    return -1;
+                }
+                if (fwrite(zf->buf,1,out.pos,zf->f) != out.pos)
+                {
+                    return -1;
+                }
+            }
+            nwrite = (long)n;
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+    if (nwrite > 0)
+    {
+        zf->pos += nwrite;
+    }
+
+    return nwrite;
+}
+
+static int zip_seek(zip_file *zf, long *offset, const int whence)
+{
+    long target,nread,nskip;
+    char skip[ZIP_SKIP_SIZE];
+
+    switch (whence)
+    {
+        case SEEK_SET:
+            target = *offset;
+            break;
+        case SEEK_CUR:
+            target = zf->pos + *offset;
+            break;
+        default:
+            errno = EINVAL;
+            return -1;
+    }
+    if (target == zf->pos)
+    {
+        *offset = zf->pos;
+        return 0;
+    }
+    if ((zf->mode != 'r')||(target < 0))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    if (target < zf->pos)
+    {
+        switch (zf->type)
+        {
+#ifdef ZIP_USE_GZ
+            case zip_gz:
+                if (gzrewind(zf->gz) != 0)
+                {
+                    errno = EIO;
+                    return -1;
+                }
+                break;
+#endif
+#ifdef ZIP_USE_ZSTD
+            case zip_zstd:
+                if (fseek(zf->f,0,SEEK_SET) != 0)
+                {
+                    return -1;
+                }
+                ZSTD_initDStream(zf->ds);
+                zf->in.size = 0;
+                zf->in.pos  = 0;
+                zf->ds_left = 0;
+                zf->is_full = false;
+                break;
+#endif
+            default:
+                break;
+        }
+        zf->pos = 0;
+    }
+    while (zf->pos < target)
+    {
+        nskip = target - zf->pos;
+        nskip = (nskip < ZIP_SKIP_SIZE) ? nskip : ZIP_SKIP_SIZE;
+        nread = zip_read(zf,skip,(size_t)nskip);
+        if (nread <= 0)
+        {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    *offset = zf->pos;
+
+    return 0;
+}
+
+static int zip_close(zip_file *zf)
+{
+    int status;
+
+    status = 0;
+    switch (zf->type)
+    {
+#ifdef ZIP_USE_GZ
+        case zip_gz:
+            status = (gzclose(zf->gz) == Z_OK) ? 0 : EOF;
+            break;
+#endif
+#ifdef ZIP_USE_ZSTD
+        case zip_zstd:
+            if ((zf->cs != NULL)&&(zf->buf != NULL))
+            {
+                ZSTD_outBuffer out;
+                size_t ret;
+
+                do
+                {
+                    out.dst  = zf->buf;
+                    out.size = zf->buf_size;
+                    out.pos  = 0;
+                    ret      = ZSTD_endStream(zf->cs,&out);
+                    if (ZSTD_isError(ret)||\
+                        (fwrite(zf->buf,1,out.pos,zf->f) != out.pos))
+                    {
+                        status = EOF;
+                        break;
+                    }
+                } while (ret != 0);
+            }
+            ZSTD_freeCStream(zf->cs);
+            ZSTD_freeDStream(zf->ds);
+            free(zf->buf);
+            if (fclose(zf->f) != 0)
+            {
+                status = EOF;
+            }
+            break;
+#endif
+        default:
+            break;
+    }
+    free(zf);
+
+    return status;
+}
+
+/* stdio callbacks */
+#ifdef HAVE_FOPENCOOKIE
+static ssize_t zip_cookie_read(void *cookie, char *buf, size_t n)
+{
+    long nread;
+
+    nread = zip_read((zip_file *)cookie,buf,n);
+
+    return (ssize_t)nread;
+}
+
+static ssize_t zip_cookie_write(void *cookie, const char *buf, size_t n)
+{
+    long nwrite;
+
+    nwrite = zip_write((zip_file *)cookie,buf,n);
+
+    return (nwrite < 0) ? 0 : (ssize_t)nwrite;
+}
+
+static int zip_cookie_seek(void *cookie, off64_t *offset, int whence)
+{
+    long loffset;
+
+    loffset = (long)(*offset);
+    if (zip_seek((zip_file *)cookie,&loffset,whence) != 0)
+    {
+        return -1;
+    }
+    *offset = (off64_t)loffset;
+
+    return 0;
+}
+
+static int zip_cookie_close(void *cookie)
+{
+    return zip_close((zip_file *)cookie);
+}
+#else
+static int zip_cookie_read(void *cookie, char *buf, int n)
+{
+    return (int)zip_read((zip_file *)cookie,buf,(size_t)n);
+}
+
+static int zip_cookie_write(void *cookie, const char *buf, int n)
+{
+    return (int)zip_write((zip_file *)cookie,buf,(size_t)n);
+}
+
+static fpos_t zip_cookie_seek(void *cookie, fpos_t offset, int whence)
+{
+    long loffset;
+
+    loffset = (long)offset;
+    if (zip_seek((zip_file *)cookie,&loffset,whence) != 0)
+    {
+        return (fpos_t)(-1);
+    }
+
+    return (fpos_t)loffset;
+}
+
+static int zip_cookie_close(void *cookie)
+{
+    return zip_close((zip_file *)cookie);
+}
+#endif
+#endif
+
+/*                          compressed file opening                         */
+/****************************************************************************/
+size_t io_zip_ext_len(const char *fname)
+{
+    return strlen(zip_ext[zip_get_type(fname)]);
+}
+
+FILE * io_fopen(const char *fname, const char *mode)
+{
+    zip_no type;
+    FILE *f;
+
+    type = zip_get_type(fname);
+    f    = NULL;
+    if (!zip_is_avail[type])
+    {
+        strbuf errmsg;
+
+        sprintf(errmsg,"%s compression is not supported in this build (%s)",\
+                zip_ext[type],fname);
+        LATAN_WARNING(errmsg,LATAN_EINVAL);
+    }
+    else if (type == zip_none)
+    {
+        f = fopen(fname,mode);
+    }
+#if (defined(ZIP_USE_GZ) || defined(ZIP_USE_ZSTD))
+    else if ((mode[0] == 'r')||(mode[0] == 'w')||(mode[0] == 'a'))
+    {
+        zip_file *zf;
+
+        zf = zip_open(fname,type,mode[0]);
+        if (zf != NULL)
+        {
+#ifdef HAVE_FOPENCOOKIE
+            cookie_io_functions_t io;
+
+            io.read  = &zip_cookie_read;
+            io.write = &zip_cookie_write;
+            io.seek  = &zip_cookie_seek;
+            io.close = &zip_cookie_close;
+            f        = fopencookie(zf,(mode[0] == 'r') ? "r" : "w",io);
+#else
+            f = funopen(zf,(mode[0] == 'r') ? &zip_cookie_read : NULL,\
+                        (mode[0] == 'r') ? NULL : &zip_cookie_write,  \
+                        &zip_cookie_seek,&zip_cookie_close);
+#endif
+            if (f == NULL)
+            {
+                zip_close(zf);
+            }
+        }
+    }
+#endif
+
+    return f;
+}
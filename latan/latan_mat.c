@@ -390,13 +390,39 @@ latan_errno mat_cst(mat *m, const double x)
     return LATAN_SUCCESS;
 }
 
+/* matrices are filled in one call if their rows are contiguous, row by row
+ * else */
 void mat_rand_u(mat *m, const double a, const double b)
 {
-    size_t i,j;
+    size_t i;
 
-    FOR_VAL(m,i,j)
+    if (m->data_cpu->tda == ncol(m))
+    {
+        rand_u_fill(m->data_cpu->data,nel(m),a,b);
+    }
+    else
     {
-        mat_set(m,i,j,rand_u(a,b));
+        for (i=0;i<nrow(m);i++)
+        {
+            rand_u_fill(gsl_matrix_ptr(m->data_cpu,i,0),ncol(m),a,b);
+        }
+    }
+}
+
+void mat_rand_n(mat *m, const double mean, const double sigma)
+{
+    size_t i;
+
+    if (m->data_cpu->tda == ncol(m))
+    {
+        rand_n_fill(m->data_cpu->data,nel(m),mean,sigma);
+    }
+    else
+    {
+        for (i=0;i<nrow(m);i++)
+        {
+            rand_n_fill(gsl_matrix_ptr(m->data_cpu,i,0),ncol(m),mean,sigma);
+        }
     }
 }
 
@@ -959,3 +985,52 @@ latan_errno mat_pseudoinv(mat *m, const mat *n)
     return status;
 }
 
+latan_errno mat_cholesky(mat *l, const mat *n)
+{
+    gsl_error_handler_t *gsl_handler;
+    int gsl_status;
+    size_t i,j;
+    
+    if (!mat_is_square(n))
+    {
+        LATAN_ERROR("Cholesky decomposition of a non-square matrix",\
+                    LATAN_ENOTSQR);
+    }
+    if (!mat_is_samedim(l,n))
+    {
+        LATAN_ERROR("matrix and Cholesky factor dimension mismatch",\
+                    LATAN_EBADLEN);
+    }
+    
+    if (l != n)
+    {
+        mat_cp(l,n);
+    }
+    /* the GSL error handler is global, it is switched off only around the
+     * decomposition and one thread at a time */
+#ifdef _OPENMP
+    #pragma omp critical(latan_gsl_error_handler)
+#endif
+    {
+        gsl_handler = gsl_set_error_handler_off();
+        gsl_status  = gsl_linalg_cholesky_decomp(l->data_cpu);
+        gsl_set_error_handler(gsl_handler);
+    }
+    if (gsl_status == GSL_EDOM)
+    {
+        return LATAN_EDOM;
+    }
+    else if (gsl_status != GSL_SUCCESS)
+    {
+        LATAN_ERROR(gsl_strerror(gsl_status),LATAN_FAILURE);
+    }
+    for (i=0;i<nrow(l);i++)
+    for (j=i+1;j<ncol(l);j++)
+    {
+        mat_set(l,i,j,0.0);
+    }
+    mat_reset_assump(l);
+    
+    return LATAN_SUCCESS;
+}
+
@@ -96,6 +96,7 @@ void mat_get_sind(size_t *sind, const mat *m);
 void mat_zero(mat *m);
 latan_errno mat_cst(mat *m, const double x);
 void mat_rand_u(mat *m, const double a, const double b);
+void mat_rand_n(mat *m, const double mean, const double sigma);
 void mat_id(mat *m);
 latan_errno mat_cp(mat *m, const mat *n);
 latan_errno mat_sum(mat *m, const mat *n);
@@ -132,6 +133,10 @@ latan_errno mat_inv_LU(mat *m, const mat *n);
 latan_errno mat_inv_symChol(mat *m, const mat *n);
 #define mat_eqpseudoinv(m) mat_pseudoinv(m,m);
 latan_errno mat_pseudoinv(mat *m, const mat *n);
+/*** lower triangular l such that n = l*t(l), returns LATAN_EDOM without
+ *   calling the error handler if n is not positive definite ***/
+#define mat_eqcholesky(m) mat_cholesky(m,m)
+latan_errno mat_cholesky(mat *l, const mat *n);
 
 __END_DECLS
 
@@ -42,8 +42,10 @@ typedef struct
 {
     void *param;
     min_func *f;
+    min_dfunc *df;
     gsl_vector *scale;
     gsl_vector *buf_gsl_f;
+    gsl_vector *buf_gsl_f_i;
 } gsl_f_eval_param;
 
 typedef struct
@@ -77,15 +79,12 @@ double gsl_f_i(double v_i, void *v_gfi_param)
     double f_val;
     
     gfi_param = (gsl_f_i_param*)v_gfi_param;
-    
-    v_mod = gsl_vector_alloc(gfi_param->v->size);
+    v_mod     = gfi_param->gf_param->buf_gsl_f_i;
     
     gsl_vector_memcpy(v_mod,gfi_param->v);
     gsl_vector_set(v_mod,gfi_param->i,v_i);
     f_val = gsl_f(v_mod,gfi_param->gf_param);
     
-    gsl_vector_free(v_mod);
-    
     return f_val;
 }
 
@@ -95,8 +94,31 @@ void gsl_df(const gsl_vector *v, void *v_gf_param, gsl_vector *df)
     double dfodvi, dummy;
     gsl_function s_gsl_f_i;
     gsl_f_i_param gfi_param;
+    gsl_f_eval_param *gf_param;
+    mat x,dfdx;
+    gsl_matrix_view x_mview,dfdx_mview;
+    
+    gf_param = (gsl_f_eval_param*)v_gf_param;
+    
+    /* analytic gradient, rescaled to the minimizer variables */
+    if (gf_param->df != NULL)
+    {
+        gsl_vector_memcpy(gf_param->buf_gsl_f,v);
+        gsl_vector_mul(gf_param->buf_gsl_f,gf_param->scale);
+        x_mview          = gsl_matrix_view_vector(gf_param->buf_gsl_f,v->size,1);
+        x.data_cpu       = &(x_mview.matrix);
+        x.prop_flag      = MAT_GEN;
+        dfdx_mview       = gsl_matrix_view_vector(df,df->size,1);
+        dfdx.data_cpu    = &(dfdx_mview.matrix);
+        dfdx.prop_flag   = MAT_GEN;
+        gf_param->df(&dfdx,&x,gf_param->param);
+        gsl_vector_mul(df,gf_param->scale);
+        
+        return;
+    }
     
-    gfi_param.gf_param = (gsl_f_eval_param*)v_gf_param;
+    /* numerical gradient */
+    gfi_param.gf_param = gf_param;
     gfi_param.v        = v;
     s_gsl_f_i.function = &gsl_f_i;
     s_gsl_f_i.params   = &gfi_param;
@@ -117,7 +139,7 @@ void gsl_fdf(const gsl_vector *v, void *v_gf_param, double *f, gsl_vector *df)
 }
 
 latan_errno minimize_gsl(mat *x, const mat *x_limit, double *f_min,\
-                         min_func *f, void *param)
+                         min_func *f, min_dfunc *df, void *param)
 {
     latan_errno status;
     size_t n;
@@ -144,6 +166,7 @@ latan_errno minimize_gsl(mat *x, const mat *x_limit, double *f_min,\
     iter                    = 0u;
     max_iteration           = minimizer_get_max_iteration();
     gf_param.f              = f;
+    gf_param.df             = df;
     gf_param.param          = param;
     gsl_min_func_fdf.f      = &gsl_f;
     gsl_min_func_fdf.df     = &gsl_df;
@@ -181,8 +204,9 @@ latan_errno minimize_gsl(mat *x, const mat *x_limit, double *f_min,\
                         LATAN_EINVAL);
     }
     
-    gf_param.scale     = gsl_vector_alloc(n);
-    gf_param.buf_gsl_f = gsl_vector_alloc(n);
+    gf_param.scale       = gsl_vector_alloc(n);
+    gf_param.buf_gsl_f   = gsl_vector_alloc(n);
+    gf_param.buf_gsl_f_i = gsl_vector_alloc(n);
     gsl_x              = gsl_vector_alloc(n);
     step_size          = gsl_vector_alloc(n);
     one                = gsl_vector_alloc(n);
@@ -260,6 +284,7 @@ latan_errno minimize_gsl(mat *x, const mat *x_limit, double *f_min,\
     
     gsl_vector_free(gf_param.scale);
     gsl_vector_free(gf_param.buf_gsl_f);
+    gsl_vector_free(gf_param.buf_gsl_f_i);
     gsl_vector_free(gsl_x);
     gsl_vector_free(step_size);
     gsl_vector_free(one);
@@ -27,7 +27,7 @@
 __BEGIN_DECLS
 
 latan_errno minimize_gsl(mat *x, const mat *x_limit, double *f_min,\
-                         min_func *f, void *param);
+                         min_func *f, min_dfunc *df, void *param);
 
 __END_DECLS
 
@@ -0,0 +1,351 @@
+/* latan_min_lsq.c, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <latan/latan_min_lsq.h>
+#include <latan/latan_includes.h>
+#include <latan/latan_blas.h>
+#include <latan/latan_math.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+
+#define DIFF_PREC    1.0e-8
+#define X_CVG_PREC   1.0e-10
+#define F_CVG_PREC   1.0e-10
+#define G_CVG_PREC   1.0e-10
+#define INIT_DAMP    1.0e-3
+
+static void num_jac(mat *J, mat *x, const mat *r_x, mat *r_buf,\
+                    min_res_func *r, void *param);
+static void set_normal_eq(mat *A, mat *g, const mat *J, const mat *r_x);
+static bool project_limit(mat *x, const mat *x_limit);
+static bool is_active_limit(const mat *x, const mat *x_limit, const mat *g,\
+                            const size_t i);
+
+/* forward difference jacobian, x is restored on exit */
+static void num_jac(mat *J, mat *x, const mat *r_x, mat *r_buf,\
+                    min_res_func *r, void *param)
+{
+    size_t i,j;
+    double x_j,h;
+
+    for (j=0;j<nrow(x);j++)
+    {
+        x_j = mat_get(x,j,0);
+        h   = DIFF_PREC*MAX(fabs(x_j),1.0);
+        h   = (x_j + h) - x_j;
+        mat_set(x,j,0,x_j+h);
+        r(r_buf,x,param);
+        mat_set(x,j,0,x_j);
+        for (i=0;i<nrow(r_x);i++)
+        {
+            mat_set(J,i,j,(mat_get(r_buf,i,0)-mat_get(r_x,i,0))/h);
+        }
+    }
+}
+
+/* A = t(J)*J and g = t(J)*r */
+static void set_normal_eq(mat *A, mat *g, const mat *J, const mat *r_x)
+{
+    size_t i,j;
+
+    latan_blas_dsyrk('l','t',1.0,J,0.0,A);
+    for (i=0;i<nrow(A);i++)
+    for (j=i+1;j<ncol(A);j++)
+    {
+        mat_set(A,i,j,mat_get(A,j,i));
+    }
+    latan_blas_dgemv('t',1.0,J,r_x,0.0,g);
+}
+
+/* project x onto the box defined by the limits, the lower limit is in
+ * column 0, the upper one in column 1 and NaN means no limit ; return true
+ * if x was modified */
+static bool project_limit(mat *x, const mat *x_limit)
+{
+    size_t i;
+    double x_i,l_i;
+    bool is_proj;
+    
+    is_proj = false;
+    if (x_limit == NULL)
+    {
+        return is_proj;
+    }
+    for (i=0;i<nrow(x);i++)
+    {
+        x_i = mat_get(x,i,0);
+        l_i = mat_get(x_limit,i,0);
+        if (!latan_isnan(l_i)&&(x_i < l_i))
+        {
+            x_i     = l_i;
+            is_proj = true;
+        }
+        l_i = mat_get(x_limit,i,1);
+        if (!latan_isnan(l_i)&&(x_i > l_i))
+        {
+            x_i     = l_i;
+            is_proj = true;
+        }
+        mat_set(x,i,0,x_i);
+    }
+    
+    return is_proj;
+}
+
+/* is parameter i on one of its limits with the gradient g pointing
+ * outside ? */
+static bool is_active_limit(const mat *x, const mat *x_limit, const mat *g,\
+                            const size_t i)
+{
+    double l_i;
+    
+    if (x_limit == NULL)
+    {
+        return false;
+    }
+    l_i = mat_get(x_limit,i,0);
+    if (!latan_isnan(l_i)&&(mat_get(x,i,0) <= l_i)&&(mat_get(g,i,0) > 0.0))
+    {
+        return true;
+    }
+    l_i = mat_get(x_limit,i,1);
+    if (!latan_isnan(l_i)&&(mat_get(x,i,0) >= l_i)&&(mat_get(g,i,0) < 0.0))
+    {
+        return true;
+    }
+    
+    return false;
+}
+
+/* Levenberg-Marquardt minimization of f(x) = t(r(x))*r(x) :
+ * ---------------------------------------------------------
+ *
+ * each iteration solves (t(J)*J + lambda*D)*h = -t(J)*r with a Cholesky
+ * decomposition, where D is the largest diagonal of t(J)*J met so far ; the
+ * step is accepted if f decreases and the damping lambda is updated from
+ * the ratio between the actual and the predicted decrease (Nielsen's
+ * strategy)
+ *
+ * with limits (NaN meaning no limit, as with MINUIT), the parameters on a
+ * limit with the gradient pointing outside are kept fixed for the
+ * iteration, the starting point and each trial point are projected onto the
+ * limits and the predicted decrease is then the one of the projected step
+ *
+ */
+latan_errno minimize_lm(mat *x, const mat *x_limit, double *f_min,\
+                        const size_t nres, min_res_func *r, min_jac_func *J,\
+                        void *param)
+{
+    latan_errno status;
+    size_t n;
+    size_t i,j;
+    unsigned int iter,max_iteration;
+    latan_errno chol_status;
+    mat *r_x,*r_new,*r_tmp,*jac,*x_new,*A,*Ad,*Ah,*D,*g,*h;
+    gsl_vector_view h_vview;
+    double f,f_new,lambda,nu,rho,pred,g_max,buf;
+    bool is_cvg,is_proj;
+
+    if ((x_limit != NULL)&&((nrow(x_limit) != nrow(x))||(ncol(x_limit) < 2)))
+    {
+        LATAN_ERROR("limit matrix dimensions do not match the parameters",\
+                    LATAN_EBADLEN);
+    }
+
+    status        = LATAN_SUCCESS;
+    n             = nrow(x);
+    iter          = 0u;
+    max_iteration = minimizer_get_max_iteration();
+    is_cvg        = false;
+    nu            = 2.0;
+
+    r_x   = mat_create(nres,1);
+    r_new = mat_create(nres,1);
+    jac   = mat_create(nres,n);
+    x_new = mat_create(n,1);
+    A     = mat_create(n,n);
+    Ad    = mat_create(n,n);
+    Ah    = mat_create(n,1);
+    D     = mat_create(n,1);
+    g     = mat_create(n,1);
+    h     = mat_create(n,1);
+    h_vview = gsl_matrix_column(h->data_cpu,0);
+
+    project_limit(x,x_limit);
+    r(r_x,x,param);
+    latan_blas_ddot(r_x,r_x,&f);
+    if (J != NULL)
+    {
+        J(jac,x,param);
+    }
+    else
+    {
+        num_jac(jac,x,r_x,r_new,r,param);
+    }
+    set_normal_eq(A,g,jac,r_x);
+    lambda = 0.0;
+    for (i=0;i<n;i++)
+    {
+        buf = mat_get(A,i,i);
+        mat_set(D,i,0,(buf > 0.0) ? buf : 1.0);
+        lambda = MAX(lambda,buf);
+    }
+    lambda = (lambda > 0.0) ? INIT_DAMP*lambda : INIT_DAMP;
+    while ((!is_cvg)&&(iter < max_iteration))
+    {
+        iter++;
+        /* convergence on the gradient */
+        g_max = 0.0;
+        for (i=0;i<n;i++)
+        {
+            if (!is_active_limit(x,x_limit,g,i))
+            {
+                g_max = MAX(g_max,fabs(mat_get(g,i,0)));
+            }
+        }
+        if (g_max <= G_CVG_PREC*MAX(f,1.0))
+        {
+            is_cvg = true;
+            break;
+        }
+        /* damped normal equations */
+        mat_cp(Ad,A);
+        for (i=0;i<n;i++)
+        {
+            mat_set(Ad,i,i,mat_get(A,i,i)+lambda*mat_get(D,i,0));
+        }
+        mat_muls(h,g,-1.0);
+        for (i=0;i<n;i++)
+        {
+            if (is_active_limit(x,x_limit,g,i))
+            {
+                for (j=0;j<n;j++)
+                {
+                    mat_set(Ad,i,j,0.0);
+                    mat_set(Ad,j,i,0.0);
+                }
+                mat_set(Ad,i,i,1.0);
+                mat_set(h,i,0,0.0);
+            }
+        }
+        chol_status = mat_eqcholesky(Ad);
+        if (chol_status == LATAN_SUCCESS)
+        {
+            gsl_blas_dtrsv(CblasLower,CblasNoTrans,CblasNonUnit,Ad->data_cpu,\
+                           &(h_vview.vector));
+            gsl_blas_dtrsv(CblasLower,CblasTrans,CblasNonUnit,Ad->data_cpu,\
+                           &(h_vview.vector));
+        }
+        else
+        {
+            lambda *= nu;
+            nu     *= 2.0;
+            continue;
+        }
+        /* trial step, projected onto the limits */
+        mat_add(x_new,x,h);
+        is_proj = project_limit(x_new,x_limit);
+        if (is_proj)
+        {
+            mat_sub(h,x_new,x);
+        }
+        /* convergence on the step size */
+        if (latan_blas_dnrm2(h) <= X_CVG_PREC*(latan_blas_dnrm2(x)+X_CVG_PREC))
+        {
+            is_cvg = true;
+            break;
+        }
+        r(r_new,x_new,param);
+        latan_blas_ddot(r_new,r_new,&f_new);
+        pred = 0.0;
+        if (is_proj)
+        {
+            /* f - |r + J*h|^2 = -2*t(g)*h - t(h)*A*h */
+            latan_blas_dgemv('n',1.0,A,h,0.0,Ah);
+            for (i=0;i<n;i++)
+            {
+                buf   = mat_get(h,i,0);
+                pred -= buf*(2.0*mat_get(g,i,0)+mat_get(Ah,i,0));
+            }
+        }
+        else
+        {
+            for (i=0;i<n;i++)
+            {
+                buf   = mat_get(h,i,0);
+                pred += buf*(lambda*mat_get(D,i,0)*buf-mat_get(g,i,0));
+            }
+        }
+        rho = (pred > 0.0) ? (f - f_new)/pred : -1.0;
+        if (rho > 0.0)
+        {
+            is_cvg = (f - f_new <= F_CVG_PREC*f);
+            mat_cp(x,x_new);
+            r_tmp  = r_x;
+            r_x    = r_new;
+            r_new  = r_tmp;
+            f      = f_new;
+            if (J != NULL)
+            {
+                J(jac,x,param);
+            }
+            else
+            {
+                num_jac(jac,x,r_x,r_new,r,param);
+            }
+            set_normal_eq(A,g,jac,r_x);
+            for (i=0;i<n;i++)
+            {
+                buf = mat_get(A,i,i);
+                mat_set(D,i,0,MAX(mat_get(D,i,0),buf));
+            }
+            buf     = 2.0*rho - 1.0;
+            lambda *= MAX(1.0/3.0,1.0-buf*buf*buf);
+            nu      = 2.0;
+        }
+        else
+        {
+            lambda *= nu;
+            nu     *= 2.0;
+        }
+        latan_printf(DEBUG2,"------ iteration %d\n",iter);
+        latan_printf(DEBUG2,"f(x)= %10.6f lambda= %10.4e\n",f,lambda);
+    }
+    if (!is_cvg)
+    {
+        LATAN_WARNING("least-squares minimizer reached the maximum number of iterations",\
+                      LATAN_FAILURE);
+        status = LATAN_FAILURE;
+    }
+    *f_min = f;
+
+    mat_destroy(r_x);
+    mat_destroy(r_new);
+    mat_destroy(jac);
+    mat_destroy(x_new);
+    mat_destroy(A);
+    mat_destroy(Ad);
+    mat_destroy(Ah);
+    mat_destroy(D);
+    mat_destroy(g);
+    mat_destroy(h);
+
+    return status;
+}
@@ -0,0 +1,35 @@
+/* latan_min_lsq.h, part of LatAnalyze library
+ *
+ * Copyright (C) 2010, 2011, 2012 Antonin Portelli
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef LATAN_MIN_LSQ_H_
+#define LATAN_MIN_LSQ_H_
+
+#include <latan/latan_globals.h>
+#include <latan/latan_mat.h>
+#include <latan/latan_minimizer.h>
+
+__BEGIN_DECLS
+
+latan_errno minimize_lm(mat *x, const mat *x_limit, double *f_min,\
+                        const size_t nres, min_res_func *r, min_jac_func *J,\
+                        void *param);
+
+__END_DECLS
+
+#endif
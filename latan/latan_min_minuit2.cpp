@@ -25,6 +25,7 @@
 #include <utility>
 #include <vector>
 #include <Minuit2/FCNBase.h>
+#include <Minuit2/FCNGradientBase.h>
 #include <Minuit2/VariableMetricMinimizer.h>
 #include <Minuit2/SimplexMinimizer.h>
 #include <Minuit2/ScanMinimizer.h>
@@ -34,6 +35,7 @@
 #include <Minuit2/MnPlot.h>
 #include <Minuit2/MnScan.h>
 #include <Minuit2/MnSimplex.h>
+#include <gsl/gsl_matrix.h>
 
 #ifndef INIT_RERROR
 #define INIT_RERROR 0.5
@@ -67,32 +69,85 @@ Minuit2MinFunc::~Minuit2MinFunc(void)
 {
 }
 
+/* the vectors given by MINUIT are wrapped in matrix views, nothing is
+ * allocated or shared between calls so the adapters are thread-safe */
+static void vector_view(mat *m, gsl_matrix_view *m_view,\
+                        const vector<double>& v)
+{
+    *m_view      = gsl_matrix_view_array(const_cast<double *>(&v[0]),\
+                                         v.size(),1);
+    m->data_cpu  = &(m_view->matrix);
+    m->prop_flag = MAT_GEN;
+}
+
 double Minuit2MinFunc::operator()(const vector<double>& v_x) const 
 {
-    size_t i;
-    double res;
-    mat *x_buf;
+    mat x;
+    gsl_matrix_view x_view;
     
-    x_buf = mat_create(v_x.size(),1);
+    vector_view(&x,&x_view,v_x);
     
-    for (i=0;i<nrow(x_buf);i++)
-    {
-        mat_set(x_buf,i,0,v_x[i]);
-    }
-    res = f(x_buf,param);
+    return f(&x,param);
+}
+
+double Minuit2MinFunc::Up(void) const
+{
+    return 1.0;
+}
+
+class Minuit2MinGradFunc: public FCNGradientBase
+{
+public:
+    Minuit2MinGradFunc(min_func *init_f, min_dfunc *init_df, void *init_param);
+    ~Minuit2MinGradFunc(void);
+    
+    virtual double operator()(const vector<double>& v_var) const;
+    virtual vector<double> Gradient(const vector<double>& v_var) const;
+    virtual double Up(void) const;
+    
+private:
+    Minuit2MinFunc F;
+    min_dfunc *df;
+    void *param;
+};
+
+Minuit2MinGradFunc::Minuit2MinGradFunc(min_func *init_f, min_dfunc *init_df,\
+                                       void *init_param)
+: F(init_f,init_param)
+{
+    df    = init_df;
+    param = init_param;
+}
+
+Minuit2MinGradFunc::~Minuit2MinGradFunc(void)
+{
+}
+
+double Minuit2MinGradFunc::operator()(const vector<double>& v_x) const
+{
+    return F(v_x);
+}
+
+vector<double> Minuit2MinGradFunc::Gradient(const vector<double>& v_x) const
+{
+    vector<double> v_df(v_x.size());
+    mat x,dfdx;
+    gsl_matrix_view x_view,dfdx_view;
     
-    mat_destroy(x_buf);
+    vector_view(&x,&x_view,v_x);
+    vector_view(&dfdx,&dfdx_view,v_df);
+    df(&dfdx,&x,param);
     
-    return res;
+    return v_df;
 }
 
-double Minuit2MinFunc::Up(void) const
+double Minuit2MinGradFunc::Up(void) const
 {
     return 1.0;
 }
 
 latan_errno minimize_minuit2(mat *x, const mat *x_limit, double *f_min,\
-                             min_func *f, void *param)
+                             min_func *f, min_dfunc *df, void *param)
 {
     latan_errno status;
     strbuf buf;
@@ -103,6 +158,7 @@ latan_errno minimize_minuit2(mat *x, const mat *x_limit, double *f_min,\
     bool is_xl_l_nan,is_xl_u_nan;
     MnUserParameters Init_x;
     MnApplication *Minimizer;
+    MnMigrad *Migrad2;
   
     status        = LATAN_SUCCESS;
     ndim          = nrow(x);
@@ -133,6 +189,7 @@ latan_errno minimize_minuit2(mat *x, const mat *x_limit, double *f_min,\
     }
 
     Minuit2MinFunc F(f,param);
+    Minuit2MinGradFunc G(f,df,param);
     MnSimplex Simplex1(F,Init_x,0);
     Minimizer = &Simplex1;
     latan_printf(DEBUG2,"(MINUIT) Minimizing...\n");
@@ -152,22 +209,31 @@ latan_errno minimize_minuit2(mat *x, const mat *x_limit, double *f_min,\
         Init_x.SetValue((unsigned int)i,x_i);
         Init_x.SetError((unsigned int)i,err_i);
     }
-    MnMigrad Migrad2(F,Init_x,2);
+    if (df != NULL)
+    {
+        Migrad2 = new MnMigrad(G,Init_x,2);
+    }
+    else
+    {
+        Migrad2 = new MnMigrad(F,Init_x,2);
+    }
     MnSimplex Simplex2(F,Init_x,2);
     switch (minimizer_get_alg())
     {
         case MIN_MIGRAD:
-            Minimizer = &Migrad2;
+            Minimizer = Migrad2;
             break;
         case MIN_SIMPLEX:
             Minimizer = &Simplex2;
             break;
         default:
+            delete Migrad2;
             LATAN_ERROR("invalid MINUIT minimization algorithm flag",
                         LATAN_EINVAL);
             break;
     }
     Min = (*Minimizer)();
+    delete Migrad2;
     for (i=0;i<ndim;i++)
     {
         x_i = Min.UserParameters().Parameter((unsigned int)i).Value();
@@ -20,6 +20,7 @@
 #include <latan/latan_minimizer.h>
 #include <latan/latan_includes.h>
 #include <latan/latan_min_gsl.h>
+#include <latan/latan_min_lsq.h>
 #ifdef HAVE_MINUIT2
 #include <latan/latan_min_minuit2.h>
 #endif
@@ -34,7 +35,8 @@ static const strbuf minalg_id[NMINALG] =
     "GSL_VEC_BFGS"  ,\
     "GSL_SIMPLEX_NM",\
     "MIN_MIGRAD"    ,\
-    "MIN_SIMPLEX"   
+    "MIN_SIMPLEX"   ,\
+    "LSQ_LM"
 };
 
 minalg_no minalg_no_get(const strbuf m_id)
@@ -114,6 +116,11 @@ latan_errno minimizer_set_alg(minalg_no alg)
         env.lib = MINUIT;
         env.alg = alg;
     }
+    else if (alg == LSQ_LM)
+    {
+        env.lib = LSQ;
+        env.alg = alg;
+    }
     else
     {
         LATAN_ERROR("minimization algorithm flag invalid",LATAN_EINVAL);
@@ -145,6 +152,9 @@ latan_errno minimizer_get_alg_name(strbuf name)
         case MIN_SIMPLEX:
             strbufcpy(name,"simplex (MINUIT)");
             break;
+        case LSQ_LM:
+            strbufcpy(name,"Levenberg-Marquardt least-squares");
+            break;
         default:
             LATAN_ERROR("minimization algorithm flag invalid",LATAN_EINVAL);
             break;
@@ -167,24 +177,37 @@ void minimizer_set_max_iteration(unsigned int max_iteration)
 /****************************************************************************/
 latan_errno minimize(mat *x, const mat *x_limit, double *f_min, min_func *f,\
                      void *param)
+{
+    return minimize_grad(x,x_limit,f_min,f,NULL,param);
+}
+
+/* df is the analytic gradient of f, NULL to let the minimizer estimate it
+ * numerically when needed */
+latan_errno minimize_grad(mat *x, const mat *x_limit, double *f_min,\
+                          min_func *f, min_dfunc *df, void *param)
 {
     latan_errno status;
     strbuf name;
     
     minimizer_get_alg_name(name);
-    latan_printf(VERB,"minimizing using %s algorithm...\n",name);
+    latan_printf(VERB,"minimizing using %s algorithm%s...\n",name,\
+                 (df != NULL) ? " with analytic gradient" : "");
     switch (minimizer_get_lib())
     {
         case GSL:
-            status = minimize_gsl(x,x_limit,f_min,f,param);
+            status = minimize_gsl(x,x_limit,f_min,f,df,param);
             break;
         case MINUIT:
 #ifdef HAVE_MINUIT2
-            status = minimize_minuit2(x,x_limit,f_min,f,param);
+            status = minimize_minuit2(x,x_limit,f_min,f,df,param);
 #else
             LATAN_ERROR("MINUIT support was not compiled",LATAN_EINVAL);
 #endif
             break;
+        case LSQ:
+            LATAN_ERROR("least-squares algorithm needs a residual function",\
+                        LATAN_EINVAL);
+            break;
         default:
             LATAN_ERROR("minimizing library flag invalid",LATAN_EINVAL);
             break;
@@ -192,3 +215,17 @@ latan_errno minimize(mat *x, const mat *x_limit, double *f_min, min_func *f,\
     return status;
 }
 
+/* r is the residual vector function of size nres, J its jacobian, NULL to
+ * let the minimizer estimate it numerically */
+latan_errno minimize_lsq(mat *x, const mat *x_limit, double *f_min,\
+                         const size_t nres, min_res_func *r, min_jac_func *J,\
+                         void *param)
+{
+    latan_errno status;
+    
+    latan_printf(VERB,"minimizing using Levenberg-Marquardt least-squares algorithm%s...\n",\
+                 (J != NULL) ? " with analytic jacobian" : "");
+    status = minimize_lm(x,x_limit,f_min,nres,r,J,param);
+    
+    return status;
+}
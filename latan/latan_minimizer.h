@@ -29,11 +29,12 @@ __BEGIN_DECLS
 typedef enum
 {
     GSL    = 0,\
-    MINUIT = 1
+    MINUIT = 1,\
+    LSQ    = 2
 } minlib_no;
 
 /* minization algorithms */
-#define NMINALG 6
+#define NMINALG 7
 typedef enum
 {
     GSL_GRAD_FR    = 0,\
@@ -41,7 +42,8 @@ typedef enum
     GSL_VEC_BFGS   = 2,\
     GSL_SIMPLEX_NM = 3,\
     MIN_MIGRAD     = 4,\
-    MIN_SIMPLEX    = 5
+    MIN_SIMPLEX    = 5,\
+    LSQ_LM         = 6
 } minalg_no;
 
 minalg_no minalg_no_get(const strbuf m_id);
@@ -55,12 +57,23 @@ latan_errno minimizer_get_alg_name(strbuf name);
 unsigned int minimizer_get_max_iteration(void);
 void minimizer_set_max_iteration(unsigned int max_iteration);
 
-/* prototype of function to minimize */
+/* prototype of function to minimize and of its gradient */
 typedef double min_func(const mat *x, void *param);
+typedef void min_dfunc(mat *df, const mat *x, void *param);
+
+/* prototype of residual function for least-squares minimization
+ * (f = t(r)*r) and of its jacobian */
+typedef void min_res_func(mat *r, const mat *x, void *param);
+typedef void min_jac_func(mat *J, const mat *x, void *param);
 
 /* the minimizer */
 latan_errno minimize(mat *x, const mat *x_limit, double *f_min, min_func *f,\
                      void *param);
+latan_errno minimize_grad(mat *x, const mat *x_limit, double *f_min,\
+                          min_func *f, min_dfunc *df, void *param);
+latan_errno minimize_lsq(mat *x, const mat *x_limit, double *f_min,\
+                         const size_t nres, min_res_func *r, min_jac_func *J,\
+                         void *param);
 
 __END_DECLS
 
@@ -21,6 +21,146 @@
 #include <latan/latan_includes.h>
 #include <latan/latan_math.h>
 
+/*                              model helpers                               */
+/****************************************************************************/
+/* exp(-m*t+A) and its derivative with respect to m */
+static void exp_term(double *f, double *dfdm, const double m, const double A,\
+                     const double t)
+{
+    *f    = exp(-m*t+A);
+    *dfdm = -t*(*f);
+}
+
+/* exp(A)*(exp(-m*t)+exp(-m*(nt-t))) and its derivative with respect to m */
+static void cosh_term(double *f, double *dfdm, const double m, const double A,\
+                      const double t, const double nt)
+{
+    double e1,e2;
+    
+    e1    = exp(A-m*t);
+    e2    = exp(A-m*(nt-t));
+    *f    = e1 + e2;
+    *dfdm = -t*e1 - (nt-t)*e2;
+}
+
+static double get_nt(void *vnt)
+{
+    return (vnt) ? (double)(*((size_t *)(vnt))) : 0.0;
+}
+
+/* batch evaluation of sum_j exp(A_j)*exp(-m_j*t) (+exp(-m_j*(nt-t)) if
+ * is_cosh) on the first row of x; the points are processed in blocks of
+ * EXP_BLOCK, on evenly spaced points exp(-m_j*t) is computed once per
+ * block and multiplied by the precomputed exp(-m_j*k*dt), so that the inner
+ * loops are plain loops over contiguous arrays which can be vectorised ;
+ * the factorization is only used if |m_j*dt|*EXP_BLOCK <= EXP_MAX_ARG, so
+ * that the factors neither overflow nor lose the result to an underflow,
+ * the exponentials are computed directly otherwise (e.g. for the large
+ * masses tried by a minimizer) */
+#define MAX_TERM 2
+#define EXP_BLOCK 32
+#define EXP_MAX_ARG 64.0
+
+static bool is_evenly_spaced(const double *t, const size_t n)
+{
+    size_t i;
+    double dt,t_i;
+    
+    if (n < 2)
+    {
+        return false;
+    }
+    dt = t[1] - t[0];
+    for (i=2;i<n;i++)
+    {
+        t_i = t[0] + ((double)(i))*dt;
+        if (fabs(t[i]-t_i) > DBL_EPSILON*16.0*MAX(1.0,fabs(t_i)))
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+static void exp_batch(mat *res, const mat *x, const double *m,\
+                      const double *A, const size_t nterm, const bool is_cosh,\
+                      const double nt)
+{
+    size_t i,j,k,n,nb,stride;
+    double pf[MAX_TERM][EXP_BLOCK],pb[MAX_TERM][EXP_BLOCK];
+    double blk[EXP_BLOCK];
+    double dt,ef,eb;
+    const double *t;
+    double *r;
+    bool even,fact[MAX_TERM];
+    
+    n      = ncol(x);
+    t      = x->data_cpu->data;
+    r      = res->data_cpu->data;
+    stride = res->data_cpu->tda;
+    even   = is_evenly_spaced(t,n);
+    dt     = even ? t[1] - t[0] : 0.0;
+    
+    for (j=0;j<nterm;j++)
+    {
+        fact[j] = even&&(fabs(m[j]*dt)*(double)(EXP_BLOCK) <= EXP_MAX_ARG);
+        if (fact[j])
+        {
+            for (k=0;k<EXP_BLOCK;k++)
+            {
+                pf[j][k] = exp(-m[j]*dt*(double)(k));
+                pb[j][k] = exp(m[j]*dt*(double)(k));
+            }
+        }
+    }
+    for (i=0;i<n;i+=EXP_BLOCK)
+    {
+        nb = MIN(EXP_BLOCK,n-i);
+        for (k=0;k<nb;k++)
+        {
+            blk[k] = 0.0;
+        }
+        for (j=0;j<nterm;j++)
+        {
+            if (fact[j])
+            {
+                ef = exp(A[j]-m[j]*t[i]);
+                for (k=0;k<nb;k++)
+                {
+                    blk[k] += ef*pf[j][k];
+                }
+                if (is_cosh)
+                {
+                    eb = exp(A[j]-m[j]*(nt-t[i]));
+                    for (k=0;k<nb;k++)
+                    {
+                        blk[k] += eb*pb[j][k];
+                    }
+                }
+            }
+            else
+            {
+                for (k=0;k<nb;k++)
+                {
+                    blk[k] += exp(A[j]-m[j]*t[i+k]);
+                }
+                if (is_cosh)
+                {
+                    for (k=0;k<nb;k++)
+                    {
+                        blk[k] += exp(A[j]-m[j]*(nt-t[i+k]));
+                    }
+                }
+            }
+        }
+        for (k=0;k<nb;k++)
+        {
+            r[(i+k)*stride] = blk[k];
+        }
+    }
+}
+
 /*                              1D models                                   */
 /****************************************************************************/
 /** 1D polynomial models **/
@@ -31,13 +171,27 @@ static double fm_const_func(const mat *X __dumb, const mat *p,\
 }
 
 
+static void fm_const_dfunc(mat *df, const mat *X __dumb, const mat *p __dumb,\
+                           void *nothing __dumb)
+{
+    mat_set(df,0,0,1.0);
+}
+
+static void fm_const_batch(mat *res, const mat *X __dumb, const mat *p,\
+                           void *nothing __dumb)
+{
+    mat_cst(res,mat_get(p,0,0));
+}
+
 fit_model fm_const =
 {
     "y(x) = p0",
     {&fm_const_func},
     &npar_1,
     1,
-    1
+    1,
+    {&fm_const_dfunc},
+    {&fm_const_batch}
 };
 
 /** exponential decay **/
@@ -53,13 +207,35 @@ static double fm_expdec_func(const mat *x, const mat *p, void *nothing __dumb)
     return res;
 }
 
+static void fm_expdec_dfunc(mat *df, const mat *x, const mat *p,\
+                            void *nothing __dumb)
+{
+    double f,dfdm;
+    
+    exp_term(&f,&dfdm,mat_get(p,0,0),mat_get(p,1,0),mat_get(x,0,0));
+    mat_set(df,0,0,dfdm);
+    mat_set(df,1,0,f);
+}
+
+static void fm_expdec_batch(mat *res, const mat *x, const mat *p,\
+                            void *nothing __dumb)
+{
+    double m[1],A[1];
+    
+    m[0] = mat_get(p,0,0);
+    A[0] = mat_get(p,1,0);
+    exp_batch(res,x,m,A,1,false,0.0);
+}
+
 fit_model fm_expdec = 
 {
     "y(x) = exp(-p0*x+p1)",
     {&fm_expdec_func},
     &npar_2,
     1,
-    1
+    1,
+    {&fm_expdec_dfunc},
+    {&fm_expdec_batch}
 };
 
 static double fm_expdec_ex_func(const mat *x, const mat *p,\
@@ -77,13 +253,41 @@ static double fm_expdec_ex_func(const mat *x, const mat *p,\
     return res;
 }
 
+static void fm_expdec_ex_dfunc(mat *df, const mat *x, const mat *p,\
+                               void *nothing __dumb)
+{
+    double f1,dfdm1,f2,dfdm2,t;
+    
+    t = mat_get(x,0,0);
+    exp_term(&f1,&dfdm1,mat_get(p,0,0),mat_get(p,2,0),t);
+    exp_term(&f2,&dfdm2,mat_get(p,1,0),mat_get(p,3,0),t);
+    mat_set(df,0,0,dfdm1);
+    mat_set(df,1,0,dfdm2);
+    mat_set(df,2,0,f1);
+    mat_set(df,3,0,f2);
+}
+
+static void fm_expdec_ex_batch(mat *res, const mat *x, const mat *p,\
+                               void *nothing __dumb)
+{
+    double m[2],A[2];
+    
+    m[0] = mat_get(p,0,0);
+    m[1] = mat_get(p,1,0);
+    A[0] = mat_get(p,2,0);
+    A[1] = mat_get(p,3,0);
+    exp_batch(res,x,m,A,2,false,0.0);
+}
+
 fit_model fm_expdec_ex = 
 {
     "y(x) = exp(-p0*x+p2) + exp(-p1*x+p3))",
     {&fm_expdec_ex_func},
     &npar_4,
     1,
-    1
+    1,
+    {&fm_expdec_ex_dfunc},
+    {&fm_expdec_ex_batch}
 };
 
 static double fm_expdec_splitsum_func0(const mat *x, const mat *p,\
@@ -114,13 +318,61 @@ static double fm_expdec_splitsum_func1(const mat *x, const mat *p,\
     return res;
 }
 
+static void fm_expdec_splitsum_dfunc0(mat *df, const mat *x, const mat *p,\
+                                      void *nothing __dumb)
+{
+    double f,dfdm;
+    
+    exp_term(&f,&dfdm,mat_get(p,0,0)+0.5*mat_get(p,1,0),mat_get(p,2,0),\
+             mat_get(x,0,0));
+    mat_set(df,0,0,dfdm);
+    mat_set(df,1,0,0.5*dfdm);
+    mat_set(df,2,0,f);
+    mat_set(df,3,0,0.0);
+}
+
+static void fm_expdec_splitsum_dfunc1(mat *df, const mat *x, const mat *p,\
+                                      void *nothing __dumb)
+{
+    double f,dfdm;
+    
+    exp_term(&f,&dfdm,mat_get(p,0,0)-0.5*mat_get(p,1,0),mat_get(p,3,0),\
+             mat_get(x,0,0));
+    mat_set(df,0,0,dfdm);
+    mat_set(df,1,0,-0.5*dfdm);
+    mat_set(df,2,0,0.0);
+    mat_set(df,3,0,f);
+}
+
+static void fm_expdec_splitsum_batch0(mat *res, const mat *x, const mat *p,\
+                                      void *nothing __dumb)
+{
+    double m[1],A[1];
+    
+    m[0] = mat_get(p,0,0) + 0.5*mat_get(p,1,0);
+    A[0] = mat_get(p,2,0);
+    exp_batch(res,x,m,A,1,false,0.0);
+}
+
+static void fm_expdec_splitsum_batch1(mat *res, const mat *x, const mat *p,\
+                                      void *nothing __dumb)
+{
+    double m[1],A[1];
+    
+    m[0] = mat_get(p,0,0) - 0.5*mat_get(p,1,0);
+    A[0] = mat_get(p,3,0);
+    exp_batch(res,x,m,A,1,false,0.0);
+}
+
 fit_model fm_expdec_splitsum = 
 {
     "y0(x) = exp(-(p0-0.5*p1)*x+p2), y1(x) = exp(-(p0+0.5*p1)*x+p3)",
     {&fm_expdec_splitsum_func0,&fm_expdec_splitsum_func1},
     &npar_4,
     1,
-    2
+    2,
+    {&fm_expdec_splitsum_dfunc0,&fm_expdec_splitsum_dfunc1},
+    {&fm_expdec_splitsum_batch0,&fm_expdec_splitsum_batch1}
 };
 
 static double fm_expdec_ex_splitsum_func0(const mat *x, const mat *p,\
@@ -157,13 +409,71 @@ static double fm_expdec_ex_splitsum_func1(const mat *x, const mat *p,\
     return res;
 }
 
+static void fm_expdec_ex_splitsum_dfunc0(mat *df, const mat *x, const mat *p,\
+                                         void *nothing __dumb)
+{
+    double f1,dfdm1,f2,dfdm2,t;
+    
+    t = mat_get(x,0,0);
+    exp_term(&f1,&dfdm1,mat_get(p,0,0)+0.5*mat_get(p,1,0),mat_get(p,4,0),t);
+    exp_term(&f2,&dfdm2,mat_get(p,2,0),mat_get(p,6,0),t);
+    mat_zero(df);
+    mat_set(df,0,0,dfdm1);
+    mat_set(df,1,0,0.5*dfdm1);
+    mat_set(df,2,0,dfdm2);
+    mat_set(df,4,0,f1);
+    mat_set(df,6,0,f2);
+}
+
+static void fm_expdec_ex_splitsum_dfunc1(mat *df, const mat *x, const mat *p,\
+                                         void *nothing __dumb)
+{
+    double f1,dfdm1,f2,dfdm2,t;
+    
+    t = mat_get(x,0,0);
+    exp_term(&f1,&dfdm1,mat_get(p,0,0)-0.5*mat_get(p,1,0),mat_get(p,5,0),t);
+    exp_term(&f2,&dfdm2,mat_get(p,3,0),mat_get(p,7,0),t);
+    mat_zero(df);
+    mat_set(df,0,0,dfdm1);
+    mat_set(df,1,0,-0.5*dfdm1);
+    mat_set(df,3,0,dfdm2);
+    mat_set(df,5,0,f1);
+    mat_set(df,7,0,f2);
+}
+
+static void fm_expdec_ex_splitsum_batch0(mat *res, const mat *x,\
+                                         const mat *p, void *nothing __dumb)
+{
+    double m[2],A[2];
+    
+    m[0] = mat_get(p,0,0) + 0.5*mat_get(p,1,0);
+    m[1] = mat_get(p,2,0);
+    A[0] = mat_get(p,4,0);
+    A[1] = mat_get(p,6,0);
+    exp_batch(res,x,m,A,2,false,0.0);
+}
+
+static void fm_expdec_ex_splitsum_batch1(mat *res, const mat *x,\
+                                         const mat *p, void *nothing __dumb)
+{
+    double m[2],A[2];
+    
+    m[0] = mat_get(p,0,0) - 0.5*mat_get(p,1,0);
+    m[1] = mat_get(p,3,0);
+    A[0] = mat_get(p,5,0);
+    A[1] = mat_get(p,7,0);
+    exp_batch(res,x,m,A,2,false,0.0);
+}
+
 fit_model fm_expdec_ex_splitsum = 
 {
     "y0(x) = exp(-(p0-0.5*p1)*x+p3)+exp(-p2*x+p5), y1(x) = exp(-(p0+0.5*p1)*x+p4)+exp(-p2*x+p6)",
     {&fm_expdec_ex_splitsum_func0,&fm_expdec_ex_splitsum_func1},
     &npar_8,
     1,
-    2
+    2,
+    {&fm_expdec_ex_splitsum_dfunc0,&fm_expdec_ex_splitsum_dfunc1},
+    {&fm_expdec_ex_splitsum_batch0,&fm_expdec_ex_splitsum_batch1}
 };
 
 /** hyperbolic cosine **/
@@ -189,13 +499,34 @@ static double fm_cosh_func(const mat *x, const mat *p, void *vnt)
     return res;
 }
 
+static void fm_cosh_dfunc(mat *df, const mat *x, const mat *p, void *vnt)
+{
+    double f,dfdm;
+    
+    cosh_term(&f,&dfdm,mat_get(p,0,0),mat_get(p,1,0),mat_get(x,0,0),\
+              get_nt(vnt));
+    mat_set(df,0,0,dfdm);
+    mat_set(df,1,0,f);
+}
+
+static void fm_cosh_batch(mat *res, const mat *x, const mat *p, void *vnt)
+{
+    double m[1],A[1];
+    
+    m[0] = mat_get(p,0,0);
+    A[0] = mat_get(p,1,0);
+    exp_batch(res,x,m,A,1,true,get_nt(vnt));
+}
+
 fit_model fm_cosh =
 {
     "y(x) = exp(p1)*(exp(-p0*x)+exp(-p0*(nt-x)))",
     {&fm_cosh_func},
     &npar_2,
     1,
-    1
+    1,
+    {&fm_cosh_dfunc},
+    {&fm_cosh_batch}
 };
 
 static double fm_cosh_ex_func(const mat *x, const mat *p, void *vnt)
@@ -223,13 +554,40 @@ static double fm_cosh_ex_func(const mat *x, const mat *p, void *vnt)
     return res;
 }
 
+static void fm_cosh_ex_dfunc(mat *df, const mat *x, const mat *p, void *vnt)
+{
+    double f1,dfdm1,f2,dfdm2,t,nt;
+    
+    t  = mat_get(x,0,0);
+    nt = get_nt(vnt);
+    cosh_term(&f1,&dfdm1,mat_get(p,0,0),mat_get(p,2,0),t,nt);
+    cosh_term(&f2,&dfdm2,mat_get(p,1,0),mat_get(p,3,0),t,nt);
+    mat_set(df,0,0,dfdm1);
+    mat_set(df,1,0,dfdm2);
+    mat_set(df,2,0,f1);
+    mat_set(df,3,0,f2);
+}
+
+static void fm_cosh_ex_batch(mat *res, const mat *x, const mat *p, void *vnt)
+{
+    double m[2],A[2];
+    
+    m[0] = mat_get(p,0,0);
+    m[1] = mat_get(p,1,0);
+    A[0] = mat_get(p,2,0);
+    A[1] = mat_get(p,3,0);
+    exp_batch(res,x,m,A,2,true,get_nt(vnt));
+}
+
 fit_model fm_cosh_ex =
 {
     "y(x) = exp(p2)*(exp(-p0*x)+exp(-p0*(nt-x))) + exp(p3)*(exp(-p1*x)+exp(-p1*(nt-x)))",
     {&fm_cosh_ex_func},
     &npar_4,
     1,
-    1
+    1,
+    {&fm_cosh_ex_dfunc},
+    {&fm_cosh_ex_batch}
 };
 
 static double fm_cosh_splitsum_func0(const mat *x, const mat *p,\
@@ -284,13 +642,61 @@ static double fm_cosh_splitsum_func1(const mat *x, const mat *p,\
     return res;
 }
 
+static void fm_cosh_splitsum_dfunc0(mat *df, const mat *x, const mat *p,\
+                                    void *vnt)
+{
+    double f,dfdm;
+    
+    cosh_term(&f,&dfdm,mat_get(p,0,0)+0.5*mat_get(p,1,0),mat_get(p,2,0),\
+              mat_get(x,0,0),get_nt(vnt));
+    mat_set(df,0,0,dfdm);
+    mat_set(df,1,0,0.5*dfdm);
+    mat_set(df,2,0,f);
+    mat_set(df,3,0,0.0);
+}
+
+static void fm_cosh_splitsum_dfunc1(mat *df, const mat *x, const mat *p,\
+                                    void *vnt)
+{
+    double f,dfdm;
+    
+    cosh_term(&f,&dfdm,mat_get(p,0,0)-0.5*mat_get(p,1,0),mat_get(p,3,0),\
+              mat_get(x,0,0),get_nt(vnt));
+    mat_set(df,0,0,dfdm);
+    mat_set(df,1,0,-0.5*dfdm);
+    mat_set(df,2,0,0.0);
+    mat_set(df,3,0,f);
+}
+
+static void fm_cosh_splitsum_batch0(mat *res, const mat *x, const mat *p,\
+                                    void *vnt)
+{
+    double m[1],A[1];
+    
+    m[0] = mat_get(p,0,0) + 0.5*mat_get(p,1,0);
+    A[0] = mat_get(p,2,0);
+    exp_batch(res,x,m,A,1,true,get_nt(vnt));
+}
+
+static void fm_cosh_splitsum_batch1(mat *res, const mat *x, const mat *p,\
+                                    void *vnt)
+{
+    double m[1],A[1];
+    
+    m[0] = mat_get(p,0,0) - 0.5*mat_get(p,1,0);
+    A[0] = mat_get(p,3,0);
+    exp_batch(res,x,m,A,1,true,get_nt(vnt));
+}
+
 fit_model fm_cosh_splitsum = 
 {
     "y0(x) = exp(p2)*(exp(-(p0-0.5*p1)*x)+exp(-(p0-0.5*p1)*(nt-x))), y1(x) = exp(p3)*(exp(-(p0+0.5*p1)*x)+exp(-(p0+0.5*p1)*(nt-x)))",
     {&fm_cosh_splitsum_func0,&fm_cosh_splitsum_func1},
     &npar_4,
     1,
-    2
+    2,
+    {&fm_cosh_splitsum_dfunc0,&fm_cosh_splitsum_dfunc1},
+    {&fm_cosh_splitsum_batch0,&fm_cosh_splitsum_batch1}
 };
 
 static double fm_cosh_ex_splitsum_func0(const mat *x, const mat *p,\
@@ -351,11 +757,73 @@ static double fm_cosh_ex_splitsum_func1(const mat *x, const mat *p,\
     return res;
 }
 
+static void fm_cosh_ex_splitsum_dfunc0(mat *df, const mat *x, const mat *p,\
+                                       void *vnt)
+{
+    double f1,dfdm1,f2,dfdm2,t,nt;
+    
+    t  = mat_get(x,0,0);
+    nt = get_nt(vnt);
+    cosh_term(&f1,&dfdm1,mat_get(p,0,0)+0.5*mat_get(p,1,0),mat_get(p,4,0),\
+              t,nt);
+    cosh_term(&f2,&dfdm2,mat_get(p,2,0),mat_get(p,6,0),t,nt);
+    mat_zero(df);
+    mat_set(df,0,0,dfdm1);
+    mat_set(df,1,0,0.5*dfdm1);
+    mat_set(df,2,0,dfdm2);
+    mat_set(df,4,0,f1);
+    mat_set(df,6,0,f2);
+}
+
+static void fm_cosh_ex_splitsum_dfunc1(mat *df, const mat *x, const mat *p,\
+                                       void *vnt)
+{
+    double f1,dfdm1,f2,dfdm2,t,nt;
+    
+    t  = mat_get(x,0,0);
+    nt = get_nt(vnt);
+    cosh_term(&f1,&dfdm1,mat_get(p,0,0)-0.5*mat_get(p,1,0),mat_get(p,5,0),\
+              t,nt);
+    cosh_term(&f2,&dfdm2,mat_get(p,3,0),mat_get(p,7,0),t,nt);
+    mat_zero(df);
+    mat_set(df,0,0,dfdm1);
+    mat_set(df,1,0,-0.5*dfdm1);
+    mat_set(df,3,0,dfdm2);
+    mat_set(df,5,0,f1);
+    mat_set(df,7,0,f2);
+}
+
+static void fm_cosh_ex_splitsum_batch0(mat *res, const mat *x, const mat *p,\
+                                       void *vnt)
+{
+    double m[2],A[2];
+    
+    m[0] = mat_get(p,0,0) + 0.5*mat_get(p,1,0);
+    m[1] = mat_get(p,2,0);
+    A[0] = mat_get(p,4,0);
+    A[1] = mat_get(p,6,0);
+    exp_batch(res,x,m,A,2,true,get_nt(vnt));
+}
+
+static void fm_cosh_ex_splitsum_batch1(mat *res, const mat *x, const mat *p,\
+                                       void *vnt)
+{
+    double m[2],A[2];
+    
+    m[0] = mat_get(p,0,0) - 0.5*mat_get(p,1,0);
+    m[1] = mat_get(p,3,0);
+    A[0] = mat_get(p,5,0);
+    A[1] = mat_get(p,7,0);
+    exp_batch(res,x,m,A,2,true,get_nt(vnt));
+}
+
 fit_model fm_cosh_ex_splitsum = 
 {
     "y0(x) = exp(p4)*(exp(-(p0-0.5*p1)*x)+exp(-(p0-0.5*p1)*(nt-x))) + exp(p6)*(exp(-p2*x)+exp(-p2*(nt-x))), y1(x) = exp(p5)*(exp(-(p0+0.5*p1)*x)+exp(-(p0+0.5*p1)*(nt-x))) + exp(p7)*(exp(-p3*x)+exp(-p3*(nt-x)))",
     {&fm_cosh_ex_splitsum_func0,&fm_cosh_ex_splitsum_func1},
     &npar_8,
     1,
-    2
+    2,
+    {&fm_cosh_ex_splitsum_dfunc0,&fm_cosh_ex_splitsum_dfunc1},
+    {&fm_cosh_ex_splitsum_batch0,&fm_cosh_ex_splitsum_batch1}
 };
@@ -21,6 +21,7 @@
 
 #include <latan/latan_plot.h>
 #include <latan/latan_includes.h>
+#include <latan/latan_dtoa.h>
 #include <latan/latan_io.h>
 #include <latan/latan_math.h>
 #include <latan/latan_statistics.h>
@@ -41,11 +42,27 @@ enum
 
 static char * gnuplot_get_program_path(const char *pname);
 static void gnuplot_cmd(FILE *ctrl, const char *cmd, ...);
+static void plot_write_row(FILE *f, const double *x, const size_t n);
 
 static size_t ntmpf = 0;
 
 /*                              internal code                               */
 /****************************************************************************/
+/* data files rows are written with the shortest exact representation of
+ * the numbers */
+static void plot_write_row(FILE *f, const double *x, const size_t n)
+{
+    char buf[LATAN_DTOA_SIZE];
+    size_t i;
+    
+    for (i=0;i<n;i++)
+    {
+        latan_dtoa(buf,x[i]);
+        fputs(buf,f);
+        fputc((i < n - 1) ? ' ' : '\n',f);
+    }
+}
+
 
 #ifndef GNUPLOT_CMD
 #define GNUPLOT_CMD "gnuplot"
@@ -374,6 +391,7 @@ void plot_add_dat(plot *p, const mat *x, const mat *dat, const mat *xerr,\
     strbuf tmpfname, ucmd, errcmd, plotcmd, colorcmd;
     unsigned int err_flag;
     size_t i;
+    double row[4];
     
     err_flag = NO_ERR;
     
@@ -388,9 +406,11 @@ void plot_add_dat(plot *p, const mat *x, const mat *dat, const mat *xerr,\
         strbufcpy(errcmd,"w xyerr");
         for (i=0;i<nrow(dat);i++)
         {
-            fprintf(tmpf,"%.10e %.10e %.10e %.10e\n",mat_get(x,i,0),\
-                    mat_get(dat,i,0),mat_get(xerr,i,0),             \
-                    mat_get(yerr,i,0));
+            row[0] = mat_get(x,i,0);
+            row[1] = mat_get(dat,i,0);
+            row[2] = mat_get(xerr,i,0);
+            row[3] = mat_get(yerr,i,0);
+            plot_write_row(tmpf,row,4);
         }
     }
     else if (err_flag & X_ERR)
@@ -399,8 +419,10 @@ void plot_add_dat(plot *p, const mat *x, const mat *dat, const mat *xerr,\
         strbufcpy(errcmd,"w xerr");
         for (i=0;i<nrow(dat);i++)
         {
-            fprintf(tmpf,"%.10e %.10e %.10e\n",mat_get(x,i,0),mat_get(dat,i,0),\
-                    mat_get(xerr,i,0));
+            row[0] = mat_get(x,i,0);
+            row[1] = mat_get(dat,i,0);
+            row[2] = mat_get(xerr,i,0);
+            plot_write_row(tmpf,row,3);
         }
     }
     else if (err_flag & Y_ERR)
@@ -409,8 +431,10 @@ void plot_add_dat(plot *p, const mat *x, const mat *dat, const mat *xerr,\
         strbufcpy(errcmd,"w yerr");
         for (i=0;i<nrow(dat);i++)
         {
-            fprintf(tmpf,"%.10e %.10e %.10e\n",mat_get(x,i,0),mat_get(dat,i,0),\
-                    mat_get(yerr,i,0));
+            row[0] = mat_get(x,i,0);
+            row[1] = mat_get(dat,i,0);
+            row[2] = mat_get(yerr,i,0);
+            plot_write_row(tmpf,row,3);
         }
     }
     else
@@ -419,7 +443,9 @@ void plot_add_dat(plot *p, const mat *x, const mat *dat, const mat *xerr,\
         strbufcpy(errcmd,"");
         for (i=0;i<nrow(dat);i++)
         {
-            fprintf(tmpf,"%.10e %.10e\n",mat_get(x,i,0),mat_get(dat,i,0));
+            row[0] = mat_get(x,i,0);
+            row[1] = mat_get(dat,i,0);
+            plot_write_row(tmpf,row,2);
         }
     }
     fclose(tmpf);
@@ -442,13 +468,16 @@ void plot_add_points(plot *p, const mat *x, const mat *y, const strbuf title,\
     FILE* tmpf;
     strbuf tmpfname, plotcmd, colorcmd;
     size_t i;
+    double row[2];
     
     sprintf(tmpfname,".latan_tmp_plot_%lu.dat",(long unsigned)ntmpf);
     ntmpf++;
     FOPEN_NOERRET(tmpf,tmpfname,"w");
     for (i=0;i<nrow(y);i++)
     {
-        fprintf(tmpf,"%.10e %.10e\n",mat_get(x,i,0),mat_get(y,i,0));
+        row[0] = mat_get(x,i,0);
+        row[1] = mat_get(y,i,0);
+        plot_write_row(tmpf,row,2);
     }
     fclose(tmpf);
     if (strlen(color) == 0)
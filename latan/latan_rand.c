@@ -20,15 +20,18 @@
 #include <latan/latan_rand.h>
 #include <latan/latan_includes.h>
 #include <latan/latan_math.h>
+#if defined(HAVE_AVX2)&&!defined(HAVE_SSE)
+#include <immintrin.h>
+#endif
 
-static void ranlxd(double r[],int n);
-static void rlxd_init(int level,int seed);
+static void ranlxd(rg *g,double r[],int n);
+static void rlxd_init(rg *g,int level,int seed);
 static int rlxd_size(void);
-static void rlxd_get(int state[]);
-static void rlxd_reset(int state[]);
+static void rlxd_get(const rg *g,int state[]);
+static void rlxd_reset(rg *g,int state[]);
 static void error(int no);
-static void update(void);
-static void define_constants(void);
+static void update(rg *g);
+static void define_constants(rg *g);
 
 /*                          internal code                                   */
 /****************************************************************************/
@@ -46,23 +49,29 @@ static void define_constants(void);
  *
  * The functions are 
  *
- *   void ranlxd(double r[],int n)
+ *   void ranlxd(rg *g,double r[],int n)
  *     Computes the next n double-precision random numbers and 
  *     assigns them to the elements r[0],...,r[n-1] of the array r[]
  * 
- *   void rlxd_init(int level,int seed)
+ *   void rlxd_init(rg *g,int level,int seed)
  *     Initialization of the generator
  *
  *   int rlxd_size(void)
  *     Returns the number of integers required to save the state of
  *     the generator
  *
- *   void rlxd_get(int state[])
+ *   void rlxd_get(const rg *g,int state[])
  *     Extracts the current state of the generator and stores the 
  *     information in the array state[N] where N>=rlxd_size()
  *
- *   void rlxd_reset(int state[])
+ *   void rlxd_reset(rg *g,int state[])
  *     Resets the generator to the state defined by the array state[N]
+ *
+ * LatAnalyze modification: the generator state, originally in static
+ * variables, is stored in a rg structure passed to all the functions ;
+ * ranlxd reads the state by runs of 4 consecutive entries (the next[]
+ * table only jumps between runs) so the update test is done once per run
+ * instead of once per number, the output sequence is unchanged
  */
 
 #ifdef HAVE_SSE
@@ -77,14 +86,16 @@ typedef struct
     rlxd_vec_t c1,c2;
 } rlxd_dble_vec_t __attribute__ ((aligned (16)));
 
-static int init=0,rlxd_pr,prm,ir,jr,is,is_old,next[96];
-static rlxd_vec_t one,one_bit,carry;
-
-static union
+struct rg_s
 {
-    rlxd_dble_vec_t vec[12];
-    float num[96];
-} rlxd_x __attribute__ ((aligned (16)));
+    union
+    {
+        rlxd_dble_vec_t vec[12];
+        float num[96];
+    } rlxd_x __attribute__ ((aligned (16)));
+    rlxd_vec_t one,one_bit,carry;
+    int init,rlxd_pr,prm,ir,jr,is,is_old,next[96];
+};
 
 #define STEP(pi,pj)                                     \
 __asm__ __volatile__ ("movaps %4, %%xmm4 \n\t"          \
@@ -140,25 +151,25 @@ static void error(int no)
     }         
 }
 
-static void update(void)
+static void update(rg *g)
 {
     int k,kmax;
     rlxd_dble_vec_t *pmin,*pmax,*pi,*pj;
     
-    kmax=rlxd_pr;
-    pmin=&rlxd_x.vec[0];
+    kmax=g->rlxd_pr;
+    pmin=&g->rlxd_x.vec[0];
     pmax=pmin+12;
-    pi=&rlxd_x.vec[ir];
-    pj=&rlxd_x.vec[jr];
+    pi=&g->rlxd_x.vec[g->ir];
+    pj=&g->rlxd_x.vec[g->jr];
     
     __asm__ __volatile__ ("movaps %0, %%xmm0 \n\t"
                           "movaps %1, %%xmm1 \n\t"
                           "movaps %2, %%xmm2"
                           :
                           :
-                          "m" (one_bit),
-                          "m" (one),
-                          "m" (carry)
+                          "m" (g->one_bit),
+                          "m" (g->one),
+                          "m" (g->carry)
                           :
                           "xmm0", "xmm1", "xmm2");
     
@@ -175,54 +186,54 @@ static void update(void)
     
     __asm__ __volatile__ ("movaps %%xmm2, %0"
                           :
-                          "=m" (carry));
-    
-    ir+=prm;
-    jr+=prm;
-    if (ir>=12)
-        ir-=12;
-    if (jr>=12)
-        jr-=12;
-    is=8*ir;
-    is_old=is;
+                          "=m" (g->carry));
+    
+    g->ir+=g->prm;
+    g->jr+=g->prm;
+    if (g->ir>=12)
+        g->ir-=12;
+    if (g->jr>=12)
+        g->jr-=12;
+    g->is=8*g->ir;
+    g->is_old=g->is;
 }
 
-static void define_constants(void)
+static void define_constants(rg *g)
 {
     int k;
     float b;
     
-    one.c1=1.0f;
-    one.c2=1.0f;
-    one.c3=1.0f;
-    one.c4=1.0f;   
+    g->one.c1=1.0f;
+    g->one.c2=1.0f;
+    g->one.c3=1.0f;
+    g->one.c4=1.0f;   
     
     b=(float)(ldexp(1.0,-24));
-    one_bit.c1=b;
-    one_bit.c2=b;
-    one_bit.c3=b;
-    one_bit.c4=b;
+    g->one_bit.c1=b;
+    g->one_bit.c2=b;
+    g->one_bit.c3=b;
+    g->one_bit.c4=b;
     
     for (k=0;k<96;k++)
     {
-        next[k]=(k+1)%96;
+        g->next[k]=(k+1)%96;
         if ((k%4)==3)
-            next[k]=(k+5)%96;
+            g->next[k]=(k+5)%96;
     }
 }
 
-static void rlxd_init(int level,int seed)
+static void rlxd_init(rg *g,int level,int seed)
 {
     int i,k,l;
     int ibit,jbit,xbit[31];
     int ix,iy;
     
-    define_constants();
+    define_constants(g);
     
     if (level==1)
-        rlxd_pr=202;
+        g->rlxd_pr=202;
     else if (level==2)
-        rlxd_pr=397;
+        g->rlxd_pr=397;
     else
         error(1);
     
@@ -259,36 +270,40 @@ static void rlxd_init(int level,int seed)
             if ((k%4)!=i)
                 ix=16777215-ix;
             
-            rlxd_x.num[4*k+i]=(float)(ldexp((double)(ix),-24));
+            g->rlxd_x.num[4*k+i]=(float)(ldexp((double)(ix),-24));
         }
     }
     
-    carry.c1=0.0f;
-    carry.c2=0.0f;
-    carry.c3=0.0f;
-    carry.c4=0.0f;
-    
-    ir=0;
-    jr=7;
-    is=91;
-    is_old=0;
-    prm=rlxd_pr%12;
-    init=1;
+    g->carry.c1=0.0f;
+    g->carry.c2=0.0f;
+    g->carry.c3=0.0f;
+    g->carry.c4=0.0f;
+    
+    g->ir=0;
+    g->jr=7;
+    g->is=91;
+    g->is_old=0;
+    g->prm=g->rlxd_pr%12;
+    g->init=1;
 }
 
-static void ranlxd(double r[],int n)
+static void ranlxd(rg *g,double r[],int n)
 {
-    int k;
+    int k,j,jmax;
     
-    if (init==0)
-        rlxd_init(1,1);
+    if (g->init==0)
+        rlxd_init(g,1,1);
     
-    for (k=0;k<n;k++) 
+    k=0;
+    while (k<n)
     {
-        is=next[is];
-        if (is==is_old)
-            update();
-        r[k]=(double)(rlxd_x.num[is+4])+(double)(one_bit.c1*rlxd_x.num[is]);
+        g->is=g->next[g->is];
+        if (g->is==g->is_old)
+            update(g);
+        jmax=(g->is&~3)+4;
+        for (j=g->is;(j<jmax)&&(k<n);j++)
+            r[k++]=(double)(g->rlxd_x.num[j+4])+(double)(g->one_bit.c1*g->rlxd_x.num[j]);
+        g->is=j-1;
     }
 }
 
@@ -298,36 +313,36 @@ static int rlxd_size(void)
     return(RLXG_STATE_SIZE);
 }
 
-static void rlxd_get(int state[])
+static void rlxd_get(const rg *g,int state[])
 {
     int k;
     float base;
     
-    if (init==0)
+    if (g->init==0)
         error(3);
     
     base=(float)(ldexp(1.0,24));
     state[0]=rlxd_size();
     
     for (k=0;k<96;k++)
-        state[k+1]=(int)(base*rlxd_x.num[k]);
+        state[k+1]=(int)(base*g->rlxd_x.num[k]);
     
-    state[97]=(int)(base*carry.c1);
-    state[98]=(int)(base*carry.c2);
-    state[99]=(int)(base*carry.c3);
-    state[100]=(int)(base*carry.c4);
+    state[97]=(int)(base*g->carry.c1);
+    state[98]=(int)(base*g->carry.c2);
+    state[99]=(int)(base*g->carry.c3);
+    state[100]=(int)(base*g->carry.c4);
     
-    state[101]=rlxd_pr;
-    state[102]=ir;
-    state[103]=jr;
-    state[104]=is;
+    state[101]=g->rlxd_pr;
+    state[102]=g->ir;
+    state[103]=g->jr;
+    state[104]=g->is;
 }
 
-static void rlxd_reset(int state[])
+static void rlxd_reset(rg *g,int state[])
 {
     int k;
     
-    define_constants();
+    define_constants(g);
     
     if (state[0]!=rlxd_size())
         error(5);
@@ -337,7 +352,7 @@ static void rlxd_reset(int state[])
         if ((state[k+1]<0)||(state[k+1]>=167777216))
             error(5);
         
-        rlxd_x.num[k]=(float)(ldexp((double)(state[k+1]),-24));
+        g->rlxd_x.num[k]=(float)(ldexp((double)(state[k+1]),-24));
     }
     
     if (((state[97]!=0)&&(state[97]!=1))||
@@ -346,22 +361,22 @@ static void rlxd_reset(int state[])
         ((state[100]!=0)&&(state[100]!=1)))
         error(5);
     
-    carry.c1=(float)(ldexp((double)(state[97]),-24));
-    carry.c2=(float)(ldexp((double)(state[98]),-24));
-    carry.c3=(float)(ldexp((double)(state[99]),-24));
-    carry.c4=(float)(ldexp((double)(state[100]),-24));
-    
-    rlxd_pr=state[101];
-    ir=state[102];
-    jr=state[103];
-    is=state[104];
-    is_old=8*ir;
-    prm=rlxd_pr%12;
-    init=1;
-    
-    if (((rlxd_pr!=202)&&(rlxd_pr!=397))||
-        (ir<0)||(ir>11)||(jr<0)||(jr>11)||(jr!=((ir+7)%12))||
-        (is<0)||(is>91))
+    g->carry.c1=(float)(ldexp((double)(state[97]),-24));
+    g->carry.c2=(float)(ldexp((double)(state[98]),-24));
+    g->carry.c3=(float)(ldexp((double)(state[99]),-24));
+    g->carry.c4=(float)(ldexp((double)(state[100]),-24));
+    
+    g->rlxd_pr=state[101];
+    g->ir=state[102];
+    g->jr=state[103];
+    g->is=state[104];
+    g->is_old=8*g->ir;
+    g->prm=g->rlxd_pr%12;
+    g->init=1;
+    
+    if (((g->rlxd_pr!=202)&&(g->rlxd_pr!=397))||
+        (g->ir<0)||(g->ir>11)||(g->jr<0)||(g->jr>11)||(g->jr!=((g->ir+7)%12))||
+        (g->is<0)||(g->is>91))
         error(5);
 }
 
@@ -380,47 +395,50 @@ typedef struct
     rlxd_vec_t c1,c2;
 } rlxd_dble_vec_t;
 
-static int init=0,rlxd_pr,prm,ir,jr,is,is_old,next[96];
-static double one_bit;
-static rlxd_vec_t carry;
-
-static union
+struct rg_s
 {
-    rlxd_dble_vec_t vec[12];
-    int num[96];
-} rlxd_x;
+    union
+    {
+        rlxd_dble_vec_t vec[12];
+        int num[96];
+    } rlxd_x;
+    rlxd_vec_t carry;
+    double one_bit;
+    int init,rlxd_pr,prm,ir,jr,is,is_old,next[96];
+    int use_avx2;
+};
 
 #define STEP(pi,pj) \
-d=(*pj).c1.c1-(*pi).c1.c1-carry.c1; \
+d=(*pj).c1.c1-(*pi).c1.c1-g->carry.c1; \
 (*pi).c2.c1+=(d<0); \
 d+=BASE; \
 (*pi).c1.c1=d&MASK; \
-d=(*pj).c1.c2-(*pi).c1.c2-carry.c2; \
+d=(*pj).c1.c2-(*pi).c1.c2-g->carry.c2; \
 (*pi).c2.c2+=(d<0); \
 d+=BASE; \
 (*pi).c1.c2=d&MASK; \
-d=(*pj).c1.c3-(*pi).c1.c3-carry.c3; \
+d=(*pj).c1.c3-(*pi).c1.c3-g->carry.c3; \
 (*pi).c2.c3+=(d<0); \
 d+=BASE; \
 (*pi).c1.c3=d&MASK; \
-d=(*pj).c1.c4-(*pi).c1.c4-carry.c4; \
+d=(*pj).c1.c4-(*pi).c1.c4-g->carry.c4; \
 (*pi).c2.c4+=(d<0); \
 d+=BASE; \
 (*pi).c1.c4=d&MASK; \
 d=(*pj).c2.c1-(*pi).c2.c1; \
-carry.c1=(d<0); \
+g->carry.c1=(d<0); \
 d+=BASE; \
 (*pi).c2.c1=d&MASK; \
 d=(*pj).c2.c2-(*pi).c2.c2; \
-carry.c2=(d<0); \
+g->carry.c2=(d<0); \
 d+=BASE; \
 (*pi).c2.c2=d&MASK; \
 d=(*pj).c2.c3-(*pi).c2.c3; \
-carry.c3=(d<0); \
+g->carry.c3=(d<0); \
 d+=BASE; \
 (*pi).c2.c3=d&MASK; \
 d=(*pj).c2.c4-(*pi).c2.c4; \
-carry.c4=(d<0); \
+g->carry.c4=(d<0); \
 d+=BASE; \
 (*pi).c2.c4=d&MASK
 
@@ -453,17 +471,75 @@ static void error(int no)
     }         
 }
 
-static void update(void)
+#ifdef HAVE_AVX2
+/* LatAnalyze addition: AVX2 version of the update loop, the 8 integers of
+ * a rlxd_dble_vec_t are processed at once and the borrows of the c1 halves
+ * are moved to the c2 halves with a lane permutation ; the integer
+ * arithmetic is exactly the one of STEP so the results are bit-identical,
+ * it is used if the CPU supports AVX2 ; a step only has 8 integers and
+ * needs the borrows of the previous one, so AVX-512 would not process more
+ * data per step and is not used */
+static void update_avx2(rg *g,rlxd_dble_vec_t *pi,rlxd_dble_vec_t *pj)\
+__attribute__ ((target ("avx2")));
+
+static void update_avx2(rg *g,rlxd_dble_vec_t *pi,rlxd_dble_vec_t *pj)
+{
+    int k,kmax,c[8];
+    rlxd_dble_vec_t *pmin,*pmax;
+    __m256i vi,vj,vd,vb,vc,zero,base,mask;
+    
+    kmax=g->rlxd_pr;
+    pmin=&g->rlxd_x.vec[0];
+    pmax=pmin+12;
+    zero=_mm256_setzero_si256();
+    base=_mm256_set1_epi32(BASE);
+    mask=_mm256_set1_epi32(MASK);
+    vc=_mm256_set_epi32(0,0,0,0,g->carry.c4,g->carry.c3,g->carry.c2,
+                        g->carry.c1);
+    
+    for (k=0;k<kmax;k++) 
+    {
+        vi=_mm256_loadu_si256((const __m256i *)pi);
+        vj=_mm256_loadu_si256((const __m256i *)pj);
+        vd=_mm256_sub_epi32(_mm256_sub_epi32(vj,vi),vc);
+        vb=_mm256_cmpgt_epi32(zero,vd);
+        vd=_mm256_add_epi32(vd,_mm256_permute2x128_si256(vb,vb,0x08));
+        vb=_mm256_cmpgt_epi32(zero,vd);
+        vc=_mm256_srli_epi32(_mm256_permute2x128_si256(vb,vb,0x81),31);
+        vd=_mm256_and_si256(_mm256_add_epi32(vd,base),mask);
+        _mm256_storeu_si256((__m256i *)pi,vd);
+        pi+=1;
+        pj+=1;
+        if (pi==pmax)
+            pi=pmin;      
+        if (pj==pmax)
+            pj=pmin; 
+    }
+    
+    _mm256_storeu_si256((__m256i *)c,vc);
+    g->carry.c1=c[0];
+    g->carry.c2=c[1];
+    g->carry.c3=c[2];
+    g->carry.c4=c[3];
+}
+#endif
+
+static void update(rg *g)
 {
     int k,kmax,d;
     rlxd_dble_vec_t *pmin,*pmax,*pi,*pj;
     
-    kmax=rlxd_pr;
-    pmin=&rlxd_x.vec[0];
+    kmax=g->rlxd_pr;
+    pmin=&g->rlxd_x.vec[0];
     pmax=pmin+12;
-    pi=&rlxd_x.vec[ir];
-    pj=&rlxd_x.vec[jr];
+    pi=&g->rlxd_x.vec[g->ir];
+    pj=&g->rlxd_x.vec[g->jr];
     
+#ifdef HAVE_AVX2
+    if (g->use_avx2)
+        update_avx2(g,pi,pj);
+    else
+#endif
     for (k=0;k<kmax;k++) 
     {
         STEP(pi,pj);
@@ -475,31 +551,38 @@ static void update(void)
             pj=pmin; 
     }
     
-    ir+=prm;
-    jr+=prm;
-    if (ir>=12)
-        ir-=12;
-    if (jr>=12)
-        jr-=12;
-    is=8*ir;
-    is_old=is;
+    g->ir+=g->prm;
+    g->jr+=g->prm;
+    if (g->ir>=12)
+        g->ir-=12;
+    if (g->jr>=12)
+        g->jr-=12;
+    g->is=8*g->ir;
+    g->is_old=g->is;
 }
 
-static void define_constants(void)
+static void define_constants(rg *g)
 {
     int k;
     
-    one_bit=ldexp(1.0,-24);
+    g->one_bit=ldexp(1.0,-24);
     
     for (k=0;k<96;k++)
     {
-        next[k]=(k+1)%96;
+        g->next[k]=(k+1)%96;
         if ((k%4)==3)
-            next[k]=(k+5)%96;
+            g->next[k]=(k+5)%96;
     }   
+    
+#ifdef HAVE_AVX2
+    __builtin_cpu_init();
+    g->use_avx2=__builtin_cpu_supports("avx2");
+#else
+    g->use_avx2=0;
+#endif
 }
 
-static void rlxd_init(int level,int seed)
+static void rlxd_init(rg *g,int level,int seed)
 {
     int i,k,l;
     int ibit,jbit,xbit[31];
@@ -509,12 +592,12 @@ static void rlxd_init(int level,int seed)
         (DBL_MANT_DIG<48))
         error(0);
     
-    define_constants();
+    define_constants(g);
     
     if (level==1)
-        rlxd_pr=202;
+        g->rlxd_pr=202;
     else if (level==2)
-        rlxd_pr=397;
+        g->rlxd_pr=397;
     else
         error(1);
     
@@ -551,36 +634,40 @@ static void rlxd_init(int level,int seed)
             if ((k%4)!=i)
                 ix=16777215-ix;
             
-            rlxd_x.num[4*k+i]=ix;
+            g->rlxd_x.num[4*k+i]=ix;
         }
     }
     
-    carry.c1=0;
-    carry.c2=0;
-    carry.c3=0;
-    carry.c4=0;
-    
-    ir=0;
-    jr=7;
-    is=91;
-    is_old=0;
-    prm=rlxd_pr%12;
-    init=1;
+    g->carry.c1=0;
+    g->carry.c2=0;
+    g->carry.c3=0;
+    g->carry.c4=0;
+    
+    g->ir=0;
+    g->jr=7;
+    g->is=91;
+    g->is_old=0;
+    g->prm=g->rlxd_pr%12;
+    g->init=1;
 }
 
-static void ranlxd(double r[],int n)
+static void ranlxd(rg *g,double r[],int n)
 {
-    int k;
+    int k,j,jmax;
     
-    if (init==0)
-        rlxd_init(1,1);
+    if (g->init==0)
+        rlxd_init(g,1,1);
     
-    for (k=0;k<n;k++) 
+    k=0;
+    while (k<n)
     {
-        is=next[is];
-        if (is==is_old)
-            update();
-        r[k]=one_bit*((double)(rlxd_x.num[is+4])+one_bit*(double)(rlxd_x.num[is]));      
+        g->is=g->next[g->is];
+        if (g->is==g->is_old)
+            update(g);
+        jmax=(g->is&~3)+4;
+        for (j=g->is;(j<jmax)&&(k<n);j++)
+            r[k++]=g->one_bit*((double)(g->rlxd_x.num[j+4])+g->one_bit*(double)(g->rlxd_x.num[j]));
+        g->is=j-1;
     }
 }
 
@@ -589,30 +676,30 @@ static int rlxd_size(void)
     return(RLXG_STATE_SIZE);
 }
 
-static void rlxd_get(int state[])
+static void rlxd_get(const rg *g,int state[])
 {
     int k;
     
-    if (init==0)
+    if (g->init==0)
         error(3);
     
     state[0]=rlxd_size();
     
     for (k=0;k<96;k++)
-        state[k+1]=rlxd_x.num[k];
+        state[k+1]=g->rlxd_x.num[k];
     
-    state[97]=carry.c1;
-    state[98]=carry.c2;
-    state[99]=carry.c3;
-    state[100]=carry.c4;
+    state[97]=g->carry.c1;
+    state[98]=g->carry.c2;
+    state[99]=g->carry.c3;
+    state[100]=g->carry.c4;
     
-    state[101]=rlxd_pr;
-    state[102]=ir;
-    state[103]=jr;
-    state[104]=is;
+    state[101]=g->rlxd_pr;
+    state[102]=g->ir;
+    state[103]=g->jr;
+    state[104]=g->is;
 }
 
-static void rlxd_reset(int state[])
+static void rlxd_reset(rg *g,int state[])
 {
     int k;
     
@@ -620,7 +707,7 @@ static void rlxd_reset(int state[])
         (DBL_MANT_DIG<48))
         error(4);
     
-    define_constants();
+    define_constants(g);
     
     if (state[0]!=rlxd_size())
         error(5);
@@ -630,7 +717,7 @@ static void rlxd_reset(int state[])
         if ((state[k+1]<0)||(state[k+1]>=167777216))
             error(5);
         
-        rlxd_x.num[k]=state[k+1];
+        g->rlxd_x.num[k]=state[k+1];
     }
     
     if (((state[97]!=0)&&(state[97]!=1))||
@@ -639,22 +726,22 @@ static void rlxd_reset(int state[])
         ((state[100]!=0)&&(state[100]!=1)))
         error(5);
     
-    carry.c1=state[97];
-    carry.c2=state[98];
-    carry.c3=state[99];
-    carry.c4=state[100];
-    
-    rlxd_pr=state[101];
-    ir=state[102];
-    jr=state[103];
-    is=state[104];
-    is_old=8*ir;
-    prm=rlxd_pr%12;
-    init=1;
-    
-    if (((rlxd_pr!=202)&&(rlxd_pr!=397))||
-        (ir<0)||(ir>11)||(jr<0)||(jr>11)||(jr!=((ir+7)%12))||
-        (is<0)||(is>91))
+    g->carry.c1=state[97];
+    g->carry.c2=state[98];
+    g->carry.c3=state[99];
+    g->carry.c4=state[100];
+    
+    g->rlxd_pr=state[101];
+    g->ir=state[102];
+    g->jr=state[103];
+    g->is=state[104];
+    g->is_old=8*g->ir;
+    g->prm=g->rlxd_pr%12;
+    g->init=1;
+    
+    if (((g->rlxd_pr!=202)&&(g->rlxd_pr!=397))||
+        (g->ir<0)||(g->ir>11)||(g->jr<0)||(g->jr>11)||(g->jr!=((g->ir+7)%12))||
+        (g->is<0)||(g->is>91))
         error(5);
 }
 
@@ -664,47 +751,64 @@ static void rlxd_reset(int state[])
 /****************************************************************************/
 
 #define RLXD_LEVEL 1
+#define RG_BLOCK   96
 
-void randgen_init(int seed)
+/** generator objects **/
+rg *rg_create(void)
 {
-    rlxd_init(RLXD_LEVEL,seed);
+    rg *g;
+    
+    MALLOC_ERRVAL(g,rg *,1,NULL);
+    g->init = 0;
+    
+    return g;
 }
 
-int randgen_init_from_time(void)
+void rg_destroy(rg *g)
+{
+    FREE(g);
+}
+
+void rg_init(rg *g, const int seed)
+{
+    rlxd_init(g,RLXD_LEVEL,seed);
+}
+
+int rg_init_from_time(rg *g)
 {
     int itime;
     
     itime = (int)time(NULL);
     
-    randgen_init(itime);
+    rg_init(g,itime);
     
     return itime;
 }
 
-void randgen_get_state(rg_state state)
+void rg_get_state(rg_state state, const rg *g)
 {
-    rlxd_get(state);
+    rlxd_get(g,state);
 }
 
-void randgen_set_state(rg_state state)
+void rg_set_state(rg *g, rg_state state)
 {
-    rlxd_reset(state);
+    rlxd_reset(g,state);
 }
 
-double rand_u(double a, double b)
+double rg_u(rg *g, const double a, const double b)
 {
     double rx;
     
-    ranlxd(&rx,1);
+    ranlxd(g,&rx,1);
     
     return (b-a)*rx + a;
 }
 
-unsigned int rand_ud(const unsigned int n)
+unsigned int rg_ud(rg *g, const unsigned int n)
 {
     double rx;
     
-    ranlxd(&rx,1);
+    ranlxd(g,&rx,1);
     
     return ((unsigned int)(rx*(double)(n)));
 }
@@ -712,16 +816,256 @@ unsigned int rand_ud(const unsigned int n)
 /* gaussian random number generator based on cartesian Box-Muller algorithm
  * acceptance probability of one try is pi/4 = 78.54%
  */
-double rand_n(const double mean, const double sigma)
+double rg_n(rg *g, const double mean, const double sigma)
 {
     double rx,ry,sqnrm;
     
     do
     {
-        rx = rand_u(-1.0,1.0);
-        ry = rand_u(-1.0,1.0);
+        rx = rg_u(g,-1.0,1.0);
+        ry = rg_u(g,-1.0,1.0);
         sqnrm = SQ(rx)+SQ(ry);
     } while ((sqnrm > 1.0)||(sqnrm == 0.0));
 
     return sigma*rx*sqrt(-2.0*log(sqnrm)/sqnrm) + mean;
 }
+
+/** bulk generation **/
+/* the generator is called once per block of RG_BLOCK numbers (or once for
+ * the whole array in rg_u_fill) ; rg_n_fill uses the trigonometric
+ * Box-Muller transform without rejection on each block, the first half of
+ * the block gives the radii and the second half the angles, so that the
+ * loop has no branch and can be vectorized ; it does not give the same
+ * sequence as successive calls to rg_n */
+void rg_u_fill(rg *g, double *r, const size_t n, const double a,\
+               const double b)
+{
+    size_t i,nblock;
+    
+    for (i=0;i<n;i+=nblock)
+    {
+        nblock = MIN(n-i,(size_t)INT_MAX);
+        ranlxd(g,r+i,(int)nblock);
+    }
+    if ((a != 0.0)||(b != 1.0))
+    {
+        for (i=0;i<n;i++)
+        {
+            r[i] = (b-a)*r[i] + a;
+        }
+    }
+}
+
+void rg_ud_fill(rg *g, unsigned int *r, const size_t n,\
+                const unsigned int nmax)
+{
+    double rx[RG_BLOCK];
+    size_t i,j,nblock;
+    
+    for (i=0;i<n;i+=nblock)
+    {
+        nblock = MIN(n-i,RG_BLOCK);
+        ranlxd(g,rx,(int)nblock);
+        for (j=0;j<nblock;j++)
+        {
+            r[i+j] = (unsigned int)(rx[j]*(double)(nmax));
+        }
+    }
+}
+
+void rg_n_fill(rg *g, double *r, const size_t n, const double mean,\
+               const double sigma)
+{
+    double rx[RG_BLOCK],rn[RG_BLOCK];
+    double *out;
+    double rad,ang;
+    size_t i,j,nblock;
+    const size_t npair = RG_BLOCK/2;
+    
+    for (i=0;i<n;i+=nblock)
+    {
+        nblock = MIN(n-i,RG_BLOCK);
+        out    = (nblock == RG_BLOCK) ? r + i : rn;
+        ranlxd(g,rx,RG_BLOCK);
+        for (j=0;j<npair;j++)
+        {
+            rad          = sigma*sqrt(-2.0*log(1.0-rx[j]));
+            ang          = 2.0*C_PI*rx[npair+j];
+            out[j]       = rad*cos(ang) + mean;
+            out[npair+j] = rad*sin(ang) + mean;
+        }
+        if (out == rn)
+        {
+            memcpy(r+i,rn,nblock*sizeof(double));
+        }
+    }
+}
+
+/** default generator **/
+static rg rg_default;
+
+void randgen_init(int seed)
+{
+    rg_init(&rg_default,seed);
+}
+
+int randgen_init_from_time(void)
+{
+    return rg_init_from_time(&rg_default);
+}
+
+void randgen_get_state(rg_state state)
+{
+    rg_get_state(state,&rg_default);
+}
+
+void randgen_set_state(rg_state state)
+{
+    rg_set_state(&rg_default,state);
+}
+
+double rand_u(double a, double b)
+{
+    return rg_u(&rg_default,a,b);
+}
+
+unsigned int rand_ud(const unsigned int n)
+{
+    return rg_ud(&rg_default,n);
+}
+
+double rand_n(const double mean, const double sigma)
+{
+    return rg_n(&rg_default,mean,sigma);
+}
+
+void rand_u_fill(double *r, const size_t n, const double a, const double b)
+{
+    rg_u_fill(&rg_default,r,n,a,b);
+}
+
+void rand_ud_fill(unsigned int *r, const size_t n, const unsigned int nmax)
+{
+    rg_ud_fill(&rg_default,r,n,nmax);
+}
+
+void rand_n_fill(double *r, const size_t n, const double mean,\
+                 const double sigma)
+{
+    rg_n_fill(&rg_default,r,n,mean,sigma);
+}
+
+/*                      counter-based generator                             */
+/****************************************************************************/
+/* Philox4x32-10 from J. K. Salmon et al., "Parallel random numbers: as easy
+ * as 1, 2, 3", SC11 (2011) ; words are stored in unsigned long masked to 32
+ * bits to stay portable in ANSI C */
+#define PHILOX_M0     0xD2511F53UL
+#define PHILOX_M1     0xCD9E8D57UL
+#define PHILOX_W0     0x9E3779B9UL
+#define PHILOX_W1     0xBB67AE85UL
+#define PHILOX_NROUND 10
+#define MASK32        0xFFFFFFFFUL
+
+static void mulhilo32(unsigned long *hi, unsigned long *lo,\
+                      const unsigned long a, const unsigned long b)
+{
+#if ULONG_MAX > 0xFFFFFFFFUL
+    unsigned long p;
+    
+    p   = a*b;
+    *hi = (p >> 32)&MASK32;
+    *lo = p&MASK32;
+#else
+    unsigned long ll,lh,hl,hh,mid;
+    
+    ll   = (a&0xFFFFUL)*(b&0xFFFFUL);
+    lh   = (a&0xFFFFUL)*(b >> 16);
+    hl   = (a >> 16)*(b&0xFFFFUL);
+    hh   = (a >> 16)*(b >> 16);
+    mid  = (ll >> 16) + (lh&0xFFFFUL) + (hl&0xFFFFUL);
+    *lo  = ((mid&0xFFFFUL) << 16)|(ll&0xFFFFUL);
+    *hi  = (hh + (lh >> 16) + (hl >> 16) + (mid >> 16))&MASK32;
+#endif
+}
+
+static void philox4x32(unsigned long out[4], const unsigned long ctr[4],\
+                       const unsigned long key[2])
+{
+    unsigned long k0,k1,hi0,lo0,hi1,lo1;
+    int r;
+    
+    out[0] = ctr[0];
+    out[1] = ctr[1];
+    out[2] = ctr[2];
+    out[3] = ctr[3];
+    k0     = key[0];
+    k1     = key[1];
+    for (r=0;r<PHILOX_NROUND;r++)
+    {
+        if (r > 0)
+        {
+            k0 = (k0 + PHILOX_W0)&MASK32;
+            k1 = (k1 + PHILOX_W1)&MASK32;
+        }
+        mulhilo32(&hi0,&lo0,PHILOX_M0,out[0]);
+        mulhilo32(&hi1,&lo1,PHILOX_M1,out[2]);
+        out[0] = hi1^out[1]^k0;
+        out[1] = lo1;
+        out[2] = hi0^out[3]^k1;
+        out[3] = lo0;
+    }
+}
+
+/* the counter is (n/2,stream) and the key is the seed, with 64 bits each,
+ * each Philox call gives two 53 bits uniform numbers in [0,1) */
+static void cb_pair(double u[2], const unsigned long key,\
+                    const unsigned long stream, const unsigned long p)
+{
+    unsigned long ctr[4],k[2],out[4];
+    
+    ctr[0] = p&MASK32;
+    ctr[1] = ((p >> 16) >> 16)&MASK32;
+    ctr[2] = stream&MASK32;
+    ctr[3] = ((stream >> 16) >> 16)&MASK32;
+    k[0]   = key&MASK32;
+    k[1]   = ((key >> 16) >> 16)&MASK32;
+    philox4x32(out,ctr,k);
+    u[0]   = ((double)(out[0] >> 5)*67108864.0 + (double)(out[1] >> 6))\
+             /9007199254740992.0;
+    u[1]   = ((double)(out[2] >> 5)*67108864.0 + (double)(out[3] >> 6))\
+             /9007199254740992.0;
+}
+
+double rand_cb_u(const unsigned long key, const unsigned long stream,\
+                 const unsigned long n, const double a, const double b)
+{
+    double u[2];
+    
+    cb_pair(u,key,stream,n/2);
+    
+    return (b-a)*u[n%2] + a;
+}
+
+unsigned int rand_cb_ud(const unsigned long key, const unsigned long stream,\
+                        const unsigned long n, const unsigned int nmax)
+{
+    return (unsigned int)(rand_cb_u(key,stream,n,0.0,1.0)*(double)(nmax));
+}
+
+void rand_cb_ud_fill(unsigned int *r, const size_t n, const unsigned long key,\
+                     const unsigned long stream, const unsigned int nmax)
+{
+    double u[2];
+    size_t i;
+    
+    for (i=0;i<n;i+=2)
+    {
+        cb_pair(u,key,stream,(unsigned long)(i/2));
+        r[i] = (unsigned int)(u[0]*(double)(nmax));
+        if (i+1 < n)
+        {
+            r[i+1] = (unsigned int)(u[1]*(double)(nmax));
+        }
+    }
+}
@@ -28,6 +28,28 @@ __BEGIN_DECLS
 #define RLXG_STATE_SIZE 105
 typedef int rg_state[RLXG_STATE_SIZE];
 
+/* random generator object, each object has its own state and can be used
+ * concurrently with the others */
+typedef struct rg_s rg;
+
+rg *rg_create(void);
+void rg_destroy(rg *g);
+void rg_init(rg *g, const int seed);
+int rg_init_from_time(rg *g);
+void rg_get_state(rg_state state, const rg *g);
+void rg_set_state(rg *g, rg_state state);
+double rg_u(rg *g, const double a, const double b);
+unsigned int rg_ud(rg *g, const unsigned int n);
+double rg_n(rg *g, const double mean, const double sigma);
+/** bulk generation, filling arrays of size n **/
+void rg_u_fill(rg *g, double *r, const size_t n, const double a,\
+               const double b);
+void rg_ud_fill(rg *g, unsigned int *r, const size_t n,\
+                const unsigned int nmax);
+void rg_n_fill(rg *g, double *r, const size_t n, const double mean,\
+               const double sigma);
+
+/* default global generator */
 void randgen_init(const int seed);
 int randgen_init_from_time(void);
 void randgen_set_state(rg_state state);
@@ -35,6 +57,20 @@ void randgen_get_state(rg_state state);
 double rand_u(double a, double b);
 unsigned int rand_ud(const unsigned int n);
 double rand_n(const double mean, const double sigma);
+void rand_u_fill(double *r, const size_t n, const double a, const double b);
+void rand_ud_fill(unsigned int *r, const size_t n, const unsigned int nmax);
+void rand_n_fill(double *r, const size_t n, const double mean,\
+                 const double sigma);
+
+/* counter-based generator : the n-th number of the stream (key,stream) is a
+ * pure function of (key,stream,n), so any draw can be regenerated
+ * independently of the others and from any thread */
+double rand_cb_u(const unsigned long key, const unsigned long stream,\
+                 const unsigned long n, const double a, const double b);
+unsigned int rand_cb_ud(const unsigned long key, const unsigned long stream,\
+                        const unsigned long n, const unsigned int nmax);
+void rand_cb_ud_fill(unsigned int *r, const size_t n, const unsigned long key,\
+                     const unsigned long stream, const unsigned int nmax);
 
 __END_DECLS
 
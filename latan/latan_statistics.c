@@ -19,6 +19,7 @@
 
 #include <latan/latan_statistics.h>
 #include <latan/latan_includes.h>
+#include <latan/latan_blas.h>
 #include <latan/latan_math.h>
 #include <latan/latan_rand.h>
 #include <latan/latan_io.h>
@@ -28,17 +29,57 @@
 #include <gsl/gsl_sf.h>
 #include <gsl/gsl_sort_double.h>
 
+/* number of bootstrap replicas of the mean obtained with one matrix
+ * product */
+#define RS_PAR_BLOCK 256
+
+typedef struct
+{
+    bool par_resamp;
+    bool cb_resamp;
+    unsigned long cb_seed;
+} stat_env;
+
+static stat_env env =
+{
+    false,\
+    false,\
+    1UL
+};
+
+static latan_errno cent_sample(mat *c, mat **m, const size_t size,\
+                               const mat *m_mean);
 static latan_errno resample_bootstrap(mat *cent_val, mat **sample,         \
                                       const size_t nboot, mat **dat,       \
                                       const size_t ndat, rs_func *f,       \
-                                      void *param);
+                                      void *param, const bool cb_resamp,   \
+                                      const unsigned long cb_seed);
 
-/* TODO : Jackknife resampling function
+static latan_errno resample_bootstrap_par(mat **sample, const size_t nboot,\
+                                          mat **dat, const size_t ndat,    \
+                                          rs_func *f, void *param,         \
+                                          const bool cb_resamp,            \
+                                          const unsigned long cb_seed);
+static unsigned long resample_par_key(void);
+static latan_errno bootstrap_count_par(mat *w, const size_t bsize,        \
+                                       const size_t b,                    \
+                                       const unsigned long key,           \
+                                       const size_t ndat);
+static latan_errno resample_bootstrap_mean(rs_sample *s, mat **dat,      \
+                                           const size_t ndat,            \
+                                           const bool cb_resamp,         \
+                                           const unsigned long cb_seed);
+static latan_errno resample_gen(rs_sample *s, mat **dat, const size_t ndat,\
+                                rs_func *f, unsigned int resamp_method,    \
+                                void *param, const bool cb_resamp,         \
+                                const unsigned long cb_seed);
+
+static bool jackknife_next_del(size_t *del, const size_t d,\
+                               const size_t ndat);
 static latan_errno resample_jackknife(mat *cent_val, mat **sample,         \
                                       const size_t jk_depth, mat **dat,    \
-                                      const size_t ndat, const size_t nobs,\
-                                      rs_func *f, void *param);
-*/
+                                      const size_t ndat, rs_func *f,       \
+                                      void *param);
 
 /*                      elementary estimators                               */
 /****************************************************************************/
@@ -131,14 +172,46 @@ latan_errno mat_cov(mat *cov, mat **m, mat **n, const size_t size)
     status = LATAN_SUCCESS;
     
     m_mean = mat_create_from_dim(m[0]);
-    n_mean = mat_create_from_dim(n[0]);
+    n_mean = (m == n) ? m_mean : mat_create_from_dim(n[0]);
     
     USTAT(mat_mean(m_mean,m,size));
-    USTAT(mat_mean(n_mean,n,size));
+    if (n_mean != m_mean)
+    {
+        USTAT(mat_mean(n_mean,n,size));
+    }
     USTAT(mat_cov_m(cov,m,n,size,m_mean,n_mean));
     
+    if (n_mean != m_mean)
+    {
+        mat_destroy(n_mean);
+    }
     mat_destroy(m_mean);
-    mat_destroy(n_mean);
+    
+    return status;
+}
+
+/* the centered samples are stored side by side in one matrix, the
+ * covariance is then computed with a single rank-k update (or matrix
+ * product if m and n are different) */
+static latan_errno cent_sample(mat *c, mat **m, const size_t size,\
+                               const mat *m_mean)
+{
+    latan_errno status;
+    size_t i;
+    const size_t subdim = ncol(m[0]);
+    mat c_i;
+    gsl_matrix_view c_i_view;
+    
+    status = LATAN_SUCCESS;
+    
+    for (i=0;i<size;i++)
+    {
+        c_i_view      = gsl_matrix_submatrix(c->data_cpu,0,i*subdim,nrow(c),\
+                                             subdim);
+        c_i.data_cpu  = &(c_i_view.matrix);
+        c_i.prop_flag = MAT_GEN;
+        USTAT(mat_sub(&c_i,m[i],m_mean));
+    }
     
     return status;
 }
@@ -147,33 +220,45 @@ latan_errno mat_cov_m(mat *cov, mat **m, mat **n, const size_t size,\
                       mat *m_mean, mat *n_mean)
 {
     latan_errno status;
-    size_t i;
+    size_t i,j;
     size_t subdim;
-    double dsubdim;
-    mat **mctnc;
-    mat **mc;
-    mat **nc;
+    double dnorm;
+    mat *mc;
+    mat *nc;
     
     status = LATAN_SUCCESS;
     subdim = ncol(m[0]);
-    dsubdim = (double)(subdim);
+    dnorm  = 1.0/((double)(size*subdim));
     
-    mctnc = mat_ar_create_from_dim(size,cov);
-    mc    = mat_ar_create_from_dim(size,m[0]);
-    nc    = mat_ar_create_from_dim(size,n[0]);
+    if ((nrow(cov) != nrow(m[0]))||(ncol(cov) != nrow(n[0])))
+    {
+        LATAN_ERROR("covariance matrix dimensions do not match samples",\
+                    LATAN_EBADLEN);
+    }
     
-    for (i=0;i<size;i++) 
+    mc = mat_create(nrow(m[0]),size*subdim);
+    USTAT(cent_sample(mc,m,size,m_mean));
+    if ((m == n)&&(m_mean == n_mean))
     {
-        USTAT(mat_sub(mc[i],m[i],m_mean));
-        USTAT(mat_sub(nc[i],n[i],n_mean));
-        USTAT(mat_mul(mctnc[i],mc[i],'n',nc[i],'t'));
-        USTAT(mat_eqmuls(mctnc[i],1.0/dsubdim));
+        USTAT(latan_blas_dsyrk('l','n',dnorm,mc,0.0,cov));
+        for (i=0;i<nrow(cov);i++)
+        for (j=i+1;j<ncol(cov);j++)
+        {
+            mat_set(cov,i,j,mat_get(cov,j,i));
+        }
+        mat_reset_assump(cov);
+        mat_assume(cov,MAT_SYM);
+    }
+    else
+    {
+        nc = mat_create(nrow(n[0]),size*subdim);
+        USTAT(cent_sample(nc,n,size,n_mean));
+        USTAT(latan_blas_dgemm('n','t',dnorm,mc,nc,0.0,cov));
+        mat_reset_assump(cov);
+        mat_destroy(nc);
     }
-    USTAT(mat_mean(cov,mctnc,size));
     
-    mat_ar_destroy(mctnc,size);
-    mat_ar_destroy(mc,size);
-    mat_ar_destroy(nc,size);
+    mat_destroy(mc);
     
     return status;
 }
@@ -487,27 +572,85 @@ size_t jackknife_nsample(const size_t ndat, const size_t jk_depth)
 }
 
 /** allocation **/
+/* number of doubles to skip after pt to reach a RS_SAMPLE_ALIGN boundary */
+#define ALIGN_SHIFT(pt)\
+((RS_SAMPLE_ALIGN-((size_t)(pt))%RS_SAMPLE_ALIGN)%RS_SAMPLE_ALIGN\
+ /sizeof(double))
+/* nel rounded up to a multiple of RS_SAMPLE_ALIGN bytes */
+#define ALIGN_NEL(n)\
+((((n)*sizeof(double)+RS_SAMPLE_ALIGN-1)/RS_SAMPLE_ALIGN)*RS_SAMPLE_ALIGN\
+ /sizeof(double))
+
 rs_sample *rs_sample_create(const size_t init_nrow, const size_t init_ncol,\
                             const size_t nsample)
 {
     rs_sample *s;
+    gsl_matrix_view v;
+    double *data;
+    size_t i,nel_a;
+    const size_t nel = init_nrow*init_ncol;
+    
+    if ((nel == 0)||(nsample == 0))
+    {
+        LATAN_ERROR_NULL("trying to allocate a resampled sample with zero dimension",\
+                         LATAN_EBADLEN);
+    }
 
     MALLOC_ERRVAL(s,rs_sample *,1,NULL);
 
     s->nsample = nsample;
-
-    s->cent_val = mat_create(init_nrow,init_ncol);
-    s->sample   = mat_ar_create_from_dim(s->nsample,s->cent_val);
+    
+    /* one data block: [cent_val|pad|sample_0|...|sample_{nsample-1}] */
+    nel_a = ALIGN_NEL(nel);
+    MALLOC_NOERRET(s->data_raw,double *,nel_a+nsample*nel\
+                   +RS_SAMPLE_ALIGN/sizeof(double));
+    MALLOC_NOERRET(s->mat_buf,mat *,nsample+2);
+    MALLOC_NOERRET(s->gsl_buf,gsl_matrix *,nsample+2);
+    MALLOC_NOERRET(s->sample,mat **,nsample);
+    if ((s->data_raw == NULL)||(s->mat_buf == NULL)||(s->gsl_buf == NULL)\
+        ||(s->sample == NULL))
+    {
+        rs_sample_destroy(s);
+        
+        return NULL;
+    }
+    data = s->data_raw + ALIGN_SHIFT(s->data_raw);
+    
+    /* matrix headers: cent_val, slab and samples, all views on data */
+    v = gsl_matrix_view_array(data,init_nrow,init_ncol);
+    s->gsl_buf[0]               = v.matrix;
+    s->mat_buf[0].data_cpu      = s->gsl_buf;
+    s->mat_buf[0].prop_flag     = MAT_GEN;
+    s->cent_val                 = s->mat_buf;
+    data                       += nel_a;
+    v = gsl_matrix_view_array(data,nsample,nel);
+    s->gsl_buf[1]               = v.matrix;
+    s->mat_buf[1].data_cpu      = s->gsl_buf + 1;
+    s->mat_buf[1].prop_flag     = MAT_GEN;
+    s->slab                     = s->mat_buf + 1;
+    for (i=0;i<nsample;i++)
+    {
+        v = gsl_matrix_view_array(data+i*nel,init_nrow,init_ncol);
+        s->gsl_buf[i+2]           = v.matrix;
+        s->mat_buf[i+2].data_cpu  = s->gsl_buf + i + 2;
+        s->mat_buf[i+2].prop_flag = MAT_GEN;
+        s->sample[i]              = s->mat_buf + i + 2;
+    }
 
     return s;
 }
 
+#undef ALIGN_SHIFT
+#undef ALIGN_NEL
+
 void rs_sample_destroy(rs_sample *s)
 {
     if (s)
     {
-        mat_destroy(s->cent_val);
-        mat_ar_destroy(s->sample,s->nsample);
+        FREE(s->sample);
+        FREE(s->gsl_buf);
+        FREE(s->mat_buf);
+        FREE(s->data_raw);
         FREE(s);
     }
 }
@@ -538,6 +681,51 @@ mat *rs_sample_pt_sample(const rs_sample *s, const size_t i)
     return (s->sample)[i];
 }
 
+mat *rs_sample_pt_slab(const rs_sample *s)
+{
+    return s->slab;
+}
+
+latan_errno rs_sample_get_point_major(mat *pm, const rs_sample *s)
+{
+    if ((nrow(pm) != nel(s->cent_val))||(ncol(pm) != s->nsample))
+    {
+        LATAN_ERROR("point-major matrix dimensions do not match the sample",\
+                    LATAN_EBADLEN);
+    }
+    
+    gsl_matrix_transpose_memcpy(pm->data_cpu,s->slab->data_cpu);
+    
+    return LATAN_SUCCESS;
+}
+
+/* synthetic sample: central value mean and samples drawn element by element
+ * from independent gaussian distributions, generated in one bulk call on
+ * the sample slab */
+latan_errno rs_sample_rand_n(rs_sample *s, const mat *mean, const mat *sigma)
+{
+    latan_errno status;
+    size_t i;
+    
+    if (!(mat_is_samedim(mean,s->cent_val)&&mat_is_samedim(sigma,s->cent_val)))
+    {
+        LATAN_ERROR("mean or standard deviation dimensions do not match the sample",\
+                    LATAN_EBADLEN);
+    }
+    
+    status = LATAN_SUCCESS;
+    
+    rand_n_fill(s->slab->data_cpu->data,s->nsample*nel(s->cent_val),0.0,1.0);
+    for (i=0;i<s->nsample;i++)
+    {
+        USTAT(mat_eqmulp(s->sample[i],sigma));
+        USTAT(mat_eqadd(s->sample[i],mean));
+    }
+    USTAT(mat_cp(s->cent_val,mean));
+    
+    return status;
+}
+
 latan_errno rs_sample_get_subsamp(rs_sample *s_a, const rs_sample *s_b,\
                                   const size_t k1, const size_t l1,    \
                                   const size_t k2, const size_t l2)
@@ -622,33 +810,402 @@ latan_errno rs_sample_covp(mat *cov, const rs_sample *s, const rs_sample *t)
 }
 /*                      resampling functions                                */
 /****************************************************************************/
+/** environment **/
+bool resample_get_parallel(void)
+{
+    return env.par_resamp;
+}
+
+void resample_set_parallel(const bool par_resamp)
+{
+    env.par_resamp = par_resamp;
+}
+
+bool resample_get_counter_based(void)
+{
+    return env.cb_resamp;
+}
+
+unsigned long resample_get_cb_seed(void)
+{
+    return env.cb_seed;
+}
+
+void resample_set_counter_based(const bool cb_resamp, const unsigned long seed)
+{
+    env.cb_resamp = cb_resamp;
+    env.cb_seed   = seed;
+}
+
+/* indices of the counter-based bootstrap sample i */
+void resample_bootstrap_ind(unsigned int *ind, const unsigned long seed,\
+                            const size_t i, const size_t ndat)
+{
+    rand_cb_ud_fill(ind,ndat,seed,(unsigned long)(i),(unsigned int)(ndat));
+}
+
 static latan_errno resample_bootstrap(mat *cent_val, mat **sample,         \
                                       const size_t nboot, mat **dat,       \
                                       const size_t ndat, rs_func *f,       \
-                                      void *param)
+                                      void *param, const bool cb_resamp,   \
+                                      const unsigned long cb_seed)
 {
     mat **fakedat;
+    unsigned int *rind;
     size_t i,j;
     unsigned int rj;
     latan_errno status;
     
     status = LATAN_SUCCESS;
     
+    USTAT(f(cent_val,dat,ndat,param));
+    if (env.par_resamp)
+    {
+        USTAT(resample_bootstrap_par(sample,nboot,dat,ndat,f,param,cb_resamp,\
+                                     cb_seed));
+        
+        return status;
+    }
+    
     MALLOC(fakedat,mat**,ndat);
+    MALLOC(rind,unsigned int *,ndat);
     
-    USTAT(f(cent_val,dat,ndat,param));
     for (i=0;i<nboot;i++)
     {
-        
+        if (cb_resamp)
+        {
+            resample_bootstrap_ind(rind,cb_seed,i,ndat);
+        }
         for (j=0;j<ndat;j++) 
         {
-            rj = rand_ud((unsigned int)(ndat));
+            rj = cb_resamp ? rind[j] : rand_ud((unsigned int)(ndat));
             fakedat[j] = dat[rj];
         }
         USTAT(f(sample[i],fakedat,ndat,param));
     }
     
     FREE(fakedat);
+    FREE(rind);
+    
+    return status;
+}
+
+/* key of the counter-based streams of a parallel bootstrap, drawn from the
+ * global generator */
+static unsigned long resample_par_key(void)
+{
+    unsigned long key;
+    
+    key = (unsigned long)(rand_ud(UINT_MAX));
+    key = ((key << 16) << 16)|(unsigned long)(rand_ud(UINT_MAX));
+    
+    return key;
+}
+
+/* parallel bootstrap: the resampling indices of replica i are the
+ * counter-based stream i of a key drawn once from the global generator, so
+ * the streams of different replicas are distinct by construction, and the
+ * replicas are evaluated concurrently; the samples then do not depend on the
+ * number of threads but they are not the serial ones ; with counter-based
+ * resampling the key is the counter-based seed and the indices are the
+ * serial ones */
+static latan_errno resample_bootstrap_par(mat **sample, const size_t nboot,\
+                                          mat **dat, const size_t ndat,    \
+                                          rs_func *f, void *param,         \
+                                          const bool cb_resamp,            \
+                                          const unsigned long cb_seed)
+{
+    unsigned long key;
+    latan_errno status;
+    
+    status = LATAN_SUCCESS;
+    key    = cb_resamp ? cb_seed : resample_par_key();
+    
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+        mat **fakedat;
+        unsigned int *rind;
+        long li;
+        size_t j;
+        latan_errno tstatus;
+        
+        tstatus = LATAN_SUCCESS;
+        fakedat = (mat **)(malloc(ndat*sizeof(mat *)));
+        rind    = (unsigned int *)(malloc(ndat*sizeof(unsigned int)));
+        if ((fakedat == NULL)||(rind == NULL))
+        {
+            LATAN_ERROR_NORET("memory allocation failed",LATAN_ENOMEM);
+            tstatus = LATAN_ENOMEM;
+        }
+        else
+        {
+#ifdef _OPENMP
+            #pragma omp for schedule(dynamic)
+#endif
+            for (li=0;li<(long)(nboot);li++)
+            {
+                resample_bootstrap_ind(rind,key,(size_t)(li),ndat);
+                for (j=0;j<ndat;j++)
+                {
+                    fakedat[j] = dat[rind[j]];
+                }
+                LATAN_UPDATE_STATUS(tstatus,f(sample[li],fakedat,ndat,param));
+            }
+        }
+        FREE(fakedat);
+        FREE(rind);
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        {
+            USTAT(tstatus);
+        }
+    }
+    
+    return status;
+}
+
+/* resampling counts of the parallel bootstrap replicas b to b+bsize-1 in the
+ * rows of w, filled concurrently */
+static latan_errno bootstrap_count_par(mat *w, const size_t bsize,        \
+                                       const size_t b,                    \
+                                       const unsigned long key,           \
+                                       const size_t ndat)
+{
+    latan_errno status;
+    
+    status = LATAN_SUCCESS;
+    
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+        unsigned int *rind;
+        long li;
+        size_t j;
+        
+        rind = (unsigned int *)(malloc(ndat*sizeof(unsigned int)));
+        if (rind == NULL)
+        {
+#ifdef _OPENMP
+            #pragma omp critical
+#endif
+            {
+                LATAN_ERROR_NORET("memory allocation failed",LATAN_ENOMEM);
+                status = LATAN_ENOMEM;
+            }
+        }
+        else
+        {
+#ifdef _OPENMP
+            #pragma omp for
+#endif
+            for (li=0;li<(long)(bsize);li++)
+            {
+                resample_bootstrap_ind(rind,key,b+(size_t)(li),ndat);
+                for (j=0;j<ndat;j++)
+                {
+                    mat_pp(w,(size_t)(li),(size_t)(rind[j]));
+                }
+            }
+        }
+        FREE(rind);
+    }
+    
+    return status;
+}
+
+/* bootstrap of the mean: a replica is the product of its row of resampling
+ * counts (divided by ndat) with the data matrix holding one flattened
+ * configuration per row, so RS_PAR_BLOCK replicas are obtained with one
+ * matrix product written directly in the sample slab ; the resampling
+ * indices are drawn as in the generic bootstrap, serial or parallel
+ * following the environment, the samples are then the same up to rounding */
+static latan_errno resample_bootstrap_mean(rs_sample *s, mat **dat,      \
+                                           const size_t ndat,            \
+                                           const bool cb_resamp,         \
+                                           const unsigned long cb_seed)
+{
+    mat *data,*w;
+    mat w_b,s_b;
+    gsl_matrix_view w_b_view,s_b_view;
+    unsigned int *rind;
+    unsigned long key;
+    size_t b,bsize,i,j,k;
+    const size_t nel_s = nel(s->cent_val);
+    const size_t nc    = ncol(s->cent_val);
+    latan_errno status;
+    
+    status = LATAN_SUCCESS;
+    
+    USTAT(rs_mean(s->cent_val,dat,ndat,NULL));
+    if (env.par_resamp)
+    {
+        key = cb_resamp ? cb_seed : resample_par_key();
+    }
+    else
+    {
+        key = cb_seed;
+    }
+    data = mat_create(ndat,nel_s);
+    w    = mat_create(MIN(RS_PAR_BLOCK,s->nsample),ndat);
+    MALLOC(rind,unsigned int *,ndat);
+    
+    for (j=0;j<ndat;j++)
+    for (k=0;k<nel_s;k++)
+    {
+        mat_set(data,j,k,mat_get(dat[j],k/nc,k%nc));
+    }
+    for (b=0;b<s->nsample;b+=RS_PAR_BLOCK)
+    {
+        bsize = MIN(RS_PAR_BLOCK,s->nsample-b);
+        mat_zero(w);
+        if (env.par_resamp)
+        {
+            USTAT(bootstrap_count_par(w,bsize,b,key,ndat));
+        }
+        else
+        {
+            for (i=0;i<bsize;i++)
+            {
+                if (cb_resamp)
+                {
+                    resample_bootstrap_ind(rind,key,b+i,ndat);
+                }
+                else
+                {
+                    rand_ud_fill(rind,ndat,(unsigned int)(ndat));
+                }
+                for (j=0;j<ndat;j++)
+                {
+                    mat_pp(w,i,(size_t)(rind[j]));
+                }
+            }
+        }
+        w_b_view      = gsl_matrix_submatrix(w->data_cpu,0,0,bsize,ndat);
+        w_b.data_cpu  = &(w_b_view.matrix);
+        w_b.prop_flag = MAT_GEN;
+        s_b_view      = gsl_matrix_submatrix(s->slab->data_cpu,b,0,bsize,\
+                                             nel_s);
+        s_b.data_cpu  = &(s_b_view.matrix);
+        s_b.prop_flag = MAT_GEN;
+        USTAT(latan_blas_dgemm('n','n',1.0/((double)(ndat)),&w_b,data,0.0,\
+                               &s_b));
+    }
+    
+    mat_destroy(data);
+    mat_destroy(w);
+    FREE(rind);
+    
+    return status;
+}
+
+/* next set of d deleted indices in lexicographic order, return false when
+ * all the sets were explored */
+static bool jackknife_next_del(size_t *del, const size_t d,\
+                               const size_t ndat)
+{
+    size_t k,l;
+    
+    for (k=d;k>0;k--)
+    {
+        if (del[k-1] < ndat-d+k-1)
+        {
+            del[k-1]++;
+            for (l=k;l<d;l++)
+            {
+                del[l] = del[l-1] + 1;
+            }
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/* delete-d jackknife: the samples are f evaluated on data where all the
+ * possible sets of d elements are removed, for d from 1 to jk_depth; for
+ * rs_mean each sample is computed from the full sum minus the removed
+ * elements, the other functions of the mean use it through
+ * resample_of_mean */
+static latan_errno resample_jackknife(mat *cent_val, mat **sample,         \
+                                      const size_t jk_depth, mat **dat,    \
+                                      const size_t ndat, rs_func *f,       \
+                                      void *param)
+{
+    mat **fakedat,*sum;
+    size_t *del;
+    size_t d,i,j,k,s;
+    bool is_mean;
+    latan_errno status;
+    
+    status  = LATAN_SUCCESS;
+    is_mean = (f == &rs_mean);
+    fakedat = NULL;
+    sum     = NULL;
+    
+    MALLOC(del,size_t *,jk_depth);
+    if (is_mean)
+    {
+        sum = mat_create_from_dim(cent_val);
+        mat_zero(sum);
+        for (i=0;i<ndat;i++)
+        {
+            USTAT(mat_eqadd(sum,dat[i]));
+        }
+        USTAT(mat_muls(cent_val,sum,1.0/((double)(ndat))));
+    }
+    else
+    {
+        MALLOC(fakedat,mat **,ndat);
+        USTAT(f(cent_val,dat,ndat,param));
+    }
+    
+    s = 0;
+    for (d=1;d<=jk_depth;d++)
+    {
+        for (k=0;k<d;k++)
+        {
+            del[k] = k;
+        }
+        do
+        {
+            if (is_mean)
+            {
+                USTAT(mat_cp(sample[s],sum));
+                for (k=0;k<d;k++)
+                {
+                    USTAT(mat_eqsub(sample[s],dat[del[k]]));
+                }
+                USTAT(mat_eqmuls(sample[s],1.0/((double)(ndat-d))));
+            }
+            else
+            {
+                j = 0;
+                k = 0;
+                for (i=0;i<ndat;i++)
+                {
+                    if ((k < d)&&(i == del[k]))
+                    {
+                        k++;
+                    }
+                    else
+                    {
+                        fakedat[j] = dat[i];
+                        j++;
+                    }
+                }
+                USTAT(f(sample[s],fakedat,ndat-d,param));
+            }
+            s++;
+        } while (jackknife_next_del(del,d,ndat));
+    }
+    
+    FREE(del);
+    FREE(fakedat);
+    mat_destroy(sum);
     
     return status;
 }
@@ -656,13 +1213,66 @@ static latan_errno resample_bootstrap(mat *cent_val, mat **sample,         \
 latan_errno resample(rs_sample *s, mat **dat, const size_t ndat, rs_func *f, \
                      unsigned int resamp_method, void *param)
 {
+    return resample_gen(s,dat,ndat,f,resamp_method,param,env.cb_resamp,\
+                        env.cb_seed);
+}
+
+latan_errno resample_seeded(rs_sample *s, mat **dat, const size_t ndat,\
+                            rs_func *f, void *param,                   \
+                            const unsigned long seed)
+{
+    return resample_gen(s,dat,ndat,f,BOOT,param,true,seed);
+}
+
+latan_errno resample_of_mean(rs_sample *s, mat **dat, const size_t ndat,\
+                             rs_func *f, unsigned int resamp_method,    \
+                             void *param)
+{
+    rs_sample *s_mean;
+    mat *pt;
+    size_t i;
     latan_errno status;
+    
+    status = LATAN_SUCCESS;
+    
+    s_mean = rs_sample_create(nrow(dat[0]),ncol(dat[0]),s->nsample);
+    if (s_mean == NULL)
+    {
+        LATAN_ERROR("memory allocation failed",LATAN_ENOMEM);
+    }
+    status = resample_gen(s_mean,dat,ndat,&rs_mean,resamp_method,NULL,\
+                          env.cb_resamp,env.cb_seed);
+    if (status == LATAN_SUCCESS)
+    {
+        pt = s_mean->cent_val;
+        USTAT(f(s->cent_val,&pt,1,param));
+        for (i=0;i<s->nsample;i++)
+        {
+            pt = s_mean->sample[i];
+            USTAT(f(s->sample[i],&pt,1,param));
+        }
+    }
+    rs_sample_destroy(s_mean);
+    
+    return status;
+}
 
-    /** bootstrap **/
-    if (resamp_method == 0)
+static latan_errno resample_gen(rs_sample *s, mat **dat, const size_t ndat,\
+                                rs_func *f, unsigned int resamp_method,    \
+                                void *param, const bool cb_resamp,         \
+                                const unsigned long cb_seed)
+{
+    latan_errno status;
+
+    /** bootstrap, with a matrix product fast path for the mean **/
+    if ((resamp_method == 0)&&(f == &rs_mean))
+    {
+        status = resample_bootstrap_mean(s,dat,ndat,cb_resamp,cb_seed);
+    }
+    else if (resamp_method == 0)
     {
         status = resample_bootstrap(s->cent_val,s->sample,s->nsample,dat,ndat,\
-                                    f,param);
+                                    f,param,cb_resamp,cb_seed);
     }
     /** jacknife **/
     else
@@ -671,8 +1281,13 @@ latan_errno resample(rs_sample *s, mat **dat, const size_t ndat, rs_func *f, \
         {
             LATAN_ERROR("jackknife resampling depth too large",LATAN_EINVAL);
         }
-        LATAN_ERROR("jackknife resampling is not implemented yet",\
-                    LATAN_FAILURE);
+        if (s->nsample != jackknife_nsample(ndat,(size_t)(resamp_method)))
+        {
+            LATAN_ERROR("resampled sample size does not match jackknife sample number",\
+                        LATAN_EBADLEN);
+        }
+        status = resample_jackknife(s->cent_val,s->sample,                 \
+                                    (size_t)(resamp_method),dat,ndat,f,param);
     }
 
     return status;
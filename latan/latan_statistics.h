@@ -42,7 +42,7 @@ latan_errno mat_cov(mat *cov, mat **m, mat **n, const size_t size);
 latan_errno mat_cov_m(mat *cov, mat **m, mat **n, const size_t size,\
                       mat *m_mean, mat *n_mean);
 #define mat_var(var,m,size) mat_cov(var,m,m,size)
-#define mat_var_m(var,m,size,mean) mat_cov(var,m,m,size,mean,mean)
+#define mat_var_m(var,m,size,mean) mat_cov_m(var,m,m,size,mean,mean)
 latan_errno mat_covp(mat *cov, mat **m, mat **n, const size_t size);
 latan_errno mat_covp_m(mat *cov, mat **m, mat **n, const size_t size,\
                        mat *m_mean, mat *n_mean);
@@ -71,11 +71,22 @@ latan_errno histogram(mat *hist, const mat *data, const mat* w,\
                       const double xmin, const double xmax, const size_t nint);
 
 /* resampled sample type */
+/** all the samples are stored in one aligned memory block, sample-major
+ *  (element (i,j) of sample k is at data[k*nel+i*ncol+j]), the central
+ *  value being stored in the same block just before the samples; sample
+ *  matrices are views on this block and must not be destroyed
+ *  individually **/
+#define RS_SAMPLE_ALIGN 64
+
 typedef struct
 {
     mat *cent_val;
     mat **sample;
     size_t nsample;
+    mat *slab;
+    mat *mat_buf;
+    gsl_matrix *gsl_buf;
+    double *data_raw;
 } rs_sample;
 
 /** jackknife sample number calculation **/
@@ -91,6 +102,9 @@ size_t rs_sample_get_nrow(const rs_sample *s);
 size_t rs_sample_get_nsample(const rs_sample *s);
 mat *rs_sample_pt_cent_val(const rs_sample *s);
 mat *rs_sample_pt_sample(const rs_sample *s, const size_t i);
+mat *rs_sample_pt_slab(const rs_sample *s);
+latan_errno rs_sample_get_point_major(mat *pm, const rs_sample *s);
+latan_errno rs_sample_rand_n(rs_sample *s, const mat *mean, const mat *sigma);
 latan_errno rs_sample_get_subsamp(rs_sample *s_a, const rs_sample *s_b,\
                                   const size_t k1, const size_t l1,    \
                                   const size_t k2, const size_t l2);
@@ -105,8 +119,40 @@ latan_errno rs_sample_covp(mat *cov, const rs_sample *s, const rs_sample *t);
 #define rs_sample_varp(cov,s) rs_sample_covp(cov,s,s);
 
 /* resampling function */
+/** with parallel resampling the rs_func is called concurrently from several
+ *  OpenMP threads and must be thread-safe, results do not depend on the
+ *  number of threads ; the bootstrap indices of replica i are the stream i
+ *  of the counter-based generator with a key drawn once from the global
+ *  generator, so they differ from the serial ones unless counter-based
+ *  resampling is used ; the matrix product bootstrap of rs_mean follows the
+ *  same rule and draws its resampling counts concurrently **/
+bool resample_get_parallel(void);
+void resample_set_parallel(const bool par_resamp);
+/** with counter-based resampling, the indices of bootstrap sample i are
+ *  the draws of the stream i of the counter-based generator with key seed,
+ *  any sample can then be regenerated alone using resample_bootstrap_ind **/
+bool resample_get_counter_based(void);
+unsigned long resample_get_cb_seed(void);
+void resample_set_counter_based(const bool cb_resamp, const unsigned long seed);
+void resample_bootstrap_ind(unsigned int *ind, const unsigned long seed,\
+                            const size_t i, const size_t ndat);
+/** bootstrap of rs_mean is computed with matrix products of resampling
+ *  counts with the data **/
 latan_errno resample(rs_sample *s, mat **dat, const size_t ndat, rs_func *f,\
                      unsigned int resamp_method, void *param);
+/** resampling of a function f of the mean of the data only: the resampled
+ *  means are computed with the rs_mean fast paths (matrix products for the
+ *  bootstrap, full sum minus the removed elements for the jackknife, with
+ *  O(ndat) cost per sample) and f is called on each of them as a one
+ *  element data array ; the bootstrap indices are the ones of resample **/
+latan_errno resample_of_mean(rs_sample *s, mat **dat, const size_t ndat,\
+                             rs_func *f, unsigned int resamp_method,    \
+                             void *param);
+/** counter-based bootstrap with the key seed, whatever the global setting
+ *  from resample_set_counter_based which is not modified **/
+latan_errno resample_seeded(rs_sample *s, mat **dat, const size_t ndat,\
+                            rs_func *f, void *param,                   \
+                            const unsigned long seed);
 
 /* useful rs_func */
 latan_errno rs_mean(mat *res, mat **dat, const size_t ndat, void *nothing);
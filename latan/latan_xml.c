@@ -21,6 +21,7 @@
 
 #include <latan/latan_includes.h>
 #ifdef HAVE_LIBXML2
+#include <latan/latan_dtoa.h>
 #include <latan/latan_xml.h>
 #include <gsl/gsl_matrix.h>
 
@@ -63,9 +64,311 @@ const strbuf xml_mark[NXML_MARK] =
     "vect",   \
     "mat",    \
     "rgstate",\
-    "sample"  \
+    "sample", \
+    "seed"    \
 };
 
+/*                     base64 matrix encoding (internal)                    */
+/****************************************************************************/
+/* a base64 encoded matrix is a mat element with the attributes
+ * encoding="base64", nrow and ncol, containing the base64 string of its
+ * elements in row-major order as little-endian IEEE 754 doubles */
+#define B64_ENC "base64"
+
+static const char b64_char[] =
+"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static latan_errno xml_get_mat_enc(bool *is_b64, xmlNode *node);
+static bool xml_is_block_in(const mat *m, const size_t s[2], const size_t k1,\
+                            const size_t l1, const bool is_sub);
+static latan_errno xml_get_mat_b64(mat *m, size_t s[2], xmlNode *node,\
+                                   const size_t k1, const size_t l1,   \
+                                   const bool is_sub);
+static latan_errno xml_get_subm_gen(mat *m, xmlNode *node, const size_t k1,\
+                                    const size_t l1, const bool is_sub);
+static latan_errno xml_get_subsamp_gen(rs_sample *s, xmlNode *node,  \
+                                       const size_t k1, const size_t l1,\
+                                       const bool is_sub);
+static xmlNode * xml_insert_mat_b64(xmlNode *parent, const mat *m);
+
+static void b64_encode(char *out, const unsigned char *in, const size_t n)
+{
+    size_t i;
+    unsigned long w;
+
+    for (i=0;i+2<n;i+=3)
+    {
+        w      = ((unsigned long)in[i] << 16)|((unsigned long)in[i+1] << 8)|\
+                 (unsigned long)in[i+2];
+        *out++ = b64_char[(w >> 18)&0x3F];
+        *out++ = b64_char[(w >> 12)&0x3F];
+        *out++ = b64_char[(w >> 6)&0x3F];
+        *out++ = b64_char[w&0x3F];
+    }
+    if (i < n)
+    {
+        w      = ((unsigned long)in[i] << 16)|\
+                 ((i+1 < n) ? ((unsigned long)in[i+1] << 8) : 0UL);
+        *out++ = b64_char[(w >> 18)&0x3F];
+        *out++ = b64_char[(w >> 12)&0x3F];
+        *out++ = (i+1 < n) ? b64_char[(w >> 6)&0x3F] : '=';
+        *out++ = '=';
+    }
+    *out = '\0';
+}
+
+/* return the number of decoded bytes, or -1 if the string is not valid base64
+ * or decodes to more than nmax bytes (blank characters are ignored) */
+static long b64_decode(unsigned char *out, const char *in, const size_t nmax)
+{
+    size_t n;
+    unsigned long w;
+    int nc,v;
+    const char *pt;
+
+    n  = 0;
+    w  = 0;
+    nc = 0;
+    for (pt=in;(*pt != '\0')&&(*pt != '=');pt++)
+    {
+        if ((*pt >= 'A')&&(*pt <= 'Z'))
+        {
+            v = *pt - 'A';
+        }
+        else if ((*pt >= 'a')&&(*pt <= 'z'))
+        {
+            v = *pt - 'a' + 26;
+        }
+        else if ((*pt >= '0')&&(*pt <= '9'))
+        {
+            v = *pt - '0' + 52;
+        }
+        else if (*pt == '+')
+        {
+            v = 62;
+        }
+        else if (*pt == '/')
+        {
+            v = 63;
+        }
+        else if ((*pt == ' ')||(*pt == '\n')||(*pt == '\t')||(*pt == '\r'))
+        {
+            continue;
+        }
+        else
+        {
+            return -1;
+        }
+        w = (w << 6)|(unsigned long)v;
+        nc++;
+        if (nc == 4)
+        {
+            if (n + 3 > nmax)
+            {
+                return -1;
+            }
+            out[n++] = (unsigned char)((w >> 16)&0xFF);
+            out[n++] = (unsigned char)((w >> 8)&0xFF);
+            out[n++] = (unsigned char)(w&0xFF);
+            w        = 0;
+            nc       = 0;
+        }
+    }
+    if (nc == 1)
+    {
+        return -1;
+    }
+    else if (nc > 1)
+    {
+        if (n + (size_t)(nc - 1) > nmax)
+        {
+            return -1;
+        }
+        w <<= 6*(4 - nc);
+        out[n++] = (unsigned char)((w >> 16)&0xFF);
+        if (nc == 3)
+        {
+            out[n++] = (unsigned char)((w >> 8)&0xFF);
+        }
+    }
+
+    return (long)n;
+}
+
+static latan_errno xml_get_mat_enc(bool *is_b64, xmlNode *node)
+{
+    xmlChar *enc;
+
+    *is_b64 = false;
+    enc     = xmlGetProp(node,(const xmlChar *)"encoding");
+    if (enc != NULL)
+    {
+        *is_b64 = (strcmp((const char *)enc,B64_ENC) == 0);
+        if (!(*is_b64))
+        {
+            strbuf errmsg;
+            sprintf(errmsg,"unknown matrix encoding \"%s\" (%s:%u)",\
+                    (const char *)enc,node->doc->URL,node->line);
+            xmlFree(enc);
+            LATAN_ERROR(errmsg,LATAN_ELATSYN);
+        }
+        xmlFree(enc);
+    }
+
+    return LATAN_SUCCESS;
+}
+
+/* a full load needs the exact matrix size, a sub-block only has to fit */
+static bool xml_is_block_in(const mat *m, const size_t s[2], const size_t k1,\
+                            const size_t l1, const bool is_sub)
+{
+    if (is_sub)
+    {
+        return (k1 + nrow(m) <= s[0])&&(l1 + ncol(m) <= s[1]);
+    }
+    else
+    {
+        return (nrow(m) == s[0])&&(ncol(m) == s[1]);
+    }
+}
+
+static latan_errno xml_get_mat_b64(mat *m, size_t s[2], xmlNode *node,\
+                                   const size_t k1, const size_t l1,   \
+                                   const bool is_sub)
+{
+    xmlChar *prop;
+    char *str;
+    unsigned char *buf;
+    unsigned long dim[2];
+    size_t i,j,nel_f,nbyte,m_dim[2];
+    long ndec;
+    double *row;
+    int k;
+    const char *dim_name[2] = {"nrow","ncol"};
+
+    for (k=0;k<2;k++)
+    {
+        prop = xmlGetProp(node,(const xmlChar *)dim_name[k]);
+        if ((prop == NULL)||(sscanf((const char *)prop,"%lu",dim+k) != 1))
+        {
+            strbuf errmsg;
+            sprintf(errmsg,"base64 matrix without valid %s attribute (%s:%u)",\
+                    dim_name[k],node->doc->URL,node->line);
+            if (prop != NULL)
+            {
+                xmlFree(prop);
+            }
+            LATAN_ERROR(errmsg,LATAN_ELATSYN);
+        }
+        xmlFree(prop);
+    }
+    if (s)
+    {
+        s[0] = (size_t)(dim[0]);
+        s[1] = (size_t)(dim[1]);
+    }
+    if (m)
+    {
+        m_dim[0] = (size_t)(dim[0]);
+        m_dim[1] = (size_t)(dim[1]);
+        if (!xml_is_block_in(m,m_dim,k1,l1,is_sub))
+        {
+            strbuf errmsg;
+            sprintf(errmsg,"matrix size mismatch (%s:%u)",node->doc->URL,\
+                    node->line);
+            LATAN_ERROR(errmsg,LATAN_EBADLEN);
+        }
+        nel_f = (size_t)(dim[0])*(size_t)(dim[1]);
+        nbyte = nel_f*sizeof(double);
+        if (nbyte == 0)
+        {
+            return LATAN_SUCCESS;
+        }
+        MALLOC(buf,unsigned char *,nbyte);
+        str  = (char *)xmlNodeListGetString(node->doc,node->children,1);
+        ndec = (str != NULL) ? b64_decode(buf,str,nbyte) : 0;
+        if (str != NULL)
+        {
+            xmlFree(str);
+        }
+        if (ndec != (long)(nbyte))
+        {
+            strbuf errmsg;
+            sprintf(errmsg,"invalid base64 matrix data (%s:%u)",\
+                    node->doc->URL,node->line);
+            FREE(buf);
+            LATAN_ERROR(errmsg,LATAN_ELATSYN);
+        }
+        /* row-wise copy of the sub-block, data are stored little-endian */
+        for (i=0;i<nrow(m);i++)
+        {
+            row = m->data_cpu->data + i*m->data_cpu->tda;
+            memcpy(row,buf+((k1+i)*(size_t)(dim[1])+l1)*sizeof(double),\
+                   ncol(m)*sizeof(double));
+            if (latan_get_endianness() != LE)
+            {
+                for (j=0;j<ncol(m);j++)
+                {
+                    row[j] = latan_swap_byte_d(row[j]);
+                }
+            }
+        }
+        FREE(buf);
+    }
+
+    return LATAN_SUCCESS;
+}
+
+static xmlNode * xml_insert_mat_b64(xmlNode *parent, const mat *m)
+{
+    xmlNode *node_new;
+    unsigned char *buf;
+    char *str;
+    strbuf sbuf;
+    size_t i,j,nbyte;
+    double *row;
+
+    nbyte = nel(m)*sizeof(double);
+    buf   = NULL;
+    str   = NULL;
+    /* an empty matrix has an empty string */
+    if (nbyte > 0)
+    {
+        MALLOC_ERRVAL(buf,unsigned char *,nbyte,NULL);
+        MALLOC_NOERRET(str,char *,4*((nbyte+2)/3)+1);
+        if (str == NULL)
+        {
+            FREE(buf);
+            return NULL;
+        }
+        for (i=0;i<nrow(m);i++)
+        {
+            row = (double *)(buf) + i*ncol(m);
+            memcpy(row,m->data_cpu->data+i*m->data_cpu->tda,\
+                   ncol(m)*sizeof(double));
+            if (latan_get_endianness() != LE)
+            {
+                for (j=0;j<ncol(m);j++)
+                {
+                    row[j] = latan_swap_byte_d(row[j]);
+                }
+            }
+        }
+        b64_encode(str,buf,nbyte);
+    }
+    node_new = xmlNewTextChild(parent,NULL,(const xmlChar *)xml_mark[i_mat],\
+                               (const xmlChar *)((str != NULL) ? str : ""));
+    xmlNewProp(node_new,(const xmlChar *)"encoding",(const xmlChar *)B64_ENC);
+    sprintf(sbuf,"%lu",(unsigned long)nrow(m));
+    xmlNewProp(node_new,(const xmlChar *)"nrow",(const xmlChar *)sbuf);
+    sprintf(sbuf,"%lu",(unsigned long)ncol(m));
+    xmlNewProp(node_new,(const xmlChar *)"ncol",(const xmlChar *)sbuf);
+    FREE(buf);
+    FREE(str);
+
+    return node_new;
+}
+
 /*                          data I/O functions                              */
 /****************************************************************************/
 /* input */
@@ -101,7 +404,7 @@ latan_errno xml_get_string(strbuf res, xmlNode *node)
 {
     char *buf;
 
-    IF_GOT_LATAN_MARK_ELSE_ERROR(node,i_int)
+    IF_GOT_LATAN_MARK_ELSE_ERROR(node,i_string)
     {
         buf = (char *)xmlNodeListGetString(node->doc,node->children,1);
         strbufcpy(res,buf);
@@ -156,27 +459,63 @@ latan_errno xml_get_vect_size(size_t *row, xmlNode *node)
 
 latan_errno xml_get_mat(mat *m, xmlNode *node)
 {
-    xmlNode *ccur;
-    size_t j;
-    gsl_matrix_view m_view;
-    mat mcol;
+    return xml_get_subm_gen(m,node,0,0,false);
+}
+
+latan_errno xml_get_subm(mat *m, xmlNode *node, const size_t k1,\
+                         const size_t l1)
+{
+    return xml_get_subm_gen(m,node,k1,l1,true);
+}
+
+/* only the elements of the sub-block are converted */
+static latan_errno xml_get_subm_gen(mat *m, xmlNode *node, const size_t k1,\
+                                    const size_t l1, const bool is_sub)
+{
+    xmlNode *ccur,*vcur;
+    size_t i,j,s[2];
+    double buf;
     latan_errno status;
+    bool is_b64;
 
-    j             = 0;
-    status        = LATAN_SUCCESS;
+    status = LATAN_SUCCESS;
 
     IF_GOT_LATAN_MARK_ELSE_ERROR(node,i_mat)
     {
+        USTAT(xml_get_mat_enc(&is_b64,node));
+        if (is_b64)
+        {
+            return xml_get_mat_b64(m,NULL,node,k1,l1,is_sub);
+        }
+        USTAT(xml_get_mat_size(s,node));
+        if (!xml_is_block_in(m,s,k1,l1,is_sub))
+        {
+            strbuf errmsg;
+            sprintf(errmsg,"matrix size mismatch (%s:%u)",node->doc->URL,\
+                    node->line);
+            LATAN_ERROR(errmsg,LATAN_EBADLEN);
+        }
+        j = 0;
         for (ccur=node->children;ccur!=NULL;ccur=ccur->next)
         {
-            m_view        = gsl_matrix_submatrix(m->data_cpu,0,j,nrow(m),1);
-            mcol.data_cpu = &(m_view.matrix);
-            USTAT(xml_get_vect(&mcol,ccur));
+            if ((j >= l1)&&(j < l1 + ncol(m)))
+            {
+                i = 0;
+                for (vcur=ccur->children;vcur!=NULL;vcur=vcur->next)
+                {
+                    if ((i >= k1)&&(i < k1 + nrow(m)))
+                    {
+                        USTAT(xml_get_double(&buf,vcur));
+                        mat_set(m,i-k1,j-l1,buf);
+                    }
+                    i++;
+                }
+            }
             j++;
         }
     }
 
-    return LATAN_SUCCESS;
+    return status;
 }
 
 latan_errno xml_get_mat_size(size_t s[2], xmlNode *node)
@@ -184,6 +523,7 @@ latan_errno xml_get_mat_size(size_t s[2], xmlNode *node)
     xmlNode *ccur;
     size_t buf;
     latan_errno status;
+    bool is_b64;
 
     s[0]   = 0;
     s[1]   = 0;
@@ -191,6 +531,11 @@ latan_errno xml_get_mat_size(size_t s[2], xmlNode *node)
 
     IF_GOT_LATAN_MARK_ELSE_ERROR(node,i_mat)
     {
+        USTAT(xml_get_mat_enc(&is_b64,node));
+        if (is_b64)
+        {
+            return xml_get_mat_b64(NULL,s,node,0,0,false);
+        }
         for (ccur=node->children;ccur!=NULL;ccur=ccur->next)
         {
             USTAT(xml_get_vect_size(&buf,ccur));
@@ -231,6 +576,19 @@ latan_errno xml_get_rgstate(rg_state state, xmlNode *node)
 }
 
 latan_errno xml_get_sample(rs_sample *s, xmlNode *node)
+{
+    return xml_get_subsamp_gen(s,node,0,0,false);
+}
+
+latan_errno xml_get_subsamp(rs_sample *s, xmlNode *node, const size_t k1,\
+                            const size_t l1)
+{
+    return xml_get_subsamp_gen(s,node,k1,l1,true);
+}
+
+static latan_errno xml_get_subsamp_gen(rs_sample *s, xmlNode *node,  \
+                                       const size_t k1, const size_t l1,\
+                                       const bool is_sub)
 {
     xmlNode *scur;
     size_t i;
@@ -242,15 +600,20 @@ latan_errno xml_get_sample(rs_sample *s, xmlNode *node)
     IF_GOT_LATAN_MARK_ELSE_ERROR(node,i_sample)
     {
         scur = node->children;
-        USTAT(xml_get_mat(rs_sample_pt_cent_val(s),scur));
+        USTAT(xml_get_subm_gen(rs_sample_pt_cent_val(s),scur,k1,l1,is_sub));
         for (scur=scur->next;scur!=NULL;scur=scur->next)
         {
-            USTAT(xml_get_mat(rs_sample_pt_sample(s,i),scur));
+            if (i >= rs_sample_get_nsample(s))
+            {
+                LATAN_ERROR("sample number mismatch",LATAN_EBADLEN);
+            }
+            USTAT(xml_get_subm_gen(rs_sample_pt_sample(s,i),scur,k1,l1,\
+                                   is_sub));
             i++;
         }
     }
 
-    return LATAN_SUCCESS;
+    return status;
 }
 
 latan_errno xml_get_sample_nsample(size_t *nsample, xmlNode *node)
@@ -301,6 +664,41 @@ latan_errno xml_get_sample_size(size_t s[2], xmlNode *node)
     return LATAN_SUCCESS;
 }
 
+latan_errno xml_get_seed(rs_seed *sd, xmlNode *node)
+{
+    xmlNode *scur;
+    int ibuf;
+    strbuf buf;
+    latan_errno status;
+
+    status = LATAN_SUCCESS;
+
+    IF_GOT_LATAN_MARK_ELSE_ERROR(node,i_seed)
+    {
+        scur = node->children;
+        USTAT(xml_get_int(&ibuf,scur));
+        sd->nsample = (size_t)(ibuf);
+        scur = scur->next;
+        USTAT(xml_get_int(&ibuf,scur));
+        sd->binsize = (size_t)(ibuf);
+        scur = scur->next;
+        USTAT(xml_get_int(&ibuf,scur));
+        sd->dim[0] = (size_t)(ibuf);
+        scur = scur->next;
+        USTAT(xml_get_int(&ibuf,scur));
+        sd->dim[1] = (size_t)(ibuf);
+        scur = scur->next;
+        USTAT(xml_get_string(buf,scur));
+        sscanf(buf,"%lu",&(sd->seed));
+        scur = scur->next;
+        USTAT(xml_get_string(sd->man_fname,scur));
+        scur = scur->next;
+        USTAT(xml_get_string(sd->m_name,scur));
+    }
+
+    return status;
+}
+
 /* output */
 xmlNode * xml_insert_int(xmlNode *parent, const int i, const strbuf name)
 {
@@ -323,7 +721,7 @@ xmlNode * xml_insert_double(xmlNode *parent, const double d, const strbuf name)
     strbuf data;
     xmlNode *node_new;
 
-    sprintf(data,"%.15e",d);
+    latan_dtoa(data,d);
     node_new = xmlNewChild(parent,NULL,(const xmlChar *)xml_mark[i_double],\
                            (const xmlChar *)data);
     if (strlen(name) > 0)
@@ -376,6 +774,16 @@ xmlNode * xml_insert_mat(xmlNode *parent, const mat *m, const strbuf name)
     strbuf buf;
     size_t j;
     
+    if (io_get_xml_base64())
+    {
+        node_new = xml_insert_mat_b64(parent,m);
+        if ((node_new != NULL)&&(strlen(name) > 0))
+        {
+            xmlNewProp(node_new,(const xmlChar *)"name",(const xmlChar *)name);
+        }
+        
+        return node_new;
+    }
     node_new = xmlNewChild(parent,NULL,(const xmlChar *)xml_mark[i_mat],\
                            (const xmlChar *)"");
     for (j=0;j<ncol(m);j++)
@@ -424,6 +832,14 @@ xmlNode * xml_insert_sample(xmlNode *parent, const rs_sample *s,\
 
     node_new = xmlNewChild(parent,NULL,(const xmlChar *)xml_mark[i_sample],\
                            (const xmlChar *)"");
+    /* the size is repeated in attributes so that it can be known without
+     * reading the matrices */
+    sprintf(buf,"%lu",(unsigned long)nsample);
+    xmlNewProp(node_new,(const xmlChar *)"nsample",(const xmlChar *)buf);
+    sprintf(buf,"%lu",(unsigned long)nrow(rs_sample_pt_cent_val(s)));
+    xmlNewProp(node_new,(const xmlChar *)"nrow",(const xmlChar *)buf);
+    sprintf(buf,"%lu",(unsigned long)ncol(rs_sample_pt_cent_val(s)));
+    xmlNewProp(node_new,(const xmlChar *)"ncol",(const xmlChar *)buf);
     xml_insert_mat(node_new,rs_sample_pt_cent_val(s),"central");
     for (i=0;i<nsample;i++)
     {
@@ -438,25 +854,85 @@ xmlNode * xml_insert_sample(xmlNode *parent, const rs_sample *s,\
     return node_new;
 }
 
+xmlNode * xml_insert_seed(xmlNode *parent, const rs_seed *sd,\
+                          const strbuf name)
+{
+    xmlNode *node_new;
+    strbuf buf;
+
+    node_new = xmlNewChild(parent,NULL,(const xmlChar *)xml_mark[i_seed],\
+                           (const xmlChar *)"");
+    xml_insert_int(node_new,(int)(sd->nsample),"nsample");
+    xml_insert_int(node_new,(int)(sd->binsize),"binsize");
+    xml_insert_int(node_new,(int)(sd->dim[0]),"nrow");
+    xml_insert_int(node_new,(int)(sd->dim[1]),"ncol");
+    sprintf(buf,"%lu",sd->seed);
+    xml_insert_string(node_new,buf,"seed");
+    xml_insert_string(node_new,sd->man_fname,"manifest");
+    xml_insert_string(node_new,sd->m_name,"matrix");
+    if (strlen(name) > 0)
+    {
+        xmlNewProp(node_new,(const xmlChar *)"name",(const xmlChar *)name);
+    }
+
+    return node_new;
+}
+
+/*                      compressed file callbacks (internal)                */
+/****************************************************************************/
+/* files are parsed and saved through io_fopen streams so that .gz and .zst
+ * files are (de)compressed on the fly */
+static int xml_io_read(void *context, char *buf, int len);
+static int xml_io_write(void *context, const char *buf, int len);
+static int xml_io_close(void *context);
+
+static int xml_io_read(void *context, char *buf, int len)
+{
+    size_t nread;
+
+    nread = fread(buf,1,(size_t)len,(FILE *)context);
+
+    return ferror((FILE *)context) ? -1 : (int)nread;
+}
+
+static int xml_io_write(void *context, const char *buf, int len)
+{
+    size_t nwrite;
+
+    nwrite = fwrite(buf,1,(size_t)len,(FILE *)context);
+
+    return (nwrite == (size_t)len) ? len : -1;
+}
+
+static int xml_io_close(void *context)
+{
+    return (fclose((FILE *)context) == 0) ? 0 : -1;
+}
+
 /*                          file writing function                           */
 /****************************************************************************/
 void xml_check_extension(strbuf fname)
 {
     char* ext = NULL;
-    strbuf f_name_buf;
+    strbuf f_name_buf,zext;
+    size_t zext_len;
 
+    /* the .xml extension goes before the compression one */
+    zext_len = io_zip_ext_len(fname);
+    strbufcpy(zext,fname+strlen(fname)-zext_len);
+    fname[strlen(fname)-zext_len] = '\0';
     ext = strrchr(fname,'.');
     if (ext == NULL)
     {
-        sprintf(f_name_buf,"%s.xml",fname);
+        sprintf(f_name_buf,"%s.xml%s",fname,zext);
     }
     else if (strcmp(ext+1,"xml") != 0)
     {
-        sprintf(f_name_buf,"%s.xml",fname);
+        sprintf(f_name_buf,"%s.xml%s",fname,zext);
     }
     else
     {
-        strbufcpy(f_name_buf,fname);
+        sprintf(f_name_buf,"%s%s",fname,zext);
     }
     
     strbufcpy(fname,f_name_buf);
@@ -502,6 +978,7 @@ xml_file * xml_new_file(const strbuf fname)
 xml_file * xml_open_file(const strbuf fname, const char mode)
 {
     xml_file *f;
+    FILE *in;
 
     if ((mode != 'r')&&(mode != 'a')&&(mode != 'w'))
     {
@@ -520,7 +997,12 @@ xml_file * xml_open_file(const strbuf fname, const char mode)
         f->mode = mode;
 
         LIBXML_TEST_VERSION;
-        f->doc = xmlReadFile(f->fname,NULL,XML_PARSE_NOBLANKS|XML_PARSE_NONET);
+        in = io_fopen(f->fname,"r");
+        if (in != NULL)
+        {
+            f->doc = xmlReadIO(&xml_io_read,&xml_io_close,in,f->fname,NULL,\
+                               XML_PARSE_NOBLANKS|XML_PARSE_NONET);
+        }
         if (f->doc == NULL)
         {
             strbuf errmsg;
@@ -574,7 +1056,8 @@ xml_file * xml_open_file(const strbuf fname, const char mode)
 
 latan_errno xml_save_file(xml_file *f)
 {
-    FILE *test_f;
+    FILE *out;
+    xmlOutputBuffer *out_buf;
     xmlDoc *doc;
     int blank_bak,size;
     char *buf;
@@ -586,9 +1069,16 @@ latan_errno xml_save_file(xml_file *f)
     xmlDocDumpFormatMemoryEnc(f->doc,(xmlChar **)(&buf),&size,LATAN_XML_ENC,0);
     doc = xmlReadMemory(buf,size,NULL,LATAN_XML_ENC,\
                         XML_PARSE_NOBLANKS);
-    FOPEN(test_f,f->fname,"a");
-    fclose(test_f);
-    xmlSaveFormatFileEnc(f->fname,doc,LATAN_XML_ENC,1);
+    FOPEN(out,f->fname,"w");
+    out_buf = xmlOutputBufferCreateIO(&xml_io_write,&xml_io_close,out,NULL);
+    if (out_buf != NULL)
+    {
+        xmlSaveFormatFileTo(out_buf,doc,LATAN_XML_ENC,1);
+    }
+    else
+    {
+        fclose(out);
+    }
     xmlKeepBlanksDefault(blank_bak);
 
     xmlFreeDoc(doc);
@@ -656,4 +1146,265 @@ xmlXPathObject * xml_get_nodeset(strbuf xpath_expr, xml_file *f)
     return nodeset;
 }
 
+/*                         streaming input functions                        */
+/****************************************************************************/
+/* the file is walked with a libxml2 text reader, only the data element being
+ * read is expanded in memory (one matrix for the samples), so the memory
+ * used does not depend on the file size ; the reader must be positioned on
+ * the element by xml_stream_find before calling xml_stream_get_sample, or
+ * before using xmlTextReaderExpand with the DOM input functions */
+#define STREAM_IS_MARK(reader,ind)\
+((xmlTextReaderConstNamespaceUri(reader) != NULL) &&\
+ (xmlTextReaderConstPrefix(reader) != NULL) &&\
+ (strcmp((const char *)xmlTextReaderConstNamespaceUri(reader),\
+         LATAN_XMLNS) == 0) &&\
+ (strcmp((const char *)xmlTextReaderConstPrefix(reader),\
+         LATAN_XMLNS_PREF) == 0) &&\
+ (strcmp((const char *)xmlTextReaderConstLocalName(reader),\
+         xml_mark[ind]) == 0))
+
+#define STREAM_PARSE_ERROR(reader,fname)\
+{\
+    strbuf _errmsg;\
+    sprintf(_errmsg,"XML parsing error (%s:%d)",fname,\
+            xmlTextReaderGetParserLineNumber(reader));\
+    LATAN_ERROR(_errmsg,LATAN_ELATSYN);\
+}
+
+xmlTextReader * xml_stream_open(const strbuf fname)
+{
+    xmlTextReader *reader;
+    FILE *in;
+
+    LIBXML_TEST_VERSION;
+    reader = NULL;
+    in     = io_fopen(fname,"r");
+    if (in != NULL)
+    {
+        reader = xmlReaderForIO(&xml_io_read,&xml_io_close,in,fname,NULL,\
+                                XML_PARSE_NOBLANKS|XML_PARSE_NONET);
+    }
+    if (reader == NULL)
+    {
+        strbuf errmsg;
+        sprintf(errmsg,"impossible to parse file %s",fname);
+        LATAN_ERROR_NULL(errmsg,LATAN_EFAULT);
+    }
+
+    return reader;
+}
+
+/* go to the next data element of one of the given types with the given name
+ * (any name if name is empty), *ind is set to the type found or to -1 if no
+ * such element is left in the file */
+latan_errno xml_stream_find(int *ind, xmlTextReader *reader,         \
+                            const int *mark_ind, const size_t nmark,\
+                            const strbuf name)
+{
+    const char *fname;
+    xmlChar *attr;
+    int ret;
+    size_t i;
+
+    *ind  = -1;
+    fname = (const char *)xmlTextReaderConstBaseUri(reader);
+    ret   = xmlTextReaderRead(reader);
+    while (ret == 1)
+    {
+        if (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT)
+        {
+            ret = xmlTextReaderRead(reader);
+            continue;
+        }
+        if (xmlTextReaderDepth(reader) == 0)
+        {
+            if (!STREAM_IS_MARK(reader,i_main))
+            {
+                strbuf errmsg;
+                sprintf(errmsg,"XML mark %s:%s not found (%s:%d)",         \
+                        LATAN_XMLNS_PREF,xml_mark[i_main],fname,           \
+                        xmlTextReaderGetParserLineNumber(reader));
+                LATAN_ERROR(errmsg,LATAN_ELATSYN);
+            }
+            ret = xmlTextReaderRead(reader);
+            continue;
+        }
+        for (i=0;i<nmark;i++)
+        {
+            if (STREAM_IS_MARK(reader,mark_ind[i]))
+            {
+                if (strlen(name) == 0)
+                {
+                    *ind = mark_ind[i];
+                }
+                else
+                {
+                    attr = xmlTextReaderGetAttribute(reader,\
+                                                     (const xmlChar *)"name");
+                    if (attr != NULL)
+                    {
+                        if (strcmp((const char *)attr,name) == 0)
+                        {
+                            *ind = mark_ind[i];
+                        }
+                        xmlFree(attr);
+                    }
+                }
+                if (*ind >= 0)
+                {
+                    return LATAN_SUCCESS;
+                }
+                break;
+            }
+        }
+        ret = xmlTextReaderNext(reader);
+    }
+    if (ret < 0)
+    {
+        STREAM_PARSE_ERROR(reader,fname);
+    }
+
+    return LATAN_SUCCESS;
+}
+
+/* read the number of samples and the matrix size from the attributes of the
+ * sample element the reader is positioned on, without moving the reader ;
+ * *got is false if the attributes are missing (files written by older
+ * versions), then xml_stream_get_sample has to be used */
+latan_errno xml_stream_get_sample_attr(bool *got, size_t *nsample,\
+                                       size_t dim[2], xmlTextReader *reader)
+{
+    xmlChar *attr;
+    unsigned long buf[3];
+    int k;
+    const char *attr_name[3] = {"nsample","nrow","ncol"};
+
+    *got = true;
+    for (k=0;k<3;k++)
+    {
+        attr = xmlTextReaderGetAttribute(reader,\
+                                         (const xmlChar *)attr_name[k]);
+        if ((attr == NULL)||(sscanf((const char *)attr,"%lu",buf+k) != 1))
+        {
+            *got = false;
+        }
+        if (attr != NULL)
+        {
+            xmlFree(attr);
+        }
+    }
+    if (*got)
+    {
+        if (nsample)
+        {
+            *nsample = (size_t)(buf[0]);
+        }
+        if (dim)
+        {
+            dim[0] = (size_t)(buf[1]);
+            dim[1] = (size_t)(buf[2]);
+        }
+    }
+
+    return LATAN_SUCCESS;
+}
+
+/* if sub is not NULL, only the sub-block of the size of the matrices of s
+ * starting at row sub[0] and column sub[1] is loaded */
+latan_errno xml_stream_get_sample(rs_sample *s, size_t *nsample,\
+                                  size_t dim[2], xmlTextReader *reader,\
+                                  const size_t *sub)
+{
+    const char *fname;
+    xmlNode *node;
+    mat *pt;
+    size_t i,buf[2],s_dim[2];
+    int depth,ret,type;
+    latan_errno status;
+
+    status   = LATAN_SUCCESS;
+    fname    = (const char *)xmlTextReaderConstBaseUri(reader);
+    i        = 0;
+    s_dim[0] = 0;
+    s_dim[1] = 0;
+    depth    = xmlTextReaderDepth(reader);
+    ret      = xmlTextReaderIsEmptyElement(reader) ? 0 :\
+               xmlTextReaderRead(reader);
+    while (ret == 1)
+    {
+        type = xmlTextReaderNodeType(reader);
+        if ((type == XML_READER_TYPE_END_ELEMENT)&&\
+            (xmlTextReaderDepth(reader) == depth))
+        {
+            break;
+        }
+        if (type != XML_READER_TYPE_ELEMENT)
+        {
+            ret = xmlTextReaderRead(reader);
+            continue;
+        }
+        if (!STREAM_IS_MARK(reader,i_mat))
+        {
+            strbuf errmsg;
+            sprintf(errmsg,"XML mark %s:%s not found (%s:%d)",LATAN_XMLNS_PREF,\
+                    xml_mark[i_mat],fname,                                  \
+                    xmlTextReaderGetParserLineNumber(reader));
+            LATAN_ERROR(errmsg,LATAN_ELATSYN);
+        }
+        node = xmlTextReaderExpand(reader);
+        if (node == NULL)
+        {
+            STREAM_PARSE_ERROR(reader,fname);
+        }
+        USTAT(xml_get_mat_size(buf,node));
+        if ((i > 0)&&((s_dim[0] != buf[0])||(s_dim[1] != buf[1])))
+        {
+            strbuf errmsg;
+            sprintf(errmsg,"reading samples with variable length (%s:%d)",\
+                    fname,xmlTextReaderGetParserLineNumber(reader));
+            LATAN_ERROR(errmsg,LATAN_EBADLEN);
+        }
+        s_dim[0] = buf[0];
+        s_dim[1] = buf[1];
+        if (s)
+        {
+            if (i > rs_sample_get_nsample(s))
+            {
+                LATAN_ERROR("sample number mismatch",LATAN_EBADLEN);
+            }
+            pt = (i == 0) ? rs_sample_pt_cent_val(s) :\
+                            rs_sample_pt_sample(s,i-1);
+            if ((!sub)&&((nrow(pt) != buf[0])||(ncol(pt) != buf[1])))
+            {
+                strbuf errmsg;
+                sprintf(errmsg,"matrix size mismatch (%s:%d)",fname,\
+                        xmlTextReaderGetParserLineNumber(reader));
+                LATAN_ERROR(errmsg,LATAN_EBADLEN);
+            }
+            USTAT(xml_get_subm(pt,node,sub ? sub[0] : 0,sub ? sub[1] : 0));
+        }
+        i++;
+        ret = xmlTextReaderNext(reader);
+    }
+    if (ret < 0)
+    {
+        STREAM_PARSE_ERROR(reader,fname);
+    }
+    if ((s)&&(i != rs_sample_get_nsample(s) + 1))
+    {
+        LATAN_ERROR("sample number mismatch",LATAN_EBADLEN);
+    }
+    if (nsample)
+    {
+        *nsample = (i > 0) ? i - 1 : 0;
+    }
+    if (dim)
+    {
+        dim[0] = s_dim[0];
+        dim[1] = s_dim[1];
+    }
+
+    return status;
+}
+
 #endif
@@ -23,15 +23,20 @@
 #include <latan/latan_globals.h>
 #include <latan/latan_mat.h>
 #include <latan/latan_statistics.h>
+#include <latan/latan_io.h>
 #include <libxml/parser.h>
 #include <libxml/threads.h>
 #include <libxml/tree.h>
 #include <libxml/xpath.h>
 #include <libxml/xpathInternals.h>
+#include <libxml/xmlreader.h>
 
 #ifndef LIBXML_XPATH_ENABLED
 #error libxml2 was built without XPath interface support
 #endif
+#ifndef LIBXML_READER_ENABLED
+#error libxml2 was built without xmlReader interface support
+#endif
 
 /* LatAnalyze XML format specification */
 #ifndef LATAN_XML_VER
@@ -46,8 +51,13 @@
 #ifndef LATAN_XMLNS_PREF
 #define LATAN_XMLNS_PREF "latan"
 #endif
+/* files larger than this size (in bytes) are read with the streaming
+ * functions instead of being loaded in memory */
+#ifndef LATAN_XML_STREAM_SIZE
+#define LATAN_XML_STREAM_SIZE 16777216L
+#endif
 
-#define NXML_MARK 8
+#define NXML_MARK 9
 enum
 {
     i_main    = 0,
@@ -57,7 +67,8 @@ enum
     i_vect    = 4,
     i_mat     = 5,
     i_rgstate = 6,
-    i_sample  = 7
+    i_sample  = 7,
+    i_seed    = 8
 };
 
 extern const strbuf xml_mark[NXML_MARK];
@@ -83,11 +94,16 @@ latan_errno xml_get_string(strbuf res, xmlNode *node);
 latan_errno xml_get_vect(mat *v, xmlNode *node);
 latan_errno xml_get_vect_size(size_t *row, xmlNode *node);
 latan_errno xml_get_mat(mat *m, xmlNode *node);
+latan_errno xml_get_subm(mat *m, xmlNode *node, const size_t k1,\
+                         const size_t l1);
 latan_errno xml_get_mat_size(size_t s[2], xmlNode *node);
 latan_errno xml_get_rgstate(rg_state state, xmlNode *node);
 latan_errno xml_get_sample(rs_sample *s, xmlNode *node);
+latan_errno xml_get_subsamp(rs_sample *s, xmlNode *node, const size_t k1,\
+                            const size_t l1);
 latan_errno xml_get_sample_nsample(size_t *nsample, xmlNode *node);
 latan_errno xml_get_sample_size(size_t s[2], xmlNode *node);
+latan_errno xml_get_seed(rs_seed *sd, xmlNode *node);
 
 /** output **/
 xmlNode * xml_insert_int(xmlNode *parent, const int res, const strbuf name);
@@ -100,6 +116,8 @@ xmlNode * xml_insert_rgstate(xmlNode *parent, const rg_state state,\
                              const strbuf name);
 xmlNode * xml_insert_sample(xmlNode *parent, const rs_sample *s,\
                             const strbuf name);
+xmlNode * xml_insert_seed(xmlNode *parent, const rs_seed *sd,\
+                          const strbuf name);
 
 /* file read/write functions */
 void xml_check_extension(strbuf fname);
@@ -112,6 +130,17 @@ latan_errno xml_close_file(xml_file *f);
 /* XPath search function */
 xmlXPathObject * xml_get_nodeset(strbuf xpath_expr, xml_file *f);
 
+/* streaming input functions */
+xmlTextReader * xml_stream_open(const strbuf fname);
+latan_errno xml_stream_find(int *ind, xmlTextReader *reader,         \
+                            const int *mark_ind, const size_t nmark,\
+                            const strbuf name);
+latan_errno xml_stream_get_sample_attr(bool *got, size_t *nsample,\
+                                       size_t dim[2], xmlTextReader *reader);
+latan_errno xml_stream_get_sample(rs_sample *s, size_t *nsample,\
+                                  size_t dim[2], xmlTextReader *reader,\
+                                  const size_t *sub);
+
 __END_DECLS
 
 #endif
@@ -7,7 +7,8 @@
 #define YES_NO(b) (((b) == 0) ? ("no") : ("yes"))
 #define VERB_STR ((latan_get_verb() == QUIET) ? ("quiet") :\
                     ((latan_get_verb() == VERB) ? ("verbose") : ("debug")))
-#define FMT_STR ((io_get_fmt() == IO_ASCII) ? ("ASCII") : ("GSL"))
+#define FMT_STR ((io_get_fmt() == IO_ASCII) ? ("ASCII") :\
+                 ((io_get_fmt() == IO_XML) ? ("XML") : ("binary")))
 #define MIN_STR ((minimizer_get_lib() == GSL) ? ("GSL") : ("MINUIT"))
 #define SEP printf("---------------------------------------------\n")
 
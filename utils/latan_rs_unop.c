@@ -68,6 +68,10 @@ int main(int argc, char *argv[])
                     {
                         fmt = IO_ASCII;
                     }
+                    else if (strcmp(argv[i+1],"bin") == 0)
+                    {
+                        fmt = IO_BIN;
+                    }
                     else
                     {
                         fprintf(stderr,"error: format %s unknown\n",argv[i+1]);
@@ -94,7 +98,7 @@ int main(int argc, char *argv[])
     }
     if (show_usage)
     {
-        fprintf(stderr,"usage: %s <in sample> [-o <out sample>] [-f {ascii|xml}]\n",\
+        fprintf(stderr,"usage: %s <in sample> [-o <out sample>] [-f {ascii|xml|bin}]\n",\
                 argv[0]);
         return EXIT_FAILURE;
     }